@@ -18,6 +18,7 @@
 #include "CentralConfig.h"
 #include "CommandManager.h"
 #include "ConfigurationCache.h"
+#include "Dashboard.h"
 #include "StorageService.h"
 #include "TelemetryStream.h"
 
@@ -49,10 +50,11 @@ namespace OpenWifi {
 	AP_WS_Connection::AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 									   Poco::Net::HTTPServerResponse &response,
 									   uint64_t connection_id, Poco::Logger &L,
-									   Poco::Net::SocketReactor &R)
-		: Logger_(L), Reactor_(R) {
+									   Poco::Net::SocketReactor &R, AP_WS_ReactorLoad &Load)
+		: Logger_(L), Reactor_(R), ReactorLoad_(Load) {
 		State_.sessionId = connection_id;
 		WS_ = std::make_unique<Poco::Net::WebSocket>(request, response);
+		ReactorLoad_.Connections++;
 
 		auto TS = Poco::Timespan(360, 0);
 
@@ -71,6 +73,9 @@ namespace OpenWifi {
 		Reactor_.addEventHandler(*WS_,
 								 Poco::NObserver<AP_WS_Connection, Poco::Net::ErrorNotification>(
 									 *this, &AP_WS_Connection::OnSocketError));
+		AP_WS_Server()->SendQueueParameters(OutboundHighWatermark_, OutboundLowWatermark_,
+											 OutboundPolicy_);
+
 		Registered_ = true;
 		Valid_ = true;
 		uuid_ = MicroServiceRandom(std::numeric_limits<std::uint64_t>::max()-1);
@@ -240,6 +245,7 @@ namespace OpenWifi {
 	AP_WS_Connection::~AP_WS_Connection() {
 		Valid_ = false;
 		EndConnection();
+		ReactorLoad_.Connections--;
 	}
 
 	void DeviceDisconnectionCleanup(const std::string &SerialNumber, std::uint64_t uuid) {
@@ -269,6 +275,13 @@ namespace OpenWifi {
 					*WS_, Poco::NObserver<AP_WS_Connection, Poco::Net::ErrorNotification>(
 							  *this, &AP_WS_Connection::OnSocketError));
 			}
+
+			{
+				std::lock_guard G(OutboundMutex_);
+				RemoveWritableHandler();
+				OutboundQueue_.clear();
+				OutboundBytes_ = 0;
+			}
 			WS_->close();
 
 			if(!SerialNumber_.empty()) {
@@ -280,6 +293,11 @@ namespace OpenWifi {
 			if(DeleteSession)
 				SessionDeleted = AP_WS_Server()->EndSession(State_.sessionId, SerialNumberInt_);
 
+			if (State_.Connected)
+				DeviceDashboard()->DeviceDisconnected(SerialNumberInt_, State_.sessionId);
+			if (CountedConnected_.exchange(false))
+				AP_WS_Server()->RemoveConnectedDevice(State_.started);
+
 			if (SessionDeleted || !DeleteSession) {
 				GWWebSocketNotifications::SingleDevice_t N;
 				N.content.serialNumber = SerialNumber_;
@@ -288,7 +306,9 @@ namespace OpenWifi {
 		}
 	}
 
-	bool AP_WS_Connection::LookForUpgrade(const uint64_t UUID, uint64_t &UpgradedUUID) {
+	//	Known is the device record the caller already holds, to avoid reading it again.
+	bool AP_WS_Connection::LookForUpgrade(const uint64_t UUID, uint64_t &UpgradedUUID,
+										  const GWObjects::Device *Known) {
 
 		//	A UUID of zero means ignore updates for that connection.
 		if (UUID == 0)
@@ -301,7 +321,12 @@ namespace OpenWifi {
 		}
 
 		GWObjects::Device D;
-		if (StorageService()->GetDevice(SerialNumber_, D)) {
+		bool Found = Known != nullptr;
+		if (Found)
+			D = *Known;
+		else
+			Found = StorageService()->GetDevice(SerialNumber_, D);
+		if (Found) {
 
 			if(D.pendingUUID!=0 && UUID==D.pendingUUID) {
 				//	so we sent an upgrade to a device, and now it is completing now...
@@ -375,6 +400,24 @@ namespace OpenWifi {
 		CommandManager()->PostCommandResult(SerialNumber_, Doc);
 	}
 
+	//	Frames are received into a buffer that belongs to the reactor thread and keeps its capacity
+	//	from one frame to the next. An unusually large frame does not pin its memory for ever.
+	static constexpr std::size_t MaxRetainedFrameBuffer = 1024 * 1024;
+
+	static Poco::Buffer<char> &ThreadFrameBuffer() {
+		thread_local Poco::Buffer<char> Buffer(0);
+		if (Buffer.capacity() > MaxRetainedFrameBuffer)
+			Buffer.setCapacity(64 * 1024, false);
+		Buffer.resize(0);
+		return Buffer;
+	}
+
+	static Poco::JSON::Parser &ThreadParser() {
+		thread_local Poco::JSON::Parser Parser;
+		Parser.reset();
+		return Parser;
+	}
+
 	void AP_WS_Connection::ProcessJSONRPCEvent(Poco::JSON::Object::Ptr &Doc) {
 		auto Method = Doc->get(uCentralProtocol::METHOD).toString();
 		auto EventType = uCentralProtocol::Events::EventFromString(Method);
@@ -397,7 +440,16 @@ namespace OpenWifi {
 		if (ParamsObj->has(uCentralProtocol::COMPRESS_64)) {
 			std::string UncompressedData;
 			try {
-				auto CompressedData = ParamsObj->get(uCentralProtocol::COMPRESS_64).toString();
+				auto Compressed = ParamsObj->get(uCentralProtocol::COMPRESS_64);
+				if (!Compressed.isString()) {
+					poco_warning(Logger_,
+								 fmt::format("INVALID-COMPRESSED-DATA({}): Compressed payload is "
+											 "not a string.",
+											 CId_));
+					Errors_++;
+					return;
+				}
+				const auto &CompressedData = Compressed.extract<std::string>();
 				uint64_t compress_sz = 0;
 				if (ParamsObj->has("compress_sz")) {
 					compress_sz = ParamsObj->get("compress_sz");
@@ -408,8 +460,7 @@ namespace OpenWifi {
 					poco_trace(Logger_,
 							   fmt::format("EVENT({}): Found compressed payload expanded to '{}'.",
 										   CId_, UncompressedData));
-					Poco::JSON::Parser Parser;
-					ParamsObj = Parser.parse(UncompressedData).extract<Poco::JSON::Object::Ptr>();
+					ParamsObj = ThreadParser().parse(UncompressedData).extract<Poco::JSON::Object::Ptr>();
 				} else {
 					poco_warning(Logger_,
 								 fmt::format("INVALID-COMPRESSED-DATA({}): Compressed cannot be "
@@ -655,6 +706,7 @@ namespace OpenWifi {
 
 	void AP_WS_Connection::OnSocketReadable(
 		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
+		AP_WS_ReactorLoad::BusyScope Busy(ReactorLoad_);
 
 		if (!Valid_)
 			return;
@@ -684,7 +736,7 @@ namespace OpenWifi {
 	}
 
 	void AP_WS_Connection::ProcessIncomingFrame() {
-		Poco::Buffer<char> IncomingFrame(0);
+		auto &IncomingFrame = ThreadFrameBuffer();
 		try {
 			int Op, flags;
 			auto IncomingSize = WS_->receiveFrame(IncomingFrame, flags);
@@ -702,6 +754,7 @@ namespace OpenWifi {
 
 			State_.RX += IncomingSize;
 			AP_WS_Server()->AddRX(IncomingSize);
+			ReactorLoad_.RX += IncomingSize;
 			State_.MessageCount++;
 			State_.LastContact = Utils::Now();
 
@@ -739,8 +792,7 @@ namespace OpenWifi {
 						   fmt::format("FRAME({}): Frame received (length={}, flags={}). Msg={}",
 									   CId_, IncomingSize, flags, IncomingFrame.begin()));
 
-				Poco::JSON::Parser parser;
-				auto ParsedMessage = parser.parse(IncomingFrame.begin());
+				auto ParsedMessage = ThreadParser().parse(IncomingFrame.begin());
 				auto IncomingJSON = ParsedMessage.extract<Poco::JSON::Object::Ptr>();
 
 				if (IncomingJSON->has(uCentralProtocol::JSONRPC)) {
@@ -864,48 +916,122 @@ namespace OpenWifi {
 	}
 
 	bool AP_WS_Connection::Send(const std::string &Payload) {
-		try {
-			size_t BytesSent = WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-
-			/*
-			 * 	There is a possibility to actually try and send data but the device is no longer
-			 * listening. This code attempts to wait 5 seconds to see if the device is actually
-			 * still listening. if the data is not acked under 5 seconds, then we consider that the
-			 * data never made it or the device is disconnected somehow.
-			 */
-#if defined(__APPLE__)
-			tcp_connection_info info;
-			int timeout = 4000;
-			auto expireAt = std::chrono::system_clock::now() + std::chrono::milliseconds(timeout);
-			do {
-				std::this_thread::sleep_for(std::chrono::milliseconds(50));
-				socklen_t opt_len = sizeof(info);
-				getsockopt(WS_->impl()->sockfd(), SOL_SOCKET, TCP_CONNECTION_INFO, (void *)&info,
-						   &opt_len);
-			} while (!info.tcpi_tfo_syn_data_acked && expireAt > std::chrono::system_clock::now());
-			if (!info.tcpi_tfo_syn_data_acked)
+		if (!Valid_)
+			return false;
+
+		std::lock_guard G(OutboundMutex_);
+
+		/*
+		 * 	Frames are never written from the calling thread: they are queued and the reactor that
+		 * owns this socket writes them when the socket becomes writable. A single frame larger than
+		 * the high watermark is still accepted when the queue is empty, otherwise it could never be
+		 * delivered.
+		 */
+		if (!OutboundQueue_.empty() &&
+			(OutboundBackPressure_ ||
+			 (OutboundBytes_ + Payload.size()) > OutboundHighWatermark_)) {
+			switch (OutboundPolicy_) {
+			case SendQueuePolicy::drop_oldest: {
+				while (!OutboundQueue_.empty() &&
+					   (OutboundBytes_ + Payload.size()) > OutboundHighWatermark_) {
+					OutboundBytes_ -= OutboundQueue_.front().size();
+					OutboundQueue_.pop_front();
+					OutboundDropped_++;
+				}
+			} break;
+
+			case SendQueuePolicy::disconnect: {
+				//	We may be called with a serial number shard locked, so let the reactor thread
+				//	end the connection when it next services the socket.
+				poco_warning(Logger_, fmt::format("SEND-QUEUE({}): {} bytes pending. Disconnecting.",
+												  CId_, OutboundBytes_));
+				OutboundDropped_++;
+				Valid_ = false;
 				return false;
-#else
-			tcp_info info;
-			int timeout = 4000;
-			auto expireAt = std::chrono::system_clock::now() + std::chrono::milliseconds(timeout);
-			do {
-				std::this_thread::sleep_for(std::chrono::milliseconds(20));
-				socklen_t opt_len = sizeof(info);
-				getsockopt(WS_->impl()->sockfd(), SOL_TCP, TCP_INFO, (void *)&info, &opt_len);
-			} while (info.tcpi_unacked > 0 && expireAt > std::chrono::system_clock::now());
-
-			if (info.tcpi_unacked > 0) {
+			}
+
+			case SendQueuePolicy::drop_newest:
+			default: {
+				poco_debug(Logger_, fmt::format("SEND-QUEUE({}): {} bytes pending. Frame dropped.",
+												CId_, OutboundBytes_));
+				OutboundDropped_++;
 				return false;
 			}
-#endif
-			State_.TX += BytesSent;
-			AP_WS_Server()->AddTX(BytesSent);
-			return BytesSent == Payload.size();
+			}
+		}
+
+		OutboundBytes_ += Payload.size();
+		OutboundQueue_.emplace_back(Payload);
+		if (OutboundBytes_ > OutboundHighWatermark_)
+			OutboundBackPressure_ = true;
+
+		if (!WritableRegistered_) {
+			try {
+				Reactor_.addEventHandler(
+					*WS_, Poco::NObserver<AP_WS_Connection, Poco::Net::WritableNotification>(
+							  *this, &AP_WS_Connection::OnSocketWritable));
+				WritableRegistered_ = true;
+			} catch (const Poco::Exception &E) {
+				Logger_.log(E);
+				OutboundBytes_ -= OutboundQueue_.back().size();
+				OutboundQueue_.pop_back();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void AP_WS_Connection::RemoveWritableHandler() {
+		if (WritableRegistered_) {
+			WritableRegistered_ = false;
+			Reactor_.removeEventHandler(
+				*WS_, Poco::NObserver<AP_WS_Connection, Poco::Net::WritableNotification>(
+						  *this, &AP_WS_Connection::OnSocketWritable));
+		}
+	}
+
+	void AP_WS_Connection::OnSocketWritable(
+		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf) {
+		AP_WS_ReactorLoad::BusyScope Busy(ReactorLoad_);
+
+		if (!Valid_)
+			return EndConnection();
+
+		//	Do not monopolize the reactor: other sockets get their turn between bursts.
+		constexpr std::size_t MaxFramesPerNotification = 64;
+
+		try {
+			std::lock_guard G(OutboundMutex_);
+			std::size_t FramesSent = 0;
+			while (!OutboundQueue_.empty() && FramesSent < MaxFramesPerNotification) {
+				const auto &Frame = OutboundQueue_.front();
+				auto BytesSent = WS_->sendFrame(Frame.c_str(), (int)Frame.size());
+				if (BytesSent <= 0) {
+					//	The socket would block, we will be called again once it drains.
+					break;
+				}
+				State_.TX += BytesSent;
+				AP_WS_Server()->AddTX(BytesSent);
+				ReactorLoad_.TX += BytesSent;
+				OutboundBytes_ -= Frame.size();
+				OutboundQueue_.pop_front();
+				FramesSent++;
+			}
+
+			if (OutboundBackPressure_ && OutboundBytes_ <= OutboundLowWatermark_)
+				OutboundBackPressure_ = false;
+
+			if (OutboundQueue_.empty())
+				RemoveWritableHandler();
+			return;
 		} catch (const Poco::Exception &E) {
-			Logger_.log(E);
+			poco_warning(Logger_, fmt::format("SEND-QUEUE({}): Cannot write frame: {}", CId_,
+											  E.displayText()));
+		} catch (...) {
+			poco_warning(Logger_,
+						 fmt::format("SEND-QUEUE({}): Unknown exception while writing frame.", CId_));
 		}
-		return false;
+		return EndConnection();
 	}
 
 	std::string Base64Encode(const unsigned char *buffer, std::size_t size) {
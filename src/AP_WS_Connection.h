@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <deque>
 #include <mutex>
 #include <string>
 
@@ -15,17 +16,23 @@
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/WebSocket.h"
 
+#include "AP_WS_ReactorPool.h"
 #include "RESTObjects/RESTAPI_GWobjects.h"
+#include "StateUtils.h"
 
 namespace OpenWifi {
 
+	//	What to do with a new frame when a connection's outbound queue is above its high watermark.
+	enum class SendQueuePolicy { drop_newest, drop_oldest, disconnect };
+
 	class AP_WS_Connection {
 		static constexpr int BufSize = 256000;
 
 	  public:
 		explicit AP_WS_Connection(Poco::Net::HTTPServerRequest &request,
 								  Poco::Net::HTTPServerResponse &response, uint64_t connection_id,
-								  Poco::Logger &L, Poco::Net::SocketReactor &R);
+								  Poco::Logger &L, Poco::Net::SocketReactor &R,
+								  AP_WS_ReactorLoad &Load);
 		~AP_WS_Connection();
 
 		void EndConnection(bool DeleteSession=true);
@@ -34,6 +41,8 @@ namespace OpenWifi {
 		void ProcessIncomingFrame();
 		void ProcessIncomingRadiusData(const Poco::JSON::Object::Ptr &Doc);
 
+		//	Queue a frame for the reactor to send. Never blocks: returns false if the frame was
+		//	dropped by the backpressure policy or the connection is gone.
 		[[nodiscard]] bool Send(const std::string &Payload);
 
 		bool SendRadiusAuthenticationData(const unsigned char *buffer, std::size_t size);
@@ -43,7 +52,9 @@ namespace OpenWifi {
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void OnSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
-		bool LookForUpgrade(uint64_t UUID, uint64_t &UpgradedUUID);
+		void OnSocketWritable(const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf);
+		bool LookForUpgrade(uint64_t UUID, uint64_t &UpgradedUUID,
+							const GWObjects::Device *Known = nullptr);
 		static bool ExtractBase64CompressedData(const std::string &CompressedData,
 												std::string &UnCompressedData,
 												uint64_t compress_sz);
@@ -63,35 +74,20 @@ namespace OpenWifi {
 			LastStats = RawLastStats_;
 		}
 
-		inline void SetLastStats(const std::string &LastStats) {
+		inline void SetLastStats(const std::string &LastStats,
+								 const StateUtils::UnitStatistics &Unit) {
 			std::lock_guard G(ConnectionMutex_);
 			RawLastStats_ = LastStats;
-			try {
-				Poco::JSON::Parser P;
-				auto Stats = P.parse(LastStats).extract<Poco::JSON::Object::Ptr>();
-				hasGPS = Stats->isObject("gps");
-				auto Unit = Stats->getObject("unit");
-				auto Memory = Unit->getObject("memory");
-				std::uint64_t TotalMemory = Memory->get("total");
-				std::uint64_t FreeMemory = Memory->get("free");
-				if(TotalMemory>0) {
-					memory_used_ =
-						(100.0 * ((double)TotalMemory - (double)FreeMemory)) / (double)TotalMemory;
-				}
-				if(Unit->isArray("load")) {
-					Poco::JSON::Array::Ptr Load = Unit->getArray("load");
-					if(Load->size()>1) {
-						cpu_load_ = Load->get(1);
-					}
-				}
-				if(Unit->isArray("temperature")) {
-					Poco::JSON::Array::Ptr Temperature = Unit->getArray("temperature");
-					if(Temperature->size()>1) {
-						temperature_ = Temperature->get(0);
-					}
-				}
-			} catch (...) {
-
+			hasGPS = Unit.hasGPS;
+			if (Unit.hasMemory && Unit.memoryTotal > 0) {
+				memory_used_ = (100.0 * ((double)Unit.memoryTotal - (double)Unit.memoryFree)) /
+							   (double)Unit.memoryTotal;
+			}
+			if (Unit.hasLoad) {
+				cpu_load_ = (double)Unit.load[1];
+			}
+			if (Unit.hasTemperature) {
+				temperature_ = Unit.temperature;
 			}
 		}
 
@@ -160,11 +156,20 @@ namespace OpenWifi {
 
 		inline bool MustBeSecureRtty() const { return RttyMustBeSecure_; }
 
+		inline void GetSendQueueStatistics(std::uint64_t &QueuedFrames, std::uint64_t &QueuedBytes,
+										   std::uint64_t &DroppedFrames) const {
+			std::lock_guard G(OutboundMutex_);
+			QueuedFrames = OutboundQueue_.size();
+			QueuedBytes = OutboundBytes_;
+			DroppedFrames = OutboundDropped_;
+		}
+
 	  private:
 		mutable std::mutex ConnectionMutex_;
 		std::mutex TelemetryMutex_;
 		Poco::Logger &Logger_;
 		Poco::Net::SocketReactor &Reactor_;
+		AP_WS_ReactorLoad &ReactorLoad_;
 		std::unique_ptr<Poco::Net::WebSocket> WS_;
 		std::string SerialNumber_;
 		uint64_t SerialNumberInt_ = 0;
@@ -191,11 +196,24 @@ namespace OpenWifi {
 		std::atomic_flag Dead_ = false;
 		std::atomic_bool DeviceValidated_ = false;
 		std::atomic_bool Valid_ = false;
+		std::atomic_bool CountedConnected_ = false;
 		OpenWifi::GWObjects::DeviceRestrictions Restrictions_;
 		bool 			RttyMustBeSecure_ = false;
 
 		static inline std::atomic_uint64_t ConcurrentStartingDevices_ = 0;
 
+		mutable std::mutex 			OutboundMutex_;
+		std::deque<std::string> 	OutboundQueue_;
+		std::uint64_t 				OutboundBytes_ = 0;
+		std::uint64_t 				OutboundDropped_ = 0;
+		std::uint64_t 				OutboundHighWatermark_ = 0;
+		std::uint64_t 				OutboundLowWatermark_ = 0;
+		SendQueuePolicy 			OutboundPolicy_ = SendQueuePolicy::drop_newest;
+		bool 						OutboundBackPressure_ = false;
+		bool 						WritableRegistered_ = false;
+
+		void RemoveWritableHandler();
+
 		bool StartTelemetry(uint64_t RPCID, const std::vector<std::string> &TelemetryTypes);
 		bool StopTelemetry(uint64_t RPCID);
 		void UpdateCounts();
@@ -6,6 +6,7 @@
 #include "AP_WS_Server.h"
 #include "CentralConfig.h"
 #include "Daemon.h"
+#include "Dashboard.h"
 #include "FindCountry.h"
 #include "StorageService.h"
 
@@ -108,7 +109,7 @@ namespace OpenWifi {
 				RttyMustBeSecure_ = Capabilities->getValue<bool>("secure-rtty");
 			}
 
-			State_.locale = FindCountryFromIP()->Get(IP);
+			bool LocaleKnown = FindCountryFromIP()->Lookup(IP, State_.locale);
 			GWObjects::Device DeviceInfo;
 			auto DeviceExists = StorageService()->GetDevice(SerialNumber_, DeviceInfo);
 			if (Daemon()->AutoProvisioning() && !DeviceExists) {
@@ -212,7 +213,10 @@ namespace OpenWifi {
 					++Updated;
 				}
 
-				if (DeviceInfo.locale != State_.locale) {
+				if (!LocaleKnown && !DeviceInfo.locale.empty()) {
+					//	the country lookup is still pending, keep what we already know
+					State_.locale = DeviceInfo.locale;
+				} else if (DeviceInfo.locale != State_.locale) {
 					DeviceInfo.locale = State_.locale;
 					++Updated;
 				}
@@ -243,13 +247,15 @@ namespace OpenWifi {
 
 				if(!Simulated_) {
 					uint64_t UpgradedUUID = 0;
-					LookForUpgrade(UUID, UpgradedUUID);
+					LookForUpgrade(UUID, UpgradedUUID, &DeviceInfo);
 					State_.UUID = UpgradedUUID;
 				}
 			}
 
 			State_.Compatible = Compatible_;
 			State_.Connected = true;
+			if (!CountedConnected_.exchange(true))
+				AP_WS_Server()->AddConnectedDevice(State_.started);
 			ConnectionCompletionTime_ =
 				std::chrono::high_resolution_clock::now() - ConnectionStart_;
 			State_.connectionCompletionTime = ConnectionCompletionTime_.count();
@@ -289,6 +295,10 @@ namespace OpenWifi {
 											 State_.connectionCompletionTime));
 			}
 
+			DeviceDashboard()->DeviceConnected(SerialNumberInt_, State_.sessionId,
+											   State_.VerifiedCertificate);
+			CommandManager()->DeviceReady(SerialNumberInt_);
+
 			GWWebSocketNotifications::SingleDevice_t Notification;
 			Notification.content.serialNumber = SerialNumber_;
 			GWWebSocketNotifications::DeviceConnected(Notification);
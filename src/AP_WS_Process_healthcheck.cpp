@@ -3,7 +3,9 @@
 //
 
 #include "AP_WS_Connection.h"
+#include "Dashboard.h"
 #include "StorageService.h"
+#include "StorageWriteBehind.h"
 
 #include "fmt/format.h"
 #include "framework/KafkaManager.h"
@@ -48,15 +50,23 @@ namespace OpenWifi {
 			Check.Data = CheckData;
 			Check.Sanity = Sanity;
 
-			StorageService()->AddHealthCheckData(Check);
+			StorageWriteBehind()->AddHealthCheckData(Check);
 
 			if (!request_uuid.empty()) {
 				StorageService()->SetCommandResult(request_uuid, CheckData);
 			}
 
 			SetLastHealthCheck(Check);
+			DeviceDashboard()->DeviceHealthCheck(SerialNumberInt_, Check.Sanity);
 			if (KafkaManager()->Enabled()) {
-				KafkaManager()->PostMessage(KafkaTopics::HEALTHCHECK, SerialNumber_, *ParamsObj);
+				if (ParamsObj->isObject(uCentralProtocol::DATA)) {
+					KafkaManager()->PostMessage(
+						KafkaTopics::HEALTHCHECK, SerialNumber_,
+						StateUtils::StringifyWithSerializedMember(ParamsObj, uCentralProtocol::DATA,
+																  CheckData));
+				} else {
+					KafkaManager()->PostMessage(KafkaTopics::HEALTHCHECK, SerialNumber_, *ParamsObj);
+				}
 			}
 		} else {
 			poco_warning(Logger_, fmt::format("HEALTHCHECK({}): Missing parameter", CId_));
@@ -4,6 +4,7 @@
 
 #include "AP_WS_Connection.h"
 #include "StorageService.h"
+#include "StorageWriteBehind.h"
 
 #include "fmt/format.h"
 #include "framework/ow_constants.h"
@@ -36,7 +37,7 @@ namespace OpenWifi {
 										   .Recorded = (uint64_t)time(nullptr),
 										   .LogType = 0,
 										   .UUID = State_.UUID};
-			StorageService()->AddLog(DeviceLog);
+			StorageWriteBehind()->AddLog(DeviceLog);
 			DeviceLogKafkaEvent	E(DeviceLog);
 		} else {
 			poco_warning(Logger_, fmt::format("LOG({}): Missing parameters.", CId_));
@@ -3,8 +3,10 @@
 //
 
 #include "AP_WS_Connection.h"
+#include "Dashboard.h"
 #include "StateUtils.h"
 #include "StorageService.h"
+#include "StorageWriteBehind.h"
 
 #include "UI_GW_WebSocketNotifications.h"
 
@@ -44,21 +46,28 @@ namespace OpenWifi {
 				LookForUpgrade(UUID, UpgradedUUID);
 				State_.UUID = UpgradedUUID;
 			}
-			SetLastStats(StateStr);
+			StateUtils::UnitStatistics Unit;
+			StateUtils::ExtractUnitStatistics(StateObj, Unit);
+			SetLastStats(StateStr, Unit);
 
 			GWObjects::Statistics Stats{
 				.SerialNumber = SerialNumber_, .UUID = UUID, .Data = StateStr};
 			Stats.Recorded = Utils::Now();
-			StorageService()->AddStatisticsData(Stats);
+			StorageWriteBehind()->AddStatisticsData(Stats);
 			if (!request_uuid.empty()) {
 				StorageService()->SetCommandResult(request_uuid, StateStr);
 			}
 
 			StateUtils::ComputeAssociations(StateObj, State_.Associations_2G,
 											State_.Associations_5G, State_.Associations_6G);
+			DeviceDashboard()->DeviceStatistics(SerialNumberInt_, Unit, State_.Associations_2G,
+												State_.Associations_5G, State_.Associations_6G);
 
 			if (KafkaManager()->Enabled()) {
-				KafkaManager()->PostMessage(KafkaTopics::STATE, SerialNumber_, *ParamsObj);
+				KafkaManager()->PostMessage(
+					KafkaTopics::STATE, SerialNumber_,
+					StateUtils::StringifyWithSerializedMember(ParamsObj, uCentralProtocol::STATE,
+															  StateStr));
 			}
 
 			GWWebSocketNotifications::SingleDevice_t N;
@@ -4,21 +4,57 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <string>
 
 #include "Poco/Environment.h"
+#include "Poco/JSON/Array.h"
+#include "Poco/JSON/Object.h"
 #include "Poco/Net/SocketAcceptor.h"
 
 #include "framework/utils.h"
 
 namespace OpenWifi {
+
+	//	Live load of one reactor. Connections update it, the pool reads it to place new connections.
+	struct AP_WS_ReactorLoad {
+		std::atomic_uint64_t Connections = 0;
+		std::atomic_uint64_t RX = 0;
+		std::atomic_uint64_t TX = 0;
+		std::atomic_uint64_t Events = 0;
+		std::atomic_uint64_t BusyMicroseconds = 0;
+		std::atomic_uint64_t BusyPercent = 0;
+		std::uint64_t LastBusyMicroseconds = 0;
+
+		//	Accounts the time spent in one socket notification handler.
+		class BusyScope {
+		  public:
+			explicit BusyScope(AP_WS_ReactorLoad &Load)
+				: Load_(Load), Start_(std::chrono::steady_clock::now()) {}
+			~BusyScope() {
+				Load_.Events++;
+				Load_.BusyMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(
+											  std::chrono::steady_clock::now() - Start_)
+											  .count();
+			}
+
+		  private:
+			AP_WS_ReactorLoad &Load_;
+			std::chrono::steady_clock::time_point Start_;
+		};
+	};
+
 	class AP_WS_ReactorThreadPool {
 	  public:
 		explicit AP_WS_ReactorThreadPool() {
 			NumberOfThreads_ = Poco::Environment::processorCount() * 4;
 			if (NumberOfThreads_ == 0)
 				NumberOfThreads_ = 4;
+			for (uint64_t i = 0; i < NumberOfThreads_; ++i)
+				Loads_.emplace_back(std::make_unique<AP_WS_ReactorLoad>());
 		}
 
 		~AP_WS_ReactorThreadPool() { Stop(); }
@@ -45,11 +81,60 @@ namespace OpenWifi {
 			Threads_.clear();
 		}
 
-		Poco::Net::SocketReactor &NextReactor() {
+		//	Pick the least loaded reactor: lowest event loop busy time (in 5% bands, so sampling noise
+		//	does not matter), then fewest connections. The scan starts after the last pick so equally
+		//	loaded reactors still take turns.
+		Poco::Net::SocketReactor &NextReactor(AP_WS_ReactorLoad *&Load) {
+			std::lock_guard Lock(Mutex_);
+			auto Key = [this](uint64_t i) {
+				return std::make_pair(Loads_[i]->BusyPercent.load() / 5,
+									  Loads_[i]->Connections.load());
+			};
+			uint64_t Best = (NextReactor_ + 1) % NumberOfThreads_;
+			auto BestKey = Key(Best);
+			for (uint64_t n = 1; n < NumberOfThreads_; ++n) {
+				auto i = (Best + n) % NumberOfThreads_;
+				auto K = Key(i);
+				if (K < BestKey) {
+					Best = i;
+					BestKey = K;
+				}
+			}
+			NextReactor_ = Best;
+			Load = Loads_[Best].get();
+			return *Reactors_[Best];
+		}
+
+		//	Called periodically to turn accumulated busy time into a busy percentage per reactor.
+		void UpdateLoad() {
 			std::lock_guard Lock(Mutex_);
-			NextReactor_++;
-			NextReactor_ %= NumberOfThreads_;
-			return *Reactors_[NextReactor_];
+			auto Now = std::chrono::steady_clock::now();
+			auto Elapsed =
+				std::chrono::duration_cast<std::chrono::microseconds>(Now - LastSample_).count();
+			LastSample_ = Now;
+			if (Elapsed <= 0)
+				return;
+			for (auto &L : Loads_) {
+				auto Busy = L->BusyMicroseconds.load();
+				auto Delta = Busy - L->LastBusyMicroseconds;
+				L->LastBusyMicroseconds = Busy;
+				L->BusyPercent = std::min<uint64_t>(100, (Delta * 100) / (uint64_t)Elapsed);
+			}
+		}
+
+		void GetStatistics(Poco::JSON::Array &Reactors) const {
+			for (uint64_t i = 0; i < Loads_.size(); ++i) {
+				const auto &L = *Loads_[i];
+				Poco::JSON::Object Entry;
+				Entry.set("reactor", i);
+				Entry.set("connections", L.Connections.load());
+				Entry.set("rx", L.RX.load());
+				Entry.set("tx", L.TX.load());
+				Entry.set("events", L.Events.load());
+				Entry.set("busyMicroseconds", L.BusyMicroseconds.load());
+				Entry.set("busyPercent", L.BusyPercent.load());
+				Reactors.add(Entry);
+			}
 		}
 
 	  private:
@@ -58,5 +143,8 @@ namespace OpenWifi {
 		uint64_t NextReactor_ = 0;
 		std::vector<std::unique_ptr<Poco::Net::SocketReactor>> Reactors_;
 		std::vector<std::unique_ptr<Poco::Thread>> Threads_;
+		//	Never cleared: connections keep a pointer to their reactor's load until they are destroyed.
+		std::vector<std::unique_ptr<AP_WS_ReactorLoad>> Loads_;
+		std::chrono::steady_clock::time_point LastSample_ = std::chrono::steady_clock::now();
 	};
 } // namespace OpenWifi
\ No newline at end of file
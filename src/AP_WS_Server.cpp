@@ -26,9 +26,11 @@ namespace OpenWifi {
 	void AP_WS_RequestHandler::handleRequest(Poco::Net::HTTPServerRequest &request,
 											 Poco::Net::HTTPServerResponse &response) {
 		try {
+			AP_WS_ReactorLoad *Load = nullptr;
+			auto &Reactor = AP_WS_Server()->NextReactor(Load);
 			AP_WS_Server()->AddConnection(
-				id_, std::make_shared<AP_WS_Connection>(request, response, id_, Logger_,
-														AP_WS_Server()->NextReactor()));
+				id_, std::make_shared<AP_WS_Connection>(request, response, id_, Logger_, Reactor,
+														*Load));
 		} catch (...) {
 			poco_warning(Logger_, "Exception during WS creation");
 		}
@@ -56,6 +58,30 @@ namespace OpenWifi {
 		MismatchDepth_ = MicroServiceConfigGetInt("openwifi.certificates.mismatchdepth", 2);
 
 		SessionTimeOut_ = MicroServiceConfigGetInt("openwifi.session.timeout", 10*60);
+		{
+			std::lock_guard G(IdleMutex_);
+			IdleWheel_.clear();
+			IdleWheel_.resize(SessionTimeOut_ / IdleSlotSeconds_ + 3);
+			IdleWheelSlot_ = Utils::Now() / IdleSlotSeconds_;
+		}
+		LoadUpdateInterval_ = MicroServiceConfigGetInt("openwifi.session.loadupdate.interval", 60);
+		LoadUpdateKeepAlive_ =
+			MicroServiceConfigGetInt("openwifi.session.loadupdate.keepalive", 10*60);
+
+		SendQueueHighWatermark_ =
+			MicroServiceConfigGetInt("openwifi.session.sendqueue.highwatermark", 1024*1024);
+		SendQueueLowWatermark_ =
+			MicroServiceConfigGetInt("openwifi.session.sendqueue.lowwatermark", 256*1024);
+		if (SendQueueLowWatermark_ > SendQueueHighWatermark_)
+			SendQueueLowWatermark_ = SendQueueHighWatermark_;
+		auto QueuePolicy =
+			MicroServiceConfigGetString("openwifi.session.sendqueue.policy", "dropnewest");
+		if (QueuePolicy == "dropoldest")
+			SendQueuePolicy_ = SendQueuePolicy::drop_oldest;
+		else if (QueuePolicy == "disconnect")
+			SendQueuePolicy_ = SendQueuePolicy::disconnect;
+		else
+			SendQueuePolicy_ = SendQueuePolicy::drop_newest;
 
 		Reactor_pool_ = std::make_unique<AP_WS_ReactorThreadPool>();
 		Reactor_pool_->Start();
@@ -170,87 +196,99 @@ namespace OpenWifi {
 		return 0;
 	}
 
-	void AP_WS_Server::onGarbageCollecting([[maybe_unused]] Poco::Timer &timer) {
-		static uint64_t last_log = Utils::Now(), last_zombie_run = 0;
-		auto now = Utils::Now();
+	void AP_WS_Server::WatchIdle(std::uint64_t SerialNumber, std::uint64_t SessionId,
+								 std::uint64_t Expiry) {
+		std::lock_guard G(IdleMutex_);
+		if (IdleWheel_.empty())
+			return;
+		auto Slot = Expiry / IdleSlotSeconds_ + 1;
+		if (Slot <= IdleWheelSlot_)
+			Slot = IdleWheelSlot_ + 1;
+		else if (Slot - IdleWheelSlot_ >= IdleWheel_.size())
+			Slot = IdleWheelSlot_ + IdleWheel_.size() - 1;
+		IdleWheel_[Slot % IdleWheel_.size()].push_back(IdleSession{SerialNumber, SessionId});
+	}
 
+	void AP_WS_Server::EvictIdleSessions(std::uint64_t now) {
+		std::vector<IdleSession> Due;
 		{
-			{
-				std::lock_guard SessionLock(SessionMutex_);
-				if (!Garbage_.empty()) {
-					Garbage_.clear();
-				}
+			std::lock_guard G(IdleMutex_);
+			if (IdleWheel_.empty())
+				return;
+			auto CurrentSlot = now / IdleSlotSeconds_;
+			while (IdleWheelSlot_ < CurrentSlot) {
+				IdleWheelSlot_++;
+				auto &Slot = IdleWheel_[IdleWheelSlot_ % IdleWheel_.size()];
+				Due.insert(Due.end(), Slot.begin(), Slot.end());
+				Slot.clear();
 			}
+		}
 
-			uint64_t total_connected_time = 0;
-
-			if(now-last_zombie_run > 20) {
-				poco_information(Logger(), fmt::format("Garbage collecting..."));
-				std::vector<std::uint64_t> SessionsToRemove;
-				NumberOfConnectedDevices_ = 0;
-				NumberOfConnectingDevices_ = 0;
-				AverageDeviceConnectionTime_ = 0;
-				last_zombie_run = now;
-				for(int hashIndex=0;hashIndex<256;hashIndex++) {
-					std::lock_guard Lock(SerialNumbersMutex_[hashIndex]);
-					auto hint = SerialNumbers_[hashIndex].begin();
-					while (hint != end(SerialNumbers_[hashIndex])) {
-						if (hint->second.second == nullptr) {
-							hint = SerialNumbers_[hashIndex].erase(hint);
-						} else if ((now - hint->second.second->State_.LastContact) >
-								   SessionTimeOut_) {
-							hint->second.second->EndConnection(false);
-							poco_information(
-								Logger(),
-								fmt::format(
-									"{}: Session seems idle. Controller disconnecting device.",
-									hint->second.second->SerialNumber_));
-							SessionsToRemove.emplace_back(hint->second.first);
-							Garbage_.push_back(hint->second.second);
-							hint = SerialNumbers_[hashIndex].erase(hint);
-						} else if (hint->second.second->State_.Connected) {
-							NumberOfConnectedDevices_++;
-							total_connected_time += (now - hint->second.second->State_.started);
-							hint++;
-						} else {
-							NumberOfConnectingDevices_++;
-							hint++;
-						}
-					}
-				}
-
-				if(SessionsToRemove.empty()) {
-					poco_information(Logger(), fmt::format("Removing {} sessions.", SessionsToRemove.size()));
-					std::lock_guard Lock(SessionMutex_);
-					for (const auto &Session : SessionsToRemove) {
-						Sessions_.erase(Session);
-					}
+		std::vector<std::pair<IdleSession, std::uint64_t /* expiry */>> StillActive;
+		std::vector<std::uint64_t> SessionsToRemove;
+		for (const auto &Entry : Due) {
+			auto hashIndex = Utils::CalculateMacAddressHash(Entry.SerialNumber);
+			std::lock_guard Lock(SerialNumbersMutex_[hashIndex]);
+			auto hint = SerialNumbers_[hashIndex].find(Entry.SerialNumber);
+			//	The session ended or the device reconnected: the newer session has its own entry.
+			if (hint == end(SerialNumbers_[hashIndex]) || hint->second.first != Entry.SessionId)
+				continue;
+			if (hint->second.second == nullptr) {
+				SerialNumbers_[hashIndex].erase(hint);
+				continue;
+			}
+			std::uint64_t LastContact = hint->second.second->State_.LastContact;
+			if (LastContact == 0)
+				LastContact = hint->second.second->State_.started;
+			if (LastContact < now && (now - LastContact) > SessionTimeOut_) {
+				hint->second.second->EndConnection(false);
+				poco_information(
+					Logger(),
+					fmt::format("{}: Session seems idle. Controller disconnecting device.",
+								hint->second.second->SerialNumber_));
+				SessionsToRemove.emplace_back(hint->second.first);
+				{
+					std::lock_guard G(GarbageMutex_);
+					Garbage_.push_back(hint->second.second);
 				}
-
-				AverageDeviceConnectionTime_ =
-				NumberOfConnectedDevices_ > 0 ? total_connected_time / NumberOfConnectedDevices_
-											  : 0;
-
-				poco_information(Logger(), fmt::format("Garbage collecting done..."));
+				SerialNumbers_[hashIndex].erase(hint);
 			} else {
-				std::lock_guard SessionLock(SessionMutex_);
-				NumberOfConnectedDevices_ = Sessions_.size();
-				AverageDeviceConnectionTime_ += 10;
+				StillActive.emplace_back(Entry, LastContact + SessionTimeOut_);
 			}
+		}
+
+		for (const auto &[Entry, Expiry] : StillActive)
+			WatchIdle(Entry.SerialNumber, Entry.SessionId, Expiry);
 
-			if ((now - last_log) > 120) {
-				last_log = now;
-				poco_information(Logger(),
-								 fmt::format("Active AP connections: {} Connecting: {} Average connection time: {} seconds",
-											 NumberOfConnectedDevices_, NumberOfConnectingDevices_,
-											 AverageDeviceConnectionTime_));
+		if (!SessionsToRemove.empty()) {
+			poco_information(Logger(), fmt::format("Removing {} sessions.", SessionsToRemove.size()));
+			for (const auto &Session : SessionsToRemove) {
+				auto sessionIndex = SessionIndex(Session);
+				std::lock_guard Lock(SessionMutex_[sessionIndex]);
+				if (Sessions_[sessionIndex].erase(Session))
+					NumberOfSessions_--;
 			}
 		}
+	}
 
+	//	Only sent when the device counts moved, and at most once per interval. A keep-alive is sent
+	//	when nothing changed for a long time so consumers know the gateway is still there.
+	void AP_WS_Server::PostLoadUpdate(std::uint64_t now) {
 		GWWebSocketNotifications::NumberOfConnection_t Notification;
-		Notification.content.numberOfConnectingDevices = NumberOfConnectingDevices_;
-		Notification.content.numberOfDevices = NumberOfConnectedDevices_;
-		Notification.content.averageConnectedTime = AverageDeviceConnectionTime_;
+		AverageDeviceStatistics(Notification.content.numberOfDevices,
+								Notification.content.averageConnectedTime,
+								Notification.content.numberOfConnectingDevices);
+
+		bool Changed = Notification.content.numberOfDevices != LastLoadConnected_ ||
+					   Notification.content.numberOfConnectingDevices != LastLoadConnecting_;
+		if ((now - LastLoadUpdate_) < LoadUpdateInterval_ ||
+			(!Changed && (now - LastLoadUpdate_) < LoadUpdateKeepAlive_))
+			return;
+
+		LastLoadUpdate_ = now;
+		LastLoadConnected_ = Notification.content.numberOfDevices;
+		LastLoadConnecting_ = Notification.content.numberOfConnectingDevices;
+
 		GetTotalDataStatistics(Notification.content.tx,Notification.content.rx);
 		GWWebSocketNotifications::NumberOfConnections(Notification);
 
@@ -265,6 +303,34 @@ namespace OpenWifi {
 		KafkaManager()->PostMessage(KafkaTopics::DEVICE_EVENT_QUEUE, "system", FullEvent);
 	}
 
+	void AP_WS_Server::onGarbageCollecting([[maybe_unused]] Poco::Timer &timer) {
+		static uint64_t last_log = Utils::Now();
+		auto now = Utils::Now();
+
+		Reactor_pool_->UpdateLoad();
+
+		{
+			std::vector<std::shared_ptr<AP_WS_Connection>> Collected;
+			{
+				std::lock_guard G(GarbageMutex_);
+				Collected.swap(Garbage_);
+			}
+		}
+
+		EvictIdleSessions(now);
+
+		if ((now - last_log) > 120) {
+			last_log = now;
+			std::uint64_t Connected, AverageTime, Connecting;
+			AverageDeviceStatistics(Connected, AverageTime, Connecting);
+			poco_information(Logger(),
+							 fmt::format("Active AP connections: {} Connecting: {} Average connection time: {} seconds",
+										 Connected, Connecting, AverageTime));
+		}
+
+		PostLoadUpdate(now);
+	}
+
 	void AP_WS_Server::Stop() {
 		poco_information(Logger(), "Stopping...");
 		Running_ = false;
@@ -319,9 +385,10 @@ namespace OpenWifi {
 	}
 
 	void AP_WS_Server::SetSessionDetails(uint64_t connection_id, uint64_t SerialNumber) {
-		std::lock_guard SessionLock(SessionMutex_);
-		auto Conn = Sessions_.find(connection_id);
-		if (Conn == end(Sessions_))
+		auto sessionIndex = SessionIndex(connection_id);
+		std::lock_guard SessionLock(SessionMutex_[sessionIndex]);
+		auto Conn = Sessions_[sessionIndex].find(connection_id);
+		if (Conn == end(Sessions_[sessionIndex]))
 			return;
 
 		auto hashIndex = Utils::CalculateMacAddressHash(SerialNumber);
@@ -330,34 +397,36 @@ namespace OpenWifi {
 		if ((CurrentSerialNumber == SerialNumbers_[hashIndex].end()) ||
 			(CurrentSerialNumber->second.first < connection_id)) {
 			SerialNumbers_[hashIndex][SerialNumber] = std::make_pair(connection_id, Conn->second);
+			WatchIdle(SerialNumber, connection_id, Utils::Now() + SessionTimeOut_);
 			return;
 		}
 	}
 
 	bool AP_WS_Server::EndSession(uint64_t session_id, uint64_t SerialNumber) {
-		std::lock_guard SessionLock(SessionMutex_);
-		auto Session = Sessions_.find(session_id);
-		if (Session == end(Sessions_))
+		auto sessionIndex = SessionIndex(session_id);
+		std::lock_guard SessionLock(SessionMutex_[sessionIndex]);
+		auto Session = Sessions_[sessionIndex].find(session_id);
+		if (Session == end(Sessions_[sessionIndex]))
 			return false;
 
-		Garbage_.push_back(Session->second);
+		{
+			std::lock_guard G(GarbageMutex_);
+			Garbage_.push_back(Session->second);
+		}
+		Sessions_[sessionIndex].erase(Session);
+		NumberOfSessions_--;
 
 		auto hashIndex = Utils::CalculateMacAddressHash(SerialNumber);
 		std::lock_guard Lock(SerialNumbersMutex_[hashIndex]);
 		auto Device = SerialNumbers_[hashIndex].find(SerialNumber);
-		if (Device == end(SerialNumbers_[hashIndex])) {
-			Sessions_.erase(Session);
+		if (Device == end(SerialNumbers_[hashIndex]))
 			return false;
-		}
 
 		if (Device->second.first == session_id) {
-			Sessions_.erase(Session);
 			SerialNumbers_[hashIndex].erase(Device);
 			return true;
 		}
 
-		Sessions_.erase(Session);
-
 		return false;
 	}
 
@@ -392,6 +461,7 @@ namespace OpenWifi {
 		}
 
 		try {
+			//	Only queues the frame: the device's reactor does the actual write.
 			return Device->second.second->Send(Payload);
 		} catch (...) {
 			poco_debug(Logger(), fmt::format(": SendFrame: Could not send data to device '{}'",
@@ -12,6 +12,8 @@
 #include <ctime>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "Poco/AutoPtr.h"
 #include "Poco/Net/HTTPRequestHandler.h"
@@ -94,15 +96,45 @@ namespace OpenWifi {
 		inline bool UseProvisioning() const { return LookAtProvisioning_; }
 		inline bool UseDefaults() const { return UseDefaultConfig_; }
 
-		[[nodiscard]] inline Poco::Net::SocketReactor &NextReactor() {
-			return Reactor_pool_->NextReactor();
+		[[nodiscard]] inline Poco::Net::SocketReactor &NextReactor(AP_WS_ReactorLoad *&Load) {
+			return Reactor_pool_->NextReactor(Load);
+		}
+
+		inline void GetReactorStatistics(Poco::JSON::Array &Reactors) const {
+			Reactor_pool_->GetStatistics(Reactors);
 		}
 		[[nodiscard]] inline bool Running() const { return Running_; }
 
 		inline void AddConnection(uint64_t session_id,
 								  std::shared_ptr<AP_WS_Connection> Connection) {
-			std::lock_guard Lock(SessionMutex_);
-			Sessions_[session_id] = std::move(Connection);
+			auto sessionIndex = SessionIndex(session_id);
+			std::lock_guard Lock(SessionMutex_[sessionIndex]);
+			if (Sessions_[sessionIndex].insert_or_assign(session_id, std::move(Connection)).second)
+				NumberOfSessions_++;
+		}
+
+		[[nodiscard]] inline std::uint64_t NumberOfSessions() const { return NumberOfSessions_; }
+
+		//	Sums the outbound queues of all sessions. A shard is only locked while it is copied.
+		inline void GetSendQueueStatistics(std::uint64_t &QueuedFrames, std::uint64_t &QueuedBytes,
+										   std::uint64_t &DroppedFrames) const {
+			QueuedFrames = QueuedBytes = DroppedFrames = 0;
+			std::vector<std::shared_ptr<AP_WS_Connection>> Connections;
+			for (std::size_t i = 0; i < Sessions_.size(); ++i) {
+				Connections.clear();
+				{
+					std::lock_guard Lock(SessionMutex_[i]);
+					for (const auto &[_, Connection] : Sessions_[i])
+						Connections.push_back(Connection);
+				}
+				for (const auto &Connection : Connections) {
+					std::uint64_t Frames = 0, Bytes = 0, Dropped = 0;
+					Connection->GetSendQueueStatistics(Frames, Bytes, Dropped);
+					QueuedFrames += Frames;
+					QueuedBytes += Bytes;
+					DroppedFrames += Dropped;
+				}
+			}
 		}
 
 		inline bool DeviceRequiresSecureRtty(uint64_t serialNumber) const {
@@ -169,11 +201,33 @@ namespace OpenWifi {
 
 		void onGarbageCollecting(Poco::Timer &timer);
 
+		//	Computed from counters the connections keep up to date: nothing is walked.
 		inline void AverageDeviceStatistics(uint64_t &Connections, uint64_t &AverageConnectionTime,
 											uint64_t &NumberOfConnectingDevices) const {
-			Connections = NumberOfConnectedDevices_;
-			AverageConnectionTime = AverageDeviceConnectionTime_;
-			NumberOfConnectingDevices = NumberOfConnectingDevices_;
+			Connections = ConnectedDevices_;
+			std::uint64_t Sessions = NumberOfSessions_, Since = ConnectedSince_;
+			auto now = Utils::Now();
+			AverageConnectionTime = 0;
+			if (Connections > 0 && (Since / Connections) < now)
+				AverageConnectionTime = now - (Since / Connections);
+			NumberOfConnectingDevices = Sessions > Connections ? Sessions - Connections : 0;
+		}
+
+		inline void AddConnectedDevice(std::uint64_t Started) {
+			ConnectedSince_ += Started;
+			ConnectedDevices_++;
+		}
+
+		inline void RemoveConnectedDevice(std::uint64_t Started) {
+			ConnectedDevices_--;
+			ConnectedSince_ -= Started;
+		}
+
+		inline void SendQueueParameters(std::uint64_t &HighWatermark, std::uint64_t &LowWatermark,
+										SendQueuePolicy &Policy) const {
+			HighWatermark = SendQueueHighWatermark_;
+			LowWatermark = SendQueueLowWatermark_;
+			Policy = SendQueuePolicy_;
 		}
 
 		inline void AddRX(std::uint64_t bytes) {
@@ -192,13 +246,17 @@ namespace OpenWifi {
 			RX = RX_;
 		}
 
-		//	TOD: move to hash based map.
+		//	Walks one serial number shard at a time: a connect only waits for the shard it lands in.
 		inline bool GetHealthDevices(std::uint64_t lowLimit, std::uint64_t  highLimit, std::vector<std::string> & SerialNumbers) {
-			std::lock_guard Lock(SessionMutex_);
-			for(const auto &connection:Sessions_) {
-				if(	connection.second->RawLastHealthcheck_.Sanity>=lowLimit 	&&
-					connection.second->RawLastHealthcheck_.Sanity<=highLimit) {
-					SerialNumbers.push_back(connection.second->SerialNumber_);
+			for(int hashIndex=0;hashIndex<256;hashIndex++) {
+				std::lock_guard	G(SerialNumbersMutex_[hashIndex]);
+				for(const auto &[serialNumber,session]:SerialNumbers_[hashIndex]) {
+					const auto &connection = session.second;
+					if(	connection!=nullptr &&
+						connection->RawLastHealthcheck_.Sanity>=lowLimit 	&&
+						connection->RawLastHealthcheck_.Sanity<=highLimit) {
+						SerialNumbers.push_back(connection->SerialNumber_);
+					}
 				}
 			}
 			return true;
@@ -228,7 +286,6 @@ namespace OpenWifi {
 		}
 
 	  private:
-		mutable std::mutex 			SessionMutex_;
 		mutable std::mutex			StatsMutex_;
 		std::unique_ptr<Poco::Crypto::X509Certificate> IssuerCert_;
 		std::list<std::unique_ptr<Poco::Net::HTTPServer>> WebServers_;
@@ -241,9 +298,16 @@ namespace OpenWifi {
 		bool SimulatorEnabled_ = false;
 		std::unique_ptr<AP_WS_ReactorThreadPool> Reactor_pool_;
 		std::atomic_bool Running_ = false;
-		std::map<std::uint64_t, std::shared_ptr<AP_WS_Connection>> Sessions_;
 
-		using SerialNumberMap = std::map<uint64_t /* serial number */, std::pair<uint64_t /* session id*/,
+		//	Session ids are sequential: the low byte spreads them evenly over the shards.
+		using SessionMap = std::unordered_map<std::uint64_t /* session id */, std::shared_ptr<AP_WS_Connection>>;
+		static inline std::uint8_t SessionIndex(std::uint64_t session_id) { return session_id & 0xff; }
+
+		std::array<SessionMap,256>				Sessions_;
+		mutable std::array<std::mutex,256>		SessionMutex_;
+		std::atomic_uint64_t 					NumberOfSessions_ = 0;
+
+		using SerialNumberMap = std::unordered_map<uint64_t /* serial number */, std::pair<uint64_t /* session id*/,
 									 std::shared_ptr<AP_WS_Connection>>>;
 
 		std::array<SerialNumberMap,256>			SerialNumbers_;
@@ -252,15 +316,42 @@ namespace OpenWifi {
 		std::atomic_bool AllowSerialNumberMismatch_ = true;
 		std::atomic_uint64_t MismatchDepth_ = 2;
 
-		std::uint64_t 			NumberOfConnectedDevices_ = 0;
-		std::uint64_t 			AverageDeviceConnectionTime_ = 0;
-		std::uint64_t 			NumberOfConnectingDevices_ = 0;
+		std::atomic_uint64_t 	ConnectedDevices_ = 0;
+		std::atomic_uint64_t 	ConnectedSince_ = 0;	//	sum of the start times of connected devices
 		std::uint64_t 			SessionTimeOut_ = 10*60;
+		std::uint64_t 			SendQueueHighWatermark_ = 1024*1024;
+		std::uint64_t 			SendQueueLowWatermark_ = 256*1024;
+		SendQueuePolicy 		SendQueuePolicy_ = SendQueuePolicy::drop_newest;
 
 		std::atomic_uint64_t 	TX_=0,RX_=0;
 
+		std::mutex 										GarbageMutex_;
 		std::vector<std::shared_ptr<AP_WS_Connection>> Garbage_;
 
+		/*
+		 * 	Idle sessions are found with a timer wheel. A session sits in the slot of the time it
+		 * would expire if nothing is heard from it. Traffic only moves the connection's LastContact,
+		 * so when a slot comes due, each session in it is either really idle or re-filed at its new
+		 * expiry: every session is looked at about once per session timeout.
+		 */
+		struct IdleSession {
+			std::uint64_t SerialNumber = 0;
+			std::uint64_t SessionId = 0;
+		};
+		static constexpr std::uint64_t IdleSlotSeconds_ = 10;
+		std::mutex 										IdleMutex_;
+		std::vector<std::vector<IdleSession>> 			IdleWheel_;
+		std::uint64_t 									IdleWheelSlot_ = 0;
+
+		std::uint64_t 			LoadUpdateInterval_ = 60;
+		std::uint64_t 			LoadUpdateKeepAlive_ = 10*60;
+		std::uint64_t 			LastLoadUpdate_ = 0;
+		std::uint64_t 			LastLoadConnected_ = 0, LastLoadConnecting_ = 0;
+
+		void WatchIdle(std::uint64_t SerialNumber, std::uint64_t SessionId, std::uint64_t Expiry);
+		void EvictIdleSessions(std::uint64_t now);
+		void PostLoadUpdate(std::uint64_t now);
+
 		std::unique_ptr<Poco::TimerCallback<AP_WS_Server>> GarbageCollectorCallback_;
 		Poco::Timer Timer_;
 		Poco::Thread GarbageCollector_;
@@ -4,11 +4,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdio>
 #include <fstream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 
+#include "Poco/String.h"
+#include "Poco/Timer.h"
+
 #include "framework/MicroServiceFuncs.h"
 
 #include "CentralConfig.h"
@@ -20,6 +26,12 @@ namespace OpenWifi {
 
 	typedef std::map<std::string, nlohmann::json> CapabilitiesCache_t;
 
+	/*
+	 * 	Readers work on an immutable snapshot that is swapped atomically: they never wait for a
+	 * writer. A device connecting with a known device type and unchanged capabilities costs a
+	 * lookup and a string compare. Any change copies the snapshot and marks the cache dirty; the
+	 * files are rewritten at most once per flush interval.
+	 */
 	class CapabilitiesCache {
 	  public:
 		static auto instance() {
@@ -31,102 +43,129 @@ namespace OpenWifi {
 			if (Caps.Compatible().empty() || Caps.Platform().empty())
 				return;
 
-			std::lock_guard G(Mutex_);
-			if (!PlatformsLoaded_)
-				LoadPlatforms();
 			auto P = Poco::toUpper(Caps.Platform());
-			auto Hint = Platforms_.find(Caps.Compatible());
-			if (Hint == Platforms_.end()) {
-				Platforms_.insert(std::make_pair(Caps.Compatible(), P));
-				SavePlatforms();
-			} else if (Hint->second != P) {
-				Hint->second = P;
-				SavePlatforms();
-			}
+			if (!Changed(*Snapshot(), Caps.Compatible(), P, Caps.AsString()))
+				return;
 
-			if (!CapabilitiesLoaded_)
-				LoadCapabilities();
-
-			auto CapHint = Capabilities_.find(Caps.Compatible());
-			if (CapHint == Capabilities_.end()) {
-				auto C = nlohmann::json::parse(Caps.AsString());
-				C.erase("restrictions");
-				Capabilities_[Caps.Compatible()] = nlohmann::json::parse(Caps.AsString());
-				SaveCapabilities();
-			} else {
-				CapHint->second = nlohmann::json::parse(Caps.AsString());
-				SaveCapabilities();
-			}
-		}
+			auto C = nlohmann::json::parse(Caps.AsString());
+			C.erase("restrictions");
 
-		inline std::string GetPlatform(const std::string &DeviceType) {
 			std::lock_guard G(Mutex_);
+			auto Current = std::atomic_load(&Snapshot_);
+			if (!Changed(*Current, Caps.Compatible(), P, Caps.AsString()))
+				return;
+			auto Next = std::make_shared<CacheSnapshot>(*Current);
+			Next->Platforms[Caps.Compatible()] = P;
+			Next->Capabilities[Caps.Compatible()] = std::move(C);
+			Next->Sources[Caps.Compatible()] = Caps.AsString();
+			std::atomic_store(&Snapshot_, std::shared_ptr<const CacheSnapshot>(std::move(Next)));
+			Dirty_ = true;
+		}
 
-			if (!PlatformsLoaded_) {
-				LoadPlatforms();
-			}
-
-			auto Hint = Platforms_.find(DeviceType);
-			if (Hint == Platforms_.end())
+		inline std::string GetPlatform(const std::string &DeviceType) {
+			auto S = Snapshot();
+			auto Hint = S->Platforms.find(DeviceType);
+			if (Hint == S->Platforms.end())
 				return "AP";
 			return Hint->second;
 		}
 
 		inline nlohmann::json GetCapabilities(const std::string &DeviceType) {
-			std::lock_guard G(Mutex_);
-
-			if (!CapabilitiesLoaded_) {
-				LoadCapabilities();
-			}
-
-			auto Hint = Capabilities_.find(DeviceType);
-			if (Hint == Capabilities_.end())
+			auto S = Snapshot();
+			auto Hint = S->Capabilities.find(DeviceType);
+			if (Hint == S->Capabilities.end())
 				return nlohmann::json{};
 			return Hint->second;
 		}
 
-		inline const CapabilitiesCache_t &AllCapabilities() {
-			std::lock_guard G(Mutex_);
-			if (!CapabilitiesLoaded_) {
-				LoadCapabilities();
+		inline CapabilitiesCache_t AllCapabilities() { return Snapshot()->Capabilities; }
+
+		//	Started and stopped by the storage service, which owns the cache.
+		inline void Start() {
+			auto Interval = MicroServiceConfigGetInt("capabilities.cache.flushinterval", 10);
+			if (Interval == 0)
+				Interval = 1;
+			FlushCallback_ = std::make_unique<Poco::TimerCallback<CapabilitiesCache>>(
+				*this, &CapabilitiesCache::onFlushTimer);
+			FlushTimer_.setStartInterval(Interval * 1000);
+			FlushTimer_.setPeriodicInterval(Interval * 1000);
+			FlushTimer_.start(*FlushCallback_, MicroServiceTimerPool());
+		}
+
+		inline void Stop() {
+			if (FlushCallback_) {
+				FlushTimer_.stop();
+				FlushCallback_.reset();
 			}
-			return Capabilities_;
+			Flush();
+		}
+
+		inline void Flush() {
+			std::lock_guard G(FlushMutex_);
+			if (!Dirty_.exchange(false))
+				return;
+			auto S = Snapshot();
+			if (!Save(PlatformCacheFileName_, nlohmann::json(S->Platforms)) ||
+				!Save(CapabilitiesCacheFileName_, nlohmann::json(S->Capabilities)))
+				Dirty_ = true;
 		}
 
 	  private:
-		std::recursive_mutex Mutex_;
-		std::atomic_bool PlatformsLoaded_ = false;
-		std::atomic_bool CapabilitiesLoaded_ = false;
-		std::map<std::string, std::string> Platforms_;
-		CapabilitiesCache_t Capabilities_;
+		struct CacheSnapshot {
+			std::map<std::string, std::string> Platforms;
+			CapabilitiesCache_t Capabilities;
+			//	Capabilities as last received, to recognize a device that sends the same ones again.
+			std::map<std::string, std::string> Sources;
+		};
+
+		std::mutex Mutex_;
+		std::mutex FlushMutex_;
+		std::shared_ptr<const CacheSnapshot> Snapshot_;
+		std::atomic_bool Dirty_ = false;
 		std::string PlatformCacheFileName_{MicroServiceDataDirectory() + PlatformCacheFileName};
 		std::string CapabilitiesCacheFileName_{MicroServiceDataDirectory() +
 											   CapabilitiesCacheFileName};
+		Poco::Timer FlushTimer_;
+		std::unique_ptr<Poco::TimerCallback<CapabilitiesCache>> FlushCallback_;
+
+		CapabilitiesCache() = default;
+
+		inline void onFlushTimer([[maybe_unused]] Poco::Timer &timer) { Flush(); }
 
-		inline void LoadPlatforms() {
+		static inline bool Changed(const CacheSnapshot &S, const std::string &Compatible,
+								   const std::string &Platform, const std::string &Source) {
+			auto PlatformHint = S.Platforms.find(Compatible);
+			if (PlatformHint == S.Platforms.end() || PlatformHint->second != Platform)
+				return true;
+			auto SourceHint = S.Sources.find(Compatible);
+			return SourceHint == S.Sources.end() || SourceHint->second != Source;
+		}
+
+		inline std::shared_ptr<const CacheSnapshot> Snapshot() {
+			auto S = std::atomic_load(&Snapshot_);
+			if (S)
+				return S;
+			std::lock_guard G(Mutex_);
+			S = std::atomic_load(&Snapshot_);
+			if (!S) {
+				S = Load();
+				std::atomic_store(&Snapshot_, S);
+			}
+			return S;
+		}
+
+		inline std::shared_ptr<const CacheSnapshot> Load() {
+			auto S = std::make_shared<CacheSnapshot>();
 			try {
 				std::ifstream i(PlatformCacheFileName_);
 				nlohmann::json cache;
 				i >> cache;
 
 				for (const auto &[Type, Platform] : cache.items()) {
-					Platforms_[Type] = Platform;
+					S->Platforms[Type] = Platform;
 				}
 			} catch (...) {
 			}
-			PlatformsLoaded_ = true;
-		}
-
-		inline void SavePlatforms() {
-			try {
-				std::ofstream i(PlatformCacheFileName_);
-				nlohmann::json cache(Platforms_);
-				i << cache;
-			} catch (...) {
-			}
-		}
-
-		inline void LoadCapabilities() {
 			try {
 				std::ifstream i(CapabilitiesCacheFileName_,
 								std::ios_base::binary | std::ios_base::in);
@@ -134,24 +173,32 @@ namespace OpenWifi {
 				i >> cache;
 
 				for (const auto &[Type, Caps] : cache.items()) {
-					Capabilities_[Type] = Caps;
+					S->Capabilities[Type] = Caps;
 				}
 			} catch (...) {
 			}
-			CapabilitiesLoaded_ = true;
+			return S;
 		}
 
-		inline void SaveCapabilities() {
+		//	Written next to the target and renamed over it, so a reader never sees a partial file.
+		static inline bool Save(const std::string &FileName, const nlohmann::json &Doc) {
 			try {
-				std::ofstream i(CapabilitiesCacheFileName_,
-								std::ios_base::trunc | std::ios_base::out | std::ios_base::binary);
-				nlohmann::json cache(Capabilities_);
-				i << cache;
+				auto TmpName = FileName + ".tmp";
+				{
+					std::ofstream o(TmpName,
+									std::ios_base::trunc | std::ios_base::out | std::ios_base::binary);
+					o << Doc;
+					o.close();
+					if (o.fail())
+						return false;
+				}
+				return std::rename(TmpName.c_str(), FileName.c_str()) == 0;
 			} catch (...) {
 			}
+			return false;
 		}
 	};
 
 	inline auto CapabilitiesCache() { return CapabilitiesCache::instance(); };
 
-} // namespace OpenWifi
\ No newline at end of file
+} // namespace OpenWifi
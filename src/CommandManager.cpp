@@ -42,47 +42,31 @@ namespace OpenWifi {
 						if (ID > 1) {
 							poco_debug(Logger(), fmt::format("({}): Processing {} response.",
 															 SerialNumberStr, ID));
-							std::lock_guard Lock(LocalMutex_);
-							auto RPC = OutStandingRequests_.find(ID);
-							if (RPC == OutStandingRequests_.end()) {
-								//								std::cout << __LINE__ << std::endl;
+							CommandInfo Command;
+							if (!GetRequest(Resp->SerialNumber_, ID, Command)) {
 								poco_debug(Logger(), fmt::format("({}): RPC {} cannot be found.",
 																 SerialNumberStr, ID));
-							} else if (RPC->second.SerialNumber != Resp->SerialNumber_) {
-								//								std::cout << __LINE__ << std::endl;
-								poco_debug(
-									Logger(),
-									fmt::format("({}): RPC {} serial number mismatch {}!={}.",
-												SerialNumberStr, ID, RPC->second.SerialNumber,
-												Resp->SerialNumber_));
 							} else {
-								std::shared_ptr<promise_type_t> TmpRpcEntry;
 								std::chrono::duration<double, std::milli> rpc_execution_time =
-									std::chrono::high_resolution_clock::now() -
-									RPC->second.submitted;
-								//								std::cout << __LINE__ << std::endl;
+									std::chrono::high_resolution_clock::now() - Command.submitted;
 								poco_debug(Logger(),
 										   fmt::format("({}): Received RPC answer {}. Command={}",
 													   SerialNumberStr, ID,
-													   APCommands::to_string(RPC->second.Command)));
-								if (RPC->second.Command == APCommands::Commands::script) {
-									CompleteScriptCommand(RPC->second, Payload, rpc_execution_time);
-								} else if (RPC->second.Command == APCommands::Commands::telemetry) {
-									CompleteTelemetryCommand(RPC->second, Payload,
-															 rpc_execution_time);
-								} else if (RPC->second.Command == APCommands::Commands::configure && RPC->second.rpc_entry==nullptr) {
-									CompleteConfigureCommand(RPC->second, Payload,
-															 rpc_execution_time);
+													   APCommands::to_string(Command.Command)));
+								if (Command.Command == APCommands::Commands::script) {
+									CompleteScriptCommand(Command, Payload, rpc_execution_time);
+								} else if (Command.Command == APCommands::Commands::telemetry) {
+									CompleteTelemetryCommand(Command, Payload, rpc_execution_time);
+								} else if (Command.Command == APCommands::Commands::configure &&
+										   Command.rpc_entry == nullptr) {
+									CompleteConfigureCommand(Command, Payload, rpc_execution_time);
 								} else {
-									StorageService()->CommandCompleted(RPC->second.UUID, Payload,
+									StorageService()->CommandCompleted(Command.UUID, Payload,
 																	   rpc_execution_time, true);
-									if (RPC->second.rpc_entry) {
-										TmpRpcEntry = RPC->second.rpc_entry;
-									}
-									RPC->second.State = 0;
-									OutStandingRequests_.erase(ID);
-									if (TmpRpcEntry != nullptr)
-										TmpRpcEntry->set_value(Payload);
+									Command.State = 0;
+									FinalizeCommand(Command);
+									if (Command.rpc_entry != nullptr)
+										Command.rpc_entry->set_value(Payload);
 								}
 							}
 						}
@@ -110,7 +94,7 @@ namespace OpenWifi {
 		}
 		Command.State = 0;
 
-		OutStandingRequests_.erase(Command.Id);
+		FinalizeCommand(Command);
 		if (TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
 		return true;
@@ -148,7 +132,7 @@ namespace OpenWifi {
 			TmpRpcEntry = Command.rpc_entry;
 		}
 
-		OutStandingRequests_.erase(Command.Id);
+		FinalizeCommand(Command);
 		if (TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
 		return true;
@@ -201,10 +185,7 @@ namespace OpenWifi {
 			Command.State = 0;
 		}
 
-		if (Command.State == 0) {
-			//			std::cout << __LINE__ << "  State=" << Command.State << std::endl;
-			OutStandingRequests_.erase(Command.Id);
-		}
+		FinalizeCommand(Command);
 		if (Reply && TmpRpcEntry != nullptr)
 			TmpRpcEntry->set_value(Payload);
 
@@ -218,8 +199,21 @@ namespace OpenWifi {
 		commandRetry_ = MicroServiceConfigGetInt("command.retry", 120);
 		janitorInterval_ = MicroServiceConfigGetInt("command.janitor", 2 * 60); //	1 hour
 		queueInterval_ = MicroServiceConfigGetInt("command.queue", 30);
+		if (queueInterval_ == 0)
+			queueInterval_ = 1;
+
+		std::vector<GWObjects::CommandDetails> Pending;
+		StorageService()->GetPendingCommands(Pending);
+		{
+			std::lock_guard G(SchedulerMutex_);
+			for (const auto &Command : Pending)
+				QueueCommand(Command);
+		}
+		poco_information(Logger(), fmt::format("Loaded {} pending commands.", Pending.size()));
 
+		Running_ = true;
 		ManagerThread.start(*this);
+		SchedulerThread_.start(SchedulerRunner_);
 
 		JanitorCallback_ = std::make_unique<Poco::TimerCallback<CommandManager>>(
 			*this, &CommandManager::onJanitorTimer);
@@ -241,6 +235,11 @@ namespace OpenWifi {
 		Running_ = false;
 		JanitorTimer_.stop();
 		CommandRunnerTimer_.stop();
+		{
+			std::lock_guard G(SchedulerMutex_);
+		}
+		SchedulerSignal_.notify_all();
+		SchedulerThread_.join();
 		ResponseQueue_.wakeUpAll();
 		ManagerThread.wakeUp();
 		ManagerThread.join();
@@ -252,169 +251,351 @@ namespace OpenWifi {
 		ManagerThread.wakeUp();
 	}
 
+	void CommandManager::AddRequest(const CommandInfo &Command) {
+		auto &Shard = ShardFor(Command.SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		auto Existing = Shard.Requests.find(Command.Id);
+		if (Existing != Shard.Requests.end())
+			EraseRequest(Shard, Existing);
+		Shard.Requests[Command.Id] = Command;
+		Shard.BySerialNumber[Command.SerialNumber].insert(Command.Id);
+		Shard.ByUUID[Command.UUID] = Command.Id;
+	}
+
+	bool CommandManager::GetRequest(std::uint64_t SerialNumber, std::uint64_t Id,
+									CommandInfo &Command) {
+		auto &Shard = ShardFor(SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		auto Request = Shard.Requests.find(Id);
+		if (Request == Shard.Requests.end() || Request->second.SerialNumber != SerialNumber)
+			return false;
+		Command = Request->second;
+		return true;
+	}
+
+	//	Completion handlers work on a copy of the command. Write its new state back, or drop it
+	//	once it is done. A command the janitor removed in the meantime stays removed.
+	void CommandManager::FinalizeCommand(const CommandInfo &Command) {
+		auto &Shard = ShardFor(Command.SerialNumber);
+		bool Done = false;
+		{
+			std::lock_guard Lock(Shard.Mutex);
+			auto Request = Shard.Requests.find(Command.Id);
+			if (Request == Shard.Requests.end())
+				return;
+			if (Command.State == 0) {
+				EraseRequest(Shard, Request);
+				Done = true;
+			} else {
+				Request->second.State = Command.State;
+			}
+		}
+		if (Done)
+			DeviceReady(Command.SerialNumber);
+	}
+
 	void CommandManager::onJanitorTimer([[maybe_unused]] Poco::Timer &timer) {
-		std::lock_guard Lock(LocalMutex_);
 		Utils::SetThreadName("cmd:janitor");
 		Poco::Logger &MyLogger = Poco::Logger::get("CMD-MGR-JANITOR");
 		std::string TimeOutError("No response.");
 
 		auto now = std::chrono::high_resolution_clock::now();
-		for (auto request = OutStandingRequests_.begin(); request != OutStandingRequests_.end();) {
-			std::chrono::duration<double, std::milli> delta = now - request->second.submitted;
-			if (delta > 10min) {
-				//				std::cout << __LINE__ << "  -->> " << request->second.Id <<
-				// std::endl;
-				MyLogger.debug(fmt::format("{}: Command={} for {} Timed out.", request->second.UUID,
-										   APCommands::to_string(request->second.Command),
-										   Utils::IntToSerialNumber(request->second.SerialNumber)));
-				if ((request->second.Command == APCommands::Commands::script &&
-					 request->second.Deferred) ||
-					(request->second.Command == APCommands::Commands::trace)) {
-					StorageService()->CancelWaitFile(request->second.UUID, TimeOutError);
+		std::uint64_t Outstanding = 0;
+		for (auto &Shard : Shards_) {
+			std::vector<CommandInfo> TimedOut;
+			{
+				std::lock_guard Lock(Shard.Mutex);
+				for (auto request = Shard.Requests.begin(); request != Shard.Requests.end();) {
+					std::chrono::duration<double, std::milli> delta =
+						now - request->second.submitted;
+					if (delta > 10min) {
+						TimedOut.emplace_back(request->second);
+						auto Expired = request++;
+						EraseRequest(Shard, Expired);
+					} else {
+						++request;
+					}
 				}
-				StorageService()->SetCommandTimedOut(request->second.UUID);
-				request = OutStandingRequests_.erase(request);
-			} else {
-				//				std::cout << __LINE__ << "  -->> " << request->second.Id <<
-				// std::endl;
-				++request;
+				Outstanding += Shard.Requests.size();
+			}
+
+			//	Storage updates are done without holding the shard.
+			for (const auto &Command : TimedOut) {
+				MyLogger.debug(fmt::format("{}: Command={} for {} Timed out.", Command.UUID,
+										   APCommands::to_string(Command.Command),
+										   Utils::IntToSerialNumber(Command.SerialNumber)));
+				if ((Command.Command == APCommands::Commands::script && Command.Deferred) ||
+					(Command.Command == APCommands::Commands::trace)) {
+					StorageService()->CancelWaitFile(Command.UUID, TimeOutError);
+				}
+				StorageService()->SetCommandTimedOut(Command.UUID);
+				DeviceReady(Command.SerialNumber);
 			}
 		}
-		poco_information(MyLogger,
-						 fmt::format("Outstanding-requests {}", OutStandingRequests_.size()));
+		poco_information(MyLogger, fmt::format("Outstanding-requests {}", Outstanding));
 	}
 
-	bool CommandManager::IsCommandRunning(const std::string &C) {
-		std::lock_guard Lock(LocalMutex_);
-		return std::any_of(
-			OutStandingRequests_.begin(), OutStandingRequests_.end(),
-			[C](const std::pair<std::uint64_t, CommandInfo> &r) { return r.second.UUID == C; });
+	bool CommandManager::IsCommandRunning(std::uint64_t SerialNumber, const std::string &UUID) {
+		auto &Shard = ShardFor(SerialNumber);
+		std::lock_guard Lock(Shard.Mutex);
+		return Shard.ByUUID.find(UUID) != Shard.ByUUID.end();
 	}
 
+	//	The database marks expired commands itself. Forget them here too, so devices that never
+	//	come back do not keep their commands in memory.
 	void CommandManager::onCommandRunnerTimer([[maybe_unused]] Poco::Timer &timer) {
-		Utils::SetThreadName("cmd:schdlr");
+		Utils::SetThreadName("cmd:expire");
 		Poco::Logger &MyLogger = Poco::Logger::get("CMD-MGR-SCHEDULER");
 
-		poco_trace(MyLogger, "Scheduler starting.");
-
 		try {
-
 			StorageService()->RemovedExpiredCommands();
 			StorageService()->RemoveTimedOutCommands();
 
-			std::uint64_t offset = 0;
-			bool Done = false;
-			while (!Done) {
-				std::vector<GWObjects::CommandDetails> Commands;
-				if (StorageService()->GetReadyToExecuteCommands(offset, 200, Commands)) {
-					if(Commands.empty()) {
-						Done=true;
-						continue;
+			auto Now = Utils::Now();
+			std::uint64_t Expired = 0, Remaining = 0;
+			std::lock_guard G(SchedulerMutex_);
+			for (auto Device = Queued_.begin(); Device != Queued_.end();) {
+				auto &Commands = Device->second.Commands;
+				for (auto Command = Commands.begin(); Command != Commands.end();) {
+					if ((Now - Command->second.Submitted) > commandTimeOut_) {
+						Command = Commands.erase(Command);
+						++Expired;
+					} else {
+						++Command;
 					}
-					poco_trace(MyLogger, fmt::format("Scheduler about to process {} commands.",
-													 Commands.size()));
-					for (auto &Cmd : Commands) {
-						if (!Running_) {
-							poco_warning(MyLogger,
-										 "Scheduler quitting because service is stopping.");
-							break;
-						}
-						poco_trace(MyLogger,
-								   fmt::format("{}: Serial={} Command={} Starting processing.",
-											   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-						try {
-
-							//	Skip an already running command
-							if (IsCommandRunning(Cmd.UUID)) {
-								continue;
-							}
+				}
+				Remaining += Commands.size();
+				if (Commands.empty())
+					Device = Queued_.erase(Device);
+				else
+					++Device;
+			}
+			poco_trace(MyLogger, fmt::format("Queued commands: {} ({} expired).", Remaining,
+											 Expired));
+		} catch (const Poco::Exception &E) {
+			MyLogger.log(E);
+		} catch (...) {
+			poco_warning(MyLogger, "Exception during command expiry.");
+		}
+	}
 
-							auto now = Utils::Now();
-							// 2 hour timeout for commands
-							if ((now - Cmd.Submitted) > commandTimeOut_) {
-								poco_information(
-									MyLogger, fmt::format("{}: Serial={} Command={} has expired.",
-														  Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandTimedOut(Cmd.UUID);
-								continue;
-							}
+	void CommandManager::QueueCommand(const GWObjects::CommandDetails &Command) {
+		QueuedCommand Q;
+		Q.UUID = Command.UUID;
+		Q.Submitted = Command.Submitted;
+		Q.RunAt = Command.RunAt;
+		Q.LastTry = Command.lastTry;
+		auto SerialNumber = Utils::SerialNumberToInt(Command.SerialNumber);
+		Queued_[SerialNumber].Commands[std::make_pair(Q.Submitted, Q.UUID)] = Q;
+		ReadyDevices_.insert(SerialNumber);
+	}
 
-							auto SerialNumberInt = Utils::SerialNumberToInt(Cmd.SerialNumber);
-							if (!AP_WS_Server()->Connected(SerialNumberInt)) {
-								poco_trace(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Device is not connected.",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandLastTry(Cmd.UUID);
-								continue;
-							}
+	void CommandManager::CommandQueued(const GWObjects::CommandDetails &Command) {
+		{
+			std::lock_guard G(SchedulerMutex_);
+			QueueCommand(Command);
+		}
+		SchedulerSignal_.notify_one();
+	}
 
-							std::string ExecutingUUID;
-							APCommands::Commands ExecutingCommand = APCommands::Commands::unknown;
-							if (CommandRunningForDevice(SerialNumberInt, ExecutingUUID,
-														ExecutingCommand)) {
-								poco_trace(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Device is already busy "
-												"with command {} (Command={}).",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command,
-												ExecutingUUID,
-												APCommands::to_string(ExecutingCommand)));
-								continue;
-							}
+	void CommandManager::DeviceReady(std::uint64_t SerialNumber) {
+		{
+			std::lock_guard G(SchedulerMutex_);
+			if (Queued_.find(SerialNumber) == Queued_.end())
+				return;
+			ReadyDevices_.insert(SerialNumber);
+		}
+		SchedulerSignal_.notify_one();
+	}
 
-							Poco::JSON::Parser P;
-							bool Sent;
-							poco_information(
-								MyLogger,
-								fmt::format("{}: Serial={} Command={} Preparing execution.",
-											Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							auto Params = P.parse(Cmd.Details).extract<Poco::JSON::Object::Ptr>();
-							auto Result = PostCommandDisk(
-								Next_RPC_ID(), APCommands::to_apcommand(Cmd.Command.c_str()),
-								Cmd.SerialNumber, Cmd.Command, *Params, Cmd.UUID, Sent);
-							if (Sent) {
-								StorageService()->SetCommandExecuted(Cmd.UUID);
-								poco_debug(MyLogger,
-										   fmt::format("{}: Serial={} Command={} Sent.", Cmd.UUID,
-													   Cmd.SerialNumber, Cmd.Command));
-							} else {
-								poco_debug(
-									MyLogger,
-									fmt::format("{}: Serial={} Command={} Re-queued command.",
-												Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-								StorageService()->SetCommandLastTry(Cmd.UUID);
-							}
-						} catch (const Poco::Exception &E) {
-							poco_debug(
-								MyLogger,
-								fmt::format(
-									"{}: Serial={} Command={} Failed. Command marked as completed.",
-									Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							MyLogger.log(E);
-							StorageService()->SetCommandExecuted(Cmd.UUID);
-						} catch (...) {
-							poco_debug(MyLogger,
-									   fmt::format("{}: Serial={} Command={} Hard failure. "
-												   "Command marked as completed.",
-												   Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
-							StorageService()->SetCommandExecuted(Cmd.UUID);
-						}
-					}
-					offset += Commands.size();
-				} else {
-					Done=true;
-					continue;
+	//	Only the earliest wake-up of a device is kept. A later one left in WakeUps_ is harmless.
+	void CommandManager::ScheduleWakeUp(std::uint64_t SerialNumber, std::uint64_t When) {
+		auto Device = Queued_.find(SerialNumber);
+		if (Device == Queued_.end())
+			return;
+		if (Device->second.WakeUp != 0 && Device->second.WakeUp <= When)
+			return;
+		Device->second.WakeUp = When;
+		WakeUps_.emplace(When, SerialNumber);
+	}
+
+	//	First command in submission order that may run now. Expired commands are returned too, so
+	//	the caller can mark them.
+	bool CommandManager::NextDueCommand(std::uint64_t SerialNumber, QueuedCommand &Command) {
+		auto Device = Queued_.find(SerialNumber);
+		if (Device == Queued_.end())
+			return false;
+
+		auto Now = Utils::Now();
+		std::uint64_t Earliest = 0;
+		for (const auto &[Key, Q] : Device->second.Commands) {
+			auto Due = std::max(Q.RunAt, Q.LastTry ? Q.LastTry + commandRetry_ + 1 : 0);
+			if ((Now - Q.Submitted) > commandTimeOut_ || Due <= Now) {
+				Command = Q;
+				return true;
+			}
+			if (Earliest == 0 || Due < Earliest)
+				Earliest = Due;
+		}
+		if (Earliest != 0)
+			ScheduleWakeUp(SerialNumber, Earliest);
+		return false;
+	}
+
+	void CommandManager::Dequeue(std::uint64_t SerialNumber, const QueuedCommand &Command) {
+		std::lock_guard G(SchedulerMutex_);
+		auto Device = Queued_.find(SerialNumber);
+		if (Device == Queued_.end())
+			return;
+		Device->second.Commands.erase(std::make_pair(Command.Submitted, Command.UUID));
+		if (Device->second.Commands.empty())
+			Queued_.erase(Device);
+	}
+
+	void CommandManager::RunScheduler() {
+		Utils::SetThreadName("cmd:schdlr");
+		Poco::Logger &MyLogger = Poco::Logger::get("CMD-MGR-SCHEDULER");
+
+		poco_trace(MyLogger, "Scheduler starting.");
+		while (Running_) {
+			std::vector<std::uint64_t> Devices;
+			{
+				std::unique_lock Lock(SchedulerMutex_);
+				auto Wait = std::chrono::seconds(queueInterval_);
+				if (!WakeUps_.empty()) {
+					auto Now = Utils::Now(), Next = WakeUps_.begin()->first;
+					Wait = std::chrono::seconds(
+						Next > Now ? std::min<std::uint64_t>(Next - Now, queueInterval_) : 0);
+				}
+				SchedulerSignal_.wait_for(Lock, Wait,
+										  [this] { return !Running_ || !ReadyDevices_.empty(); });
+				if (!Running_)
+					break;
+
+				auto Now = Utils::Now();
+				while (!WakeUps_.empty() && WakeUps_.begin()->first <= Now) {
+					auto [When, SerialNumber] = *WakeUps_.begin();
+					WakeUps_.erase(WakeUps_.begin());
+					auto Device = Queued_.find(SerialNumber);
+					if (Device == Queued_.end())
+						continue;
+					if (Device->second.WakeUp == When)
+						Device->second.WakeUp = 0;
+					ReadyDevices_.insert(SerialNumber);
+				}
+				Devices.assign(ReadyDevices_.begin(), ReadyDevices_.end());
+				ReadyDevices_.clear();
+			}
+
+			for (const auto &SerialNumber : Devices) {
+				if (!Running_) {
+					poco_warning(MyLogger, "Scheduler quitting because service is stopping.");
+					break;
+				}
+				try {
+					RunDeviceQueue(SerialNumber, MyLogger);
+				} catch (const Poco::Exception &E) {
+					MyLogger.log(E);
+				} catch (...) {
+					poco_warning(MyLogger, "Exception during command processing.");
 				}
 			}
 		}
-		catch (Poco::Exception &E) {
-			MyLogger.log(E);
+		poco_trace(MyLogger, "Scheduler done.");
+	}
+
+	//	A device runs one queued command at a time: its answer puts the device back on the ready list.
+	void CommandManager::RunDeviceQueue(std::uint64_t SerialNumber, Poco::Logger &MyLogger) {
+		//	Connecting puts the device back on the ready list.
+		if (!AP_WS_Server()->Connected(SerialNumber))
+			return;
+
+		std::string ExecutingUUID;
+		APCommands::Commands ExecutingCommand = APCommands::Commands::unknown;
+		if (CommandRunningForDevice(SerialNumber, ExecutingUUID, ExecutingCommand)) {
+			poco_trace(MyLogger, fmt::format("Serial={} Device is already busy with command {} "
+											 "(Command={}).",
+											 Utils::IntToSerialNumber(SerialNumber), ExecutingUUID,
+											 APCommands::to_string(ExecutingCommand)));
+			//	In case the answer never comes.
+			std::lock_guard G(SchedulerMutex_);
+			ScheduleWakeUp(SerialNumber, Utils::Now() + commandRetry_);
+			return;
 		}
-		catch (...) {
-			poco_warning(MyLogger, "Exception during command processing.");
+
+		while (Running_) {
+			QueuedCommand Next;
+			{
+				std::lock_guard G(SchedulerMutex_);
+				if (!NextDueCommand(SerialNumber, Next))
+					return;
+			}
+
+			auto UUID = Next.UUID;
+			GWObjects::CommandDetails Cmd;
+			try {
+				if ((Utils::Now() - Next.Submitted) > commandTimeOut_) {
+					poco_information(MyLogger, fmt::format("{}: Serial={} has expired.", UUID,
+														   Utils::IntToSerialNumber(SerialNumber)));
+					StorageService()->SetCommandTimedOut(UUID);
+					Dequeue(SerialNumber, Next);
+					continue;
+				}
+
+				//	Deleted or completed by someone else since it was queued.
+				if (!StorageService()->GetCommand(UUID, Cmd) || Cmd.UUID != UUID ||
+					Cmd.Executed != 0) {
+					poco_trace(MyLogger, fmt::format("{}: Serial={} No longer pending.", UUID,
+													 Utils::IntToSerialNumber(SerialNumber)));
+					Dequeue(SerialNumber, Next);
+					continue;
+				}
+
+				Poco::JSON::Parser P;
+				bool Sent;
+				poco_information(MyLogger,
+								 fmt::format("{}: Serial={} Command={} Preparing execution.",
+											 Cmd.UUID, Cmd.SerialNumber, Cmd.Command));
+				auto Params = P.parse(Cmd.Details).extract<Poco::JSON::Object::Ptr>();
+				auto Result = PostCommandDisk(Next_RPC_ID(),
+											  APCommands::to_apcommand(Cmd.Command.c_str()),
+											  Cmd.SerialNumber, Cmd.Command, *Params, Cmd.UUID, Sent);
+				if (Sent) {
+					StorageService()->SetCommandExecuted(Cmd.UUID);
+					Dequeue(SerialNumber, Next);
+					poco_debug(MyLogger, fmt::format("{}: Serial={} Command={} Sent.", Cmd.UUID,
+													 Cmd.SerialNumber, Cmd.Command));
+				} else {
+					poco_debug(MyLogger,
+							   fmt::format("{}: Serial={} Command={} Re-queued command.", Cmd.UUID,
+										   Cmd.SerialNumber, Cmd.Command));
+					StorageService()->SetCommandLastTry(Cmd.UUID);
+					std::lock_guard G(SchedulerMutex_);
+					auto Device = Queued_.find(SerialNumber);
+					if (Device != Queued_.end()) {
+						auto Q = Device->second.Commands.find(
+							std::make_pair(Next.Submitted, Next.UUID));
+						if (Q != Device->second.Commands.end())
+							Q->second.LastTry = Utils::Now();
+					}
+					ScheduleWakeUp(SerialNumber, Utils::Now() + commandRetry_ + 1);
+				}
+				return;
+			} catch (const Poco::Exception &E) {
+				poco_debug(MyLogger,
+						   fmt::format("{}: Serial={} Command={} Failed. Command marked as completed.",
+									   UUID, Cmd.SerialNumber, Cmd.Command));
+				MyLogger.log(E);
+				StorageService()->SetCommandExecuted(UUID);
+				Dequeue(SerialNumber, Next);
+			} catch (...) {
+				poco_debug(MyLogger, fmt::format("{}: Serial={} Command={} Hard failure. "
+												 "Command marked as completed.",
+												 UUID, Cmd.SerialNumber, Cmd.Command));
+				StorageService()->SetCommandExecuted(UUID);
+				Dequeue(SerialNumber, Next);
+			}
 		}
-		poco_trace(MyLogger, "Scheduler done.");
 	}
 
 	std::shared_ptr<CommandManager::promise_type_t> CommandManager::PostCommand(
@@ -452,16 +633,15 @@ namespace OpenWifi {
 		//	Do not change the order. It is possible that an RPC completes before it is entered in
 		// the map. So we insert it 	first, even if we may need to remove it later upon failure.
 		if (!oneway_rpc) {
-			std::lock_guard M(Mutex_);
-			OutStandingRequests_[RPC_ID] = CInfo;
+			AddRequest(CInfo);
 		}
 		if (AP_WS_Server()->SendFrame(SerialNumber, ToSend.str())) {
 			poco_debug(Logger(), fmt::format("{}: Sent command. ID: {}", UUID, RPC_ID));
 			Sent = true;
 			return CInfo.rpc_entry;
 		} else if (!oneway_rpc) {
-			std::lock_guard M(Mutex_);
-			OutStandingRequests_.erase(RPC_ID);
+			CInfo.State = 0;
+			FinalizeCommand(CInfo);
 		}
 
 		poco_warning(Logger(), fmt::format("{}: Failed to send command. ID: {}", UUID, RPC_ID));
@@ -8,11 +8,15 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <map>
 #include <mutex>
+#include <set>
+#include <unordered_map>
 #include <utility>
 
 #include "Poco/JSON/Object.h"
@@ -20,10 +24,13 @@
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Notification.h"
 #include "Poco/NotificationQueue.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/Thread.h"
 #include "Poco/Timer.h"
 
 #include "fmt/format.h"
 #include "framework/SubSystemServer.h"
+#include "framework/utils.h"
 
 #include "RESTObjects/RESTAPI_GWobjects.h"
 
@@ -105,7 +112,13 @@ namespace OpenWifi {
 							   Sent, false);
 		}
 
-		bool IsCommandRunning(const std::string &C);
+		//	Commands are looked up in the shard of their device, never by walking every shard.
+		bool IsCommandRunning(std::uint64_t SerialNumber, const std::string &UUID);
+
+		//	A command was stored and still has to run on the device.
+		void CommandQueued(const GWObjects::CommandDetails &Command);
+		//	The device connected or finished a command: run what is queued for it.
+		void DeviceReady(std::uint64_t SerialNumber);
 
 		void run() override;
 
@@ -119,44 +132,64 @@ namespace OpenWifi {
 		void onCommandRunnerTimer(Poco::Timer &timer);
 		inline uint64_t Next_RPC_ID() { return ++Id_; }
 
-		void RemovePendingCommand(std::uint64_t Id) {
-			std::unique_lock Lock(LocalMutex_);
-			OutStandingRequests_.erase(Id);
+		//	Removing a command frees the device: whatever is queued behind it is dispatched.
+		void RemovePendingCommand(std::uint64_t SerialNumber, std::uint64_t Id) {
+			auto &Shard = ShardFor(SerialNumber);
+			{
+				std::lock_guard Lock(Shard.Mutex);
+				auto Request = Shard.Requests.find(Id);
+				if (Request == Shard.Requests.end() ||
+					Request->second.SerialNumber != SerialNumber)
+					return;
+				EraseRequest(Shard, Request);
+			}
+			DeviceReady(SerialNumber);
 		}
 
 		inline bool CommandRunningForDevice(std::uint64_t SerialNumber, std::string &uuid,
 											APCommands::Commands &command) {
-			std::lock_guard Lock(LocalMutex_);
-
-			for (const auto &[Request, Command] : OutStandingRequests_) {
-				if (Command.SerialNumber == SerialNumber) {
-					uuid = Command.UUID;
-					command = Command.Command;
-					return true;
-				}
-			}
-			return false;
+			auto &Shard = ShardFor(SerialNumber);
+			std::lock_guard Lock(Shard.Mutex);
+			auto Ids = Shard.BySerialNumber.find(SerialNumber);
+			if (Ids == Shard.BySerialNumber.end() || Ids->second.empty())
+				return false;
+			auto Request = Shard.Requests.find(*Ids->second.begin());
+			if (Request == Shard.Requests.end())
+				return false;
+			uuid = Request->second.UUID;
+			command = Request->second.Command;
+			return true;
 		}
 
 		inline void ClearQueue(std::uint64_t SerialNumber) {
-			std::lock_guard Lock(LocalMutex_);
-			for (auto Request = OutStandingRequests_.begin();
-				 Request != OutStandingRequests_.end();) {
-				if (Request->second.SerialNumber == SerialNumber)
-					Request = OutStandingRequests_.erase(Request);
-				else
-					++Request;
+			auto &Shard = ShardFor(SerialNumber);
+			{
+				std::lock_guard Lock(Shard.Mutex);
+				auto Ids = Shard.BySerialNumber.find(SerialNumber);
+				if (Ids == Shard.BySerialNumber.end())
+					return;
+				auto ToRemove = Ids->second;
+				for (const auto &Id : ToRemove) {
+					auto Request = Shard.Requests.find(Id);
+					if (Request != Shard.Requests.end())
+						EraseRequest(Shard, Request);
+				}
 			}
+			DeviceReady(SerialNumber);
 		}
 
-		inline void RemoveCommand(const std::string &UUID) {
-			std::lock_guard Lock(LocalMutex_);
-			for (const auto &[Id, Cmd] : OutStandingRequests_) {
-				if (Cmd.UUID == UUID) {
-					OutStandingRequests_.erase(Id);
+		inline void RemoveCommand(std::uint64_t SerialNumber, const std::string &UUID) {
+			auto &Shard = ShardFor(SerialNumber);
+			{
+				std::lock_guard Lock(Shard.Mutex);
+				auto Id = Shard.ByUUID.find(UUID);
+				if (Id == Shard.ByUUID.end())
 					return;
-				}
+				auto Request = Shard.Requests.find(Id->second);
+				if (Request != Shard.Requests.end())
+					EraseRequest(Shard, Request);
 			}
+			DeviceReady(SerialNumber);
 		}
 
 		inline auto CommandTimeout() const { return commandTimeOut_; }
@@ -165,11 +198,24 @@ namespace OpenWifi {
 		bool FireAndForget(const std::string &SerialNumber, const std::string &Method,
 						   const Poco::JSON::Object &Params);
 	  private:
-		mutable std::mutex LocalMutex_;
+		/*
+		 * 	Outstanding RPCs are sharded by device, with the same hash as the device sessions. Each
+		 * shard indexes its commands by RPC id, by serial number and by command UUID, so no
+		 * operation walks every outstanding command and the response thread, the janitor and the
+		 * REST handlers only contend when they touch the same shard.
+		 */
+		struct CommandShard {
+			std::mutex Mutex;
+			std::unordered_map<std::uint64_t, CommandInfo> Requests;
+			std::unordered_map<std::uint64_t, std::set<std::uint64_t>> BySerialNumber;
+			std::unordered_map<std::string, std::uint64_t> ByUUID;
+		};
+		using RequestIterator = std::unordered_map<std::uint64_t, CommandInfo>::iterator;
+
 		std::atomic_bool Running_ = false;
 		Poco::Thread ManagerThread;
 		std::atomic_uint64_t Id_ = 3; //	do not start @1. We ignore ID=1 & 0 is illegal..
-		std::map<std::uint64_t, CommandInfo> OutStandingRequests_;
+		std::array<CommandShard, 256> Shards_;
 		Poco::Timer JanitorTimer_;
 		std::unique_ptr<Poco::TimerCallback<CommandManager>> JanitorCallback_;
 		Poco::Timer CommandRunnerTimer_;
@@ -180,12 +226,69 @@ namespace OpenWifi {
 		std::uint64_t janitorInterval_ = 0;
 		std::uint64_t queueInterval_ = 0;
 
+		/*
+		 * 	Commands waiting in the database are mirrored here, per device and in submission order.
+		 * The scheduler thread only looks at devices that are on the ready list: a device gets there
+		 * when it connects, when it finishes a command, when a command is queued for it, or when a
+		 * command that had to wait (RunAt, retry delay) is due. The database is read once at
+		 * startup, then only to fetch the command that is about to run.
+		 */
+		struct QueuedCommand {
+			std::string UUID;
+			std::uint64_t Submitted = 0;
+			std::uint64_t RunAt = 0;
+			std::uint64_t LastTry = 0;
+		};
+		struct DeviceQueue {
+			std::map<std::pair<std::uint64_t, std::string>, QueuedCommand> Commands;
+			std::uint64_t WakeUp = 0;
+		};
+		std::mutex SchedulerMutex_;
+		std::condition_variable SchedulerSignal_;
+		std::unordered_map<std::uint64_t, DeviceQueue> Queued_;
+		std::multimap<std::uint64_t, std::uint64_t> WakeUps_;
+		std::set<std::uint64_t> ReadyDevices_;
+		Poco::Thread SchedulerThread_;
+		Poco::RunnableAdapter<CommandManager> SchedulerRunner_{*this,
+															   &CommandManager::RunScheduler};
+
+		void RunScheduler();
+		void RunDeviceQueue(std::uint64_t SerialNumber, Poco::Logger &MyLogger);
+		void Dequeue(std::uint64_t SerialNumber, const QueuedCommand &Command);
+		//	SchedulerMutex_ must be held.
+		void QueueCommand(const GWObjects::CommandDetails &Command);
+		void ScheduleWakeUp(std::uint64_t SerialNumber, std::uint64_t When);
+		bool NextDueCommand(std::uint64_t SerialNumber, QueuedCommand &Command);
+
 		std::shared_ptr<promise_type_t>
 		PostCommand(uint64_t RPCID, APCommands::Commands Command, const std::string &SerialNumber,
 					const std::string &Method, const Poco::JSON::Object &Params,
 					const std::string &UUID, bool oneway_rpc, bool disk_only, bool &Sent,
 					bool rpc_call, bool Deferred = false);
 
+		inline CommandShard &ShardFor(std::uint64_t SerialNumber) {
+			return Shards_[Utils::CalculateMacAddressHash(SerialNumber)];
+		}
+
+		//	Shard mutex must be held.
+		static inline void EraseRequest(CommandShard &Shard, RequestIterator Request) {
+			const auto &Command = Request->second;
+			auto Ids = Shard.BySerialNumber.find(Command.SerialNumber);
+			if (Ids != Shard.BySerialNumber.end()) {
+				Ids->second.erase(Command.Id);
+				if (Ids->second.empty())
+					Shard.BySerialNumber.erase(Ids);
+			}
+			auto Id = Shard.ByUUID.find(Command.UUID);
+			if (Id != Shard.ByUUID.end() && Id->second == Command.Id)
+				Shard.ByUUID.erase(Id);
+			Shard.Requests.erase(Request);
+		}
+
+		void AddRequest(const CommandInfo &Command);
+		bool GetRequest(std::uint64_t SerialNumber, std::uint64_t Id, CommandInfo &Command);
+		void FinalizeCommand(const CommandInfo &Command);
+
 		bool CompleteScriptCommand(CommandInfo &Command, const Poco::JSON::Object::Ptr &Payload,
 								   std::chrono::duration<double, std::milli> rpc_execution_time);
 		bool CompleteTelemetryCommand(CommandInfo &Command, const Poco::JSON::Object::Ptr &Payload,
@@ -12,12 +12,14 @@
 #include "Poco/Util/Option.h"
 
 #include <framework/ConfigurationValidator.h>
+#include <framework/KafkaManager.h>
 #include <framework/UI_WebSocketClientServer.h>
 #include <framework/default_device_types.h>
 
 #include "AP_WS_Server.h"
 #include "CommandManager.h"
 #include "Daemon.h"
+#include "Dashboard.h"
 #include "FileUploader.h"
 #include "FindCountry.h"
 #include "OUIServer.h"
@@ -29,6 +31,7 @@
 #include "SignatureMgr.h"
 #include "StorageArchiver.h"
 #include "StorageService.h"
+#include "StorageWriteBehind.h"
 #include "TelemetryStream.h"
 #include "GenericScheduler.h"
 #include "UI_GW_WebSocketNotifications.h"
@@ -42,8 +45,8 @@ namespace OpenWifi {
 		static Daemon instance(
 			vDAEMON_PROPERTIES_FILENAME, vDAEMON_ROOT_ENV_VAR, vDAEMON_CONFIG_ENV_VAR,
 			vDAEMON_APP_NAME, vDAEMON_BUS_TIMER,
-			SubSystemVec{GenericScheduler(), StorageService(), SerialNumberCache(), ConfigurationValidator(),
-				UI_WebSocketClientServer(), OUIServer(), FindCountryFromIP(),
+			SubSystemVec{GenericScheduler(), StorageService(), StorageWriteBehind(), SerialNumberCache(), ConfigurationValidator(),
+				UI_WebSocketClientServer(), OUIServer(), DeviceDashboard(), FindCountryFromIP(),
 				CommandManager(), FileUploader(), StorageArchiver(), TelemetryStream(),
 				RTTYS_server(), RADIUS_proxy_server(), VenueBroadcaster(), ScriptManager(),
 				SignatureManager(), AP_WS_Server(),
@@ -73,6 +76,39 @@ namespace OpenWifi {
 		MicroServiceALBCallback(ALBHealthCallback);
 	}
 
+	void Daemon::GetExtraResources(Poco::JSON::Object &Answer) {
+		Poco::JSON::Array Reactors;
+		AP_WS_Server()->GetReactorStatistics(Reactors);
+		Answer.set("deviceReactors", Reactors);
+
+		std::uint64_t QueuedFrames = 0, QueuedBytes = 0, DroppedFrames = 0;
+		AP_WS_Server()->GetSendQueueStatistics(QueuedFrames, QueuedBytes, DroppedFrames);
+		Poco::JSON::Object SendQueues;
+		SendQueues.set("queuedFrames", QueuedFrames);
+		SendQueues.set("queuedBytes", QueuedBytes);
+		SendQueues.set("droppedFrames", DroppedFrames);
+		Answer.set("deviceSendQueues", SendQueues);
+
+		std::uint64_t Queued = 0, Written = 0, Dropped = 0, Failed = 0;
+		StorageWriteBehind()->GetCounters(Queued, Written, Dropped, Failed);
+		Poco::JSON::Object WriteBehind;
+		WriteBehind.set("queuedRows", Queued);
+		WriteBehind.set("writtenRows", Written);
+		WriteBehind.set("droppedRows", Dropped);
+		WriteBehind.set("failedRows", Failed);
+		Answer.set("storageWriteBehind", WriteBehind);
+
+		if (KafkaManager()->Enabled()) {
+			std::uint64_t Produced = 0;
+			KafkaManager()->GetProducerCounters(Queued, Produced, Dropped);
+			Poco::JSON::Object Producer;
+			Producer.set("queuedMessages", Queued);
+			Producer.set("producedMessages", Produced);
+			Producer.set("droppedMessages", Dropped);
+			Answer.set("kafkaProducer", Producer);
+		}
+	}
+
 	[[nodiscard]] std::string Daemon::IdentifyDevice(const std::string &Id) const {
 		for (const auto &[DeviceType, Type] : DeviceTypes_) {
 			if (Id == DeviceType)
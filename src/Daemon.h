@@ -17,7 +17,6 @@
 #include "framework/MicroService.h"
 #include "framework/MicroServiceNames.h"
 
-#include "Dashboard.h"
 #include "GwWebSocketClient.h"
 #include "framework/OpenWifiTypes.h"
 
@@ -39,14 +38,13 @@ namespace OpenWifi {
 		bool AutoProvisioning() const { return AutoProvisioning_; }
 		[[nodiscard]] std::string IdentifyDevice(const std::string &Compatible) const;
 		static Daemon *instance();
-		inline DeviceDashboard &GetDashboard() { return DB_; }
 		Poco::Logger &Log() { return Poco::Logger::get(AppName()); }
 		void PostInitialization(Poco::Util::Application &self);
+		void GetExtraResources(Poco::JSON::Object &Answer) final;
 
 	  private:
 		bool AutoProvisioning_ = false;
 		std::vector<std::pair<std::string, std::string>> DeviceTypes_;
-		DeviceDashboard DB_;
 		std::unique_ptr<GwWebSocketClient> WebSocketProcessor_;
 	};
 
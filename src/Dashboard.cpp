@@ -3,48 +3,292 @@
 //
 
 #include "Dashboard.h"
+#include "OUIServer.h"
 #include "StorageService.h"
 #include "framework/utils.h"
 
+#include "fmt/format.h"
+
 namespace OpenWifi {
 
-	bool DeviceDashboard::Get(GWObjects::Dashboard &D, Poco::Logger &Logger) {
-		uint64_t Now = Utils::Now();
-		if (!ValidDashboard_ || LastRun_ == 0 || (Now - LastRun_) > 120) {
-			Generate(D, Logger);
-		} else {
-			std::lock_guard G(DataMutex_);
-			D = DB_;
-		}
-		return ValidDashboard_;
-	};
-
-	void DeviceDashboard::Generate(GWObjects::Dashboard &D, Poco::Logger &Logger) {
-		if (GeneratingDashboard_.load()) {
-			// std::cout << "Trying to generate dashboard but already being generated" << std::endl;
-			while (GeneratingDashboard_.load()) {
-				Poco::Thread::trySleep(100);
-			}
-			std::lock_guard G(DataMutex_);
-			D = DB_;
-		} else {
-			GeneratingDashboard_ = true;
-			ValidDashboard_ = false;
-			try {
-				// std::cout << "Generating dashboard." << std::endl;
-				poco_information(Logger, "DASHBOARD: Generating a new dashboard.");
-				GWObjects::Dashboard NewData;
-				StorageService()->AnalyzeCommands(NewData.commands);
-				StorageService()->AnalyzeDevices(NewData);
-				LastRun_ = Utils::Now();
-				NewData.snapshot = LastRun_;
-				D = NewData;
-				std::lock_guard G(DataMutex_);
-				DB_ = NewData;
-				ValidDashboard_ = true;
-			} catch (...) {
+	static std::string ComputeCertificateTag(GWObjects::CertificateValidation V) {
+		switch (V) {
+		case GWObjects::NO_CERTIFICATE:
+			return "no certificate";
+		case GWObjects::VALID_CERTIFICATE:
+			return "non TIP certificate";
+		case GWObjects::MISMATCH_SERIAL:
+			return "serial mismatch";
+		case GWObjects::VERIFIED:
+			return "verified";
+		case GWObjects::SIMULATED:
+			return "simulated";
+		}
+		return "unknown";
+	}
+
+	static const uint64_t SECONDS_MONTH = 30 * 24 * 60 * 60;
+	static const uint64_t SECONDS_WEEK = 7 * 24 * 60 * 60;
+	static const uint64_t SECONDS_DAY = 1 * 24 * 60 * 60;
+	static const uint64_t SECONDS_HOUR = 60 * 60;
+
+	static std::string ComputeSanityTag(uint64_t T) {
+		if (T == 100)
+			return "100%";
+		if (T > 90)
+			return ">90%";
+		if (T > 60)
+			return ">60%";
+		return "<60%";
+	}
+
+	static std::string ComputeUpTimeTag(uint64_t T) {
+		if (T > SECONDS_MONTH)
+			return ">month";
+		if (T > SECONDS_WEEK)
+			return ">week";
+		if (T > SECONDS_DAY)
+			return ">day";
+		if (T > SECONDS_HOUR)
+			return ">hour";
+		return "now";
+	}
+
+	static std::string ComputeLoadTag(uint64_t T) {
+		auto V = 100.0 * ((float)T / 65536.0);
+		if (V < 5.0)
+			return "< 5%";
+		if (V < 25.0)
+			return "< 25%";
+		if (V < 50.0)
+			return "< 50%";
+		if (V < 75.0)
+			return "< 75%";
+		return ">75%";
+	}
+
+	static std::string ComputeUsedMemoryTag(uint64_t Free, uint64_t Total) {
+		if (Total == 0)
+			return "< 5%";
+		auto V = 100.0 * ((float)(Total - Free) / (float(Total)));
+		if (V < 5.0)
+			return "< 5%";
+		if (V < 25.0)
+			return "< 25%";
+		if (V < 50.0)
+			return "< 50%";
+		if (V < 75.0)
+			return "< 75%";
+		return ">75%";
+	}
+
+	static void AdjustCountedMap(Types::CountedMap &M, const std::string &S, bool Add,
+								 uint64_t Count = 1) {
+		if (Count == 0)
+			return;
+		if (Add) {
+			UpdateCountedMap(M, S, Count);
+			return;
+		}
+		auto it = M.find(S);
+		if (it == M.end())
+			return;
+		if (it->second <= Count)
+			M.erase(it);
+		else
+			it->second -= Count;
+	}
+
+	int DeviceDashboard::Start() {
+		poco_information(Logger(), "Starting...");
+		std::vector<std::pair<std::string, std::string>> Inventory;
+		StorageService()->GetDeviceInventory(Inventory);
+
+		std::lock_guard G(Mutex_);
+		Devices_.clear();
+		Totals_.reset();
+		Devices_.reserve(Inventory.size());
+		for (const auto &[SerialNumber, DeviceType] : Inventory) {
+			auto &E = Devices_[Utils::SerialNumberToInt(SerialNumber)];
+			E.Known = true;
+			E.Vendor = OUIServer()->GetManufacturer(SerialNumber);
+			E.DeviceType = DeviceType;
+			Apply(E, true);
+		}
+		CommandsDirty_ = true;
+		poco_information(Logger(), fmt::format("Loaded {} devices.", Inventory.size()));
+		return 0;
+	}
+
+	void DeviceDashboard::Stop() {
+		poco_information(Logger(), "Stopping...");
+		poco_information(Logger(), "Stopped...");
+	}
+
+	bool DeviceDashboard::Get(GWObjects::Dashboard &D) {
+		if (CommandsDirty_)
+			RefreshCommands();
+		std::lock_guard G(Mutex_);
+		D = Totals_;
+		D.snapshot = Utils::Now();
+		return true;
+	}
+
+	//	Only one caller re-counts; the others return the counts they already have. The scan runs
+	//	without the dashboard lock, so commands added or removed meanwhile may or may not be in it:
+	//	the new counts are still swapped in, but another scan is requested.
+	void DeviceDashboard::RefreshCommands() {
+		std::unique_lock Lock(CommandsRefreshMutex_, std::try_to_lock);
+		if (!Lock.owns_lock())
+			return;
+		CommandsDirty_ = false;
+		std::uint64_t Generation;
+		{
+			std::lock_guard G(Mutex_);
+			Generation = CommandsGeneration_;
+		}
+		Types::CountedMap Commands;
+		if (!StorageService()->AnalyzeCommands(Commands)) {
+			CommandsDirty_ = true;
+			return;
+		}
+		std::lock_guard G(Mutex_);
+		Totals_.commands.swap(Commands);
+		if (Generation != CommandsGeneration_)
+			CommandsDirty_ = true;
+	}
+
+	void DeviceDashboard::Apply(const DeviceEntry &E, bool Add) {
+		if (!E.Known)
+			return;
+
+		if (Add)
+			Totals_.numberOfDevices++;
+		else
+			Totals_.numberOfDevices--;
+		AdjustCountedMap(Totals_.vendors, E.Vendor, Add);
+		AdjustCountedMap(Totals_.deviceType, E.DeviceType, Add);
+
+		if (E.SessionId == 0) {
+			AdjustCountedMap(Totals_.status, "not connected", Add);
+			return;
+		}
+
+		AdjustCountedMap(Totals_.status, "connected", Add);
+		AdjustCountedMap(Totals_.certificates, E.Certificate, Add);
+		//	A connected device has been heard from within the session timeout.
+		AdjustCountedMap(Totals_.lastContact, "now", Add);
+		AdjustCountedMap(Totals_.healths, E.Health.empty() ? ComputeSanityTag(100) : E.Health, Add);
+		if (E.HasStats) {
+			if (!E.UpTime.empty())
+				AdjustCountedMap(Totals_.upTimes, E.UpTime, Add);
+			if (!E.Memory.empty())
+				AdjustCountedMap(Totals_.memoryUsed, E.Memory, Add);
+			if (!E.Load1.empty()) {
+				AdjustCountedMap(Totals_.load1, E.Load1, Add);
+				AdjustCountedMap(Totals_.load5, E.Load5, Add);
+				AdjustCountedMap(Totals_.load15, E.Load15, Add);
 			}
-			GeneratingDashboard_ = false;
+			AdjustCountedMap(Totals_.associations, "2G", Add, E.Associations_2G);
+			AdjustCountedMap(Totals_.associations, "5G", Add, E.Associations_5G);
+			AdjustCountedMap(Totals_.associations, "6G", Add, E.Associations_6G);
 		}
 	}
+
+	template <typename F> void DeviceDashboard::Update(std::uint64_t SerialNumber, F Modify) {
+		std::lock_guard G(Mutex_);
+		auto &E = Devices_[SerialNumber];
+		Apply(E, false);
+		Modify(E);
+		Apply(E, true);
+		if (!E.Known && E.SessionId == 0)
+			Devices_.erase(SerialNumber);
+	}
+
+	void DeviceDashboard::DeviceAdded(const std::string &SerialNumber,
+									  const std::string &DeviceType) {
+		auto Vendor = OUIServer()->GetManufacturer(SerialNumber);
+		Update(Utils::SerialNumberToInt(SerialNumber), [&](DeviceEntry &E) {
+			E.Known = true;
+			E.Vendor = Vendor;
+			E.DeviceType = DeviceType;
+		});
+	}
+
+	void DeviceDashboard::DeviceDeleted(const std::string &SerialNumber) {
+		Update(Utils::SerialNumberToInt(SerialNumber), [](DeviceEntry &E) { E.Known = false; });
+	}
+
+	void DeviceDashboard::DeviceConnected(std::uint64_t SerialNumber, std::uint64_t SessionId,
+										  GWObjects::CertificateValidation Certificate) {
+		auto Tag = ComputeCertificateTag(Certificate);
+		Update(SerialNumber, [&](DeviceEntry &E) {
+			E.SessionId = SessionId;
+			E.Certificate = Tag;
+			E.Health.clear();
+			E.HasStats = false;
+		});
+	}
+
+	//	A device that reconnected has a newer session: the old session ending must not count.
+	void DeviceDashboard::DeviceDisconnected(std::uint64_t SerialNumber, std::uint64_t SessionId) {
+		Update(SerialNumber, [&](DeviceEntry &E) {
+			if (E.SessionId == SessionId)
+				E.SessionId = 0;
+		});
+	}
+
+	void DeviceDashboard::DeviceStatistics(std::uint64_t SerialNumber,
+										   const StateUtils::UnitStatistics &Unit,
+										   std::uint64_t Associations_2G,
+										   std::uint64_t Associations_5G,
+										   std::uint64_t Associations_6G) {
+		DeviceEntry Tags;
+		if (Unit.hasUptime)
+			Tags.UpTime = ComputeUpTimeTag(Unit.uptime);
+		if (Unit.hasMemory)
+			Tags.Memory = ComputeUsedMemoryTag(Unit.memoryFree, Unit.memoryTotal);
+		if (Unit.hasLoad) {
+			Tags.Load1 = ComputeLoadTag(Unit.load[0]);
+			Tags.Load5 = ComputeLoadTag(Unit.load[1]);
+			Tags.Load15 = ComputeLoadTag(Unit.load[2]);
+		}
+
+		Update(SerialNumber, [&](DeviceEntry &E) {
+			if (E.SessionId == 0)
+				return;
+			E.HasStats = true;
+			E.UpTime = Tags.UpTime;
+			E.Memory = Tags.Memory;
+			E.Load1 = Tags.Load1;
+			E.Load5 = Tags.Load5;
+			E.Load15 = Tags.Load15;
+			E.Associations_2G = Associations_2G;
+			E.Associations_5G = Associations_5G;
+			E.Associations_6G = Associations_6G;
+		});
+	}
+
+	void DeviceDashboard::DeviceHealthCheck(std::uint64_t SerialNumber, std::uint64_t Sanity) {
+		auto Tag = ComputeSanityTag(Sanity);
+		Update(SerialNumber, [&](DeviceEntry &E) {
+			if (E.SessionId != 0)
+				E.Health = Tag;
+		});
+	}
+
+	void DeviceDashboard::CommandAdded(const std::string &Command) {
+		if (Command.empty())
+			return;
+		std::lock_guard G(Mutex_);
+		UpdateCountedMap(Totals_.commands, Command);
+		CommandsGeneration_++;
+	}
+
+	void DeviceDashboard::CommandsRemoved(const std::string &Command, std::uint64_t Count) {
+		std::lock_guard G(Mutex_);
+		AdjustCountedMap(Totals_.commands, Command, false, Count);
+		CommandsGeneration_++;
+	}
+
 } // namespace OpenWifi
@@ -4,24 +4,79 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 
-#include "Poco/Logger.h"
 #include "RESTObjects//RESTAPI_GWobjects.h"
+#include "StateUtils.h"
 #include "framework/OpenWifiTypes.h"
+#include "framework/SubSystemServer.h"
 
 namespace OpenWifi {
-	class DeviceDashboard {
+
+	/*
+	 * 	Dashboard counters are kept live: every device keeps the set of tags it contributes, and
+	 * an event only removes the old tags and adds the new ones. Reading the dashboard is a copy.
+	 * The device inventory is loaded once at startup. Command counts are adjusted on insert and
+	 * re-counted by the database after bulk deletes.
+	 */
+	class DeviceDashboard : public SubSystemServer {
 	  public:
-		bool Get(GWObjects::Dashboard &D, Poco::Logger &Logger);
+		static auto instance() {
+			static auto instance_ = new DeviceDashboard;
+			return instance_;
+		}
+
+		int Start() override;
+		void Stop() override;
+
+		bool Get(GWObjects::Dashboard &D);
+
+		void DeviceAdded(const std::string &SerialNumber, const std::string &DeviceType);
+		void DeviceDeleted(const std::string &SerialNumber);
+		void DeviceConnected(std::uint64_t SerialNumber, std::uint64_t SessionId,
+							 GWObjects::CertificateValidation Certificate);
+		void DeviceDisconnected(std::uint64_t SerialNumber, std::uint64_t SessionId);
+		void DeviceStatistics(std::uint64_t SerialNumber, const StateUtils::UnitStatistics &Unit,
+							  std::uint64_t Associations_2G, std::uint64_t Associations_5G,
+							  std::uint64_t Associations_6G);
+		void DeviceHealthCheck(std::uint64_t SerialNumber, std::uint64_t Sanity);
+
+		void CommandAdded(const std::string &Command);
+		void CommandsRemoved(const std::string &Command, std::uint64_t Count);
+		inline void CommandsChanged() { CommandsDirty_ = true; }
 
 	  private:
-		std::mutex DataMutex_;
-		volatile std::atomic_bool GeneratingDashboard_ = false;
-		volatile bool ValidDashboard_ = false;
-		GWObjects::Dashboard DB_;
-		uint64_t LastRun_ = 0;
+		struct DeviceEntry {
+			bool Known = false;
+			std::string Vendor;
+			std::string DeviceType;
+			std::uint64_t SessionId = 0;
+			std::string Certificate;
+			std::string Health;
+			bool HasStats = false;
+			std::string UpTime;
+			std::string Memory;
+			std::string Load1, Load5, Load15;
+			std::uint64_t Associations_2G = 0, Associations_5G = 0, Associations_6G = 0;
+		};
 
-		void Generate(GWObjects::Dashboard &D, Poco::Logger &Logger);
+		std::mutex Mutex_;
+		std::unordered_map<std::uint64_t, DeviceEntry> Devices_;
+		GWObjects::Dashboard Totals_;
+
+		std::mutex CommandsRefreshMutex_;
+		std::atomic_bool CommandsDirty_ = true;
+		std::uint64_t CommandsGeneration_ = 0;
+
+		void Apply(const DeviceEntry &E, bool Add);
+		template <typename F> void Update(std::uint64_t SerialNumber, F Modify);
+		void RefreshCommands();
+
+		DeviceDashboard() noexcept : SubSystemServer("DeviceDashboard", "DASHBOARD", "dashboard") {}
 	};
+
+	inline auto DeviceDashboard() { return DeviceDashboard::instance(); }
+
 } // namespace OpenWifi
@@ -6,6 +6,7 @@
 //	Arilia Wireless Inc.
 //
 
+#include <fstream>
 #include <iostream>
 
 #include "Poco/CountingStream.h"
@@ -17,8 +18,12 @@
 #include "Poco/Net/MessageHeader.h"
 #include "Poco/Net/MultipartReader.h"
 #include "Poco/Net/PartHandler.h"
+#include "Poco/NullStream.h"
+#include "Poco/Path.h"
+#include "Poco/SHA2Engine.h"
 #include "Poco/StreamCopier.h"
 #include "Poco/StringTokenizer.h"
+#include "Poco/TemporaryFile.h"
 
 #include "framework/MicroServiceFuncs.h"
 #include "framework/ow_constants.h"
@@ -152,6 +157,77 @@ namespace OpenWifi {
 			OutStandingUploads_.end());
 	}
 
+	/*
+	 * 	The upload is copied in chunks to a temporary file next to the store while its hash is
+	 * computed, then renamed to its final name. Identical uploads share the same file.
+	 */
+	bool FileUploader::StoreFile(std::istream &Stream, std::string &FileName, std::uint64_t &Size,
+								 std::unique_lock<std::mutex> &Guard, std::string &Error) {
+		try {
+			Poco::File Incoming(Path_ + "/incoming");
+			Incoming.createDirectories();
+			Poco::TemporaryFile TempFile(Incoming.path());
+			Poco::SHA2Engine Hash;
+			Size = 0;
+
+			{
+				std::ofstream OutputStream(TempFile.path(), std::ios::binary | std::ios::trunc);
+				char Chunk[64 << 10];
+				while (Stream) {
+					Stream.read(Chunk, sizeof(Chunk));
+					auto Read = Stream.gcount();
+					if (Read <= 0)
+						break;
+					Size += Read;
+					if (Size >= MaxSize_) {
+						poco_warning(Logger(), fmt::format("Upload larger than {} bytes rejected.", MaxSize_));
+						Error = "Attached file is too large";
+						return false;
+					}
+					Hash.update(Chunk, Read);
+					OutputStream.write(Chunk, Read);
+				}
+				OutputStream.close();
+				if (!OutputStream) {
+					poco_warning(Logger(), fmt::format("Could not write upload to {}.", TempFile.path()));
+					Error = "Attached file could not be written to disk";
+					return false;
+				}
+			}
+
+			auto Digest = Poco::SHA2Engine::digestToHex(Hash.digest());
+			FileName = Digest.substr(0, 2) + "/" + Digest;
+			auto FinalPath = FilePath(FileName);
+			Poco::File(Poco::Path(FinalPath).parent()).createDirectories();
+			Guard = std::unique_lock(FileMutex(FileName));
+			if (!Poco::File(FinalPath).exists()) {
+				TempFile.renameTo(FinalPath);
+				TempFile.keep();
+			}
+			return true;
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+			Error = "Attached file could not be stored";
+		}
+		if (Guard.owns_lock())
+			Guard.unlock();
+		return false;
+	}
+
+	std::string FileUploader::FilePath(const std::string &FileName) const {
+		return Path_ + "/" + FileName;
+	}
+
+	void FileUploader::RemoveFile(const std::string &FileName) {
+		try {
+			Poco::File F(FilePath(FileName));
+			if (F.exists())
+				F.remove();
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+	}
+
 	class FileUploaderPartHandler2 : public Poco::Net::PartHandler {
 	  public:
 		FileUploaderPartHandler2(std::string Id, Poco::Logger &Logger, std::stringstream &ofs)
@@ -199,6 +275,7 @@ namespace OpenWifi {
 
 			poco_debug(Logger(), fmt::format("{}: Preparing to upload a file.", UUID_));
 			Poco::JSON::Object Answer;
+			std::string ErrorText{"No file attached"};
 
 			try {
 				if (Poco::icompare(Tokens[0], "multipart/form-data") == 0 ||
@@ -218,18 +295,28 @@ namespace OpenWifi {
 
 							const auto PartContentType = Hdr.get("Content-Type", "");
 							if (PartContentType == "application/octet-stream") {
-								std::stringstream FileContent;
-								Poco::StreamCopier::copyStream(Reader.stream(), FileContent);
+								std::string FileName;
+								std::uint64_t Size = 0;
+								std::unique_lock<std::mutex> Guard;
+								if (!FileUploader()->StoreFile(Reader.stream(), FileName, Size,
+															   Guard, ErrorText))
+									break;
+								if (!StorageService()->AttachFileDataToCommand(UUID_, FileName,
+																			   Size, Type_)) {
+									Guard.unlock();
+									StorageService()->ReleaseStoredFile(FileName);
+									ErrorText = "Attached file could not be recorded";
+									break;
+								}
+								Guard.unlock();
 								Answer.set("filename", UUID_);
 								Answer.set("error", 0);
 								poco_debug(Logger(), fmt::format("{}: File uploaded.", UUID_));
-								StorageService()->AttachFileDataToCommand(UUID_, FileContent,
-																		  Type_);
 								std::ostream &ResponseStream = Response.send();
 								Poco::JSON::Stringifier::stringify(Answer, ResponseStream);
 								return;
 							} else {
-								std::stringstream OO;
+								Poco::NullOutputStream OO;
 								Poco::StreamCopier::copyStream(Reader.stream(), OO);
 							}
 
@@ -240,8 +327,10 @@ namespace OpenWifi {
 				}
 			} catch (const Poco::Exception &E) {
 				Logger().log(E);
+				ErrorText = "Attached file could not be received";
 			} catch (...) {
 				poco_debug(Logger(), "Exception while receiving uploaded file.");
+				ErrorText = "Attached file could not be received";
 			}
 
 			poco_debug(Logger(), fmt::format("{}: Failed to upload a file.", UUID_));
@@ -249,7 +338,7 @@ namespace OpenWifi {
 			StorageService()->CancelWaitFile(UUID_, Error);
 			Answer.set("filename", UUID_);
 			Answer.set("error", 13);
-			Answer.set("errorText", "Attached file is too large");
+			Answer.set("errorText", ErrorText);
 			StorageService()->CancelWaitFile(UUID_, Error);
 			std::ostream &ResponseStream = Response.send();
 			Poco::JSON::Stringifier::stringify(Answer, ResponseStream);
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <array>
+#include <mutex>
+
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
 #include "Poco/Net/HTTPServer.h"
@@ -35,6 +38,18 @@ namespace OpenWifi {
 		void RemoveRequest(const std::string &UUID);
 		const std::string &Path() { return Path_; };
 
+		//	Uploaded files live on disk under Path(), named by the SHA-256 of their content. On
+		//	success Guard holds the file's lock, so the caller can record the file before anyone
+		//	else may decide it is unused and remove it. On failure, Error says what went wrong.
+		bool StoreFile(std::istream &Stream, std::string &FileName, std::uint64_t &Size,
+					   std::unique_lock<std::mutex> &Guard, std::string &Error);
+		[[nodiscard]] std::string FilePath(const std::string &FileName) const;
+		void RemoveFile(const std::string &FileName);
+		//	Held while a stored file is added or while its last reference is checked and removed.
+		inline std::mutex &FileMutex(const std::string &FileName) {
+			return FileMutexes_[std::hash<std::string>{}(FileName) % FileMutexes_.size()];
+		}
+
 		static auto instance() {
 			static auto instance_ = new FileUploader;
 			return instance_;
@@ -50,6 +65,7 @@ namespace OpenWifi {
 		std::list<UploadId> OutStandingUploads_;
 		std::string Path_;
 		uint64_t MaxSize_ = 10000000;
+		std::array<std::mutex, 64> FileMutexes_;
 
 		explicit FileUploader() noexcept
 			: SubSystemServer("FileUploader", "FILE-UPLOAD", "openwifi.fileuploader") {}
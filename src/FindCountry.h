@@ -4,10 +4,27 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "Poco/ExpireLRUCache.h"
 #include "Poco/Net/IPAddress.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Runnable.h"
+#include "Poco/String.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/Thread.h"
 
 #include "framework/MicroServiceFuncs.h"
 #include "framework/SubSystemServer.h"
+#include "framework/utils.h"
 
 #include "nlohmann/json.hpp"
 
@@ -18,6 +35,9 @@ namespace OpenWifi {
 		virtual bool Init() = 0;
 		virtual Poco::URI URI(const std::string &IPAddress) = 0;
 		virtual std::string Country(const std::string &Response) = 0;
+		//	Local providers answer from memory and never need an HTTP round trip.
+		virtual bool Local() const { return false; }
+		virtual std::string Find([[maybe_unused]] const Poco::Net::IPAddress &IP) { return ""; }
 		virtual ~IPToCountryProvider(){};
 	};
 
@@ -113,6 +133,132 @@ namespace OpenWifi {
 		std::string Key_;
 	};
 
+	/*
+	 * 	Country lookups from a local CSV file. Each line is either "network/prefix,country" (a
+	 * MaxMind style network list joined with its country codes) or "first,last,country" (DB-IP or
+	 * IP2Location lite style). Both IPv4 and IPv6 are accepted. Lines that do not parse, like
+	 * headers or comments, are skipped. Ranges are kept sorted and searched with a binary search.
+	 */
+	class IPFile : public IPToCountryProvider {
+	  public:
+		static std::string Name() { return "file"; }
+		inline bool Init() override {
+			auto FileName = MicroServiceConfigPath("iptocountry.file.path", "");
+			if (FileName.empty())
+				return false;
+			std::ifstream IF(FileName);
+			if (!IF)
+				return false;
+
+			std::vector<Range> Ranges;
+			std::string Line;
+			while (std::getline(IF, Line)) {
+				Range R;
+				if (ParseLine(Line, R))
+					Ranges.emplace_back(std::move(R));
+			}
+			std::sort(Ranges.begin(), Ranges.end(),
+					  [](const Range &A, const Range &B) { return A.First < B.First; });
+			Ranges_.swap(Ranges);
+			return !Ranges_.empty();
+		}
+
+		[[nodiscard]] inline Poco::URI URI([[maybe_unused]] const std::string &IPAddress) override {
+			return Poco::URI{};
+		}
+
+		inline std::string Country([[maybe_unused]] const std::string &Response) override {
+			return "";
+		}
+
+		[[nodiscard]] inline bool Local() const override { return true; }
+
+		inline std::string Find(const Poco::Net::IPAddress &IP) override {
+			auto Key = ToKey(IP);
+			auto It = std::upper_bound(
+				Ranges_.begin(), Ranges_.end(), Key,
+				[](const AddressKey &K, const Range &R) { return K < R.First; });
+			if (It == Ranges_.begin())
+				return "";
+			--It;
+			return Key <= It->Last ? It->Country : "";
+		}
+
+		[[nodiscard]] inline auto Size() const { return Ranges_.size(); }
+
+	  private:
+		//	IPv4 addresses are stored as IPv4-mapped IPv6 so both families share one table.
+		using AddressKey = std::array<std::uint8_t, 16>;
+		struct Range {
+			AddressKey First{};
+			AddressKey Last{};
+			std::string Country;
+		};
+		std::vector<Range> Ranges_;
+
+		static inline AddressKey ToKey(const Poco::Net::IPAddress &IP) {
+			AddressKey Key{};
+			if (IP.family() == Poco::Net::IPAddress::IPv4) {
+				Key[10] = Key[11] = 0xff;
+				std::memcpy(&Key[12], IP.addr(), 4);
+			} else {
+				std::memcpy(&Key[0], IP.addr(), 16);
+			}
+			return Key;
+		}
+
+		static inline std::string Unquote(const std::string &F) {
+			if (F.size() >= 2 && F.front() == '"' && F.back() == '"')
+				return F.substr(1, F.size() - 2);
+			return F;
+		}
+
+		static inline bool ParseLine(const std::string &Line, Range &R) {
+			if (Line.empty() || Line[0] == '#')
+				return false;
+			Poco::StringTokenizer Fields(Line, ",", Poco::StringTokenizer::TOK_TRIM);
+			if (Fields.count() < 2)
+				return false;
+
+			Poco::Net::IPAddress First, Last;
+			std::string Country;
+			auto Network = Unquote(Fields[0]);
+			auto Slash = Network.find('/');
+			if (Slash != std::string::npos) {
+				unsigned Prefix = 0;
+				if (!Poco::Net::IPAddress::tryParse(Network.substr(0, Slash), First) ||
+					!Poco::NumberParser::tryParseUnsigned(Network.substr(Slash + 1), Prefix))
+					return false;
+				if (First.family() == Poco::Net::IPAddress::IPv4)
+					Prefix += 96;
+				if (Prefix > 128)
+					return false;
+				R.First = R.Last = ToKey(First);
+				for (unsigned Bit = Prefix; Bit < 128; ++Bit) {
+					std::uint8_t Mask = 0x80 >> (Bit % 8);
+					R.First[Bit / 8] &= ~Mask;
+					R.Last[Bit / 8] |= Mask;
+				}
+				Country = Unquote(Fields[1]);
+			} else {
+				if (Fields.count() < 3 ||
+					!Poco::Net::IPAddress::tryParse(Network, First) ||
+					!Poco::Net::IPAddress::tryParse(Unquote(Fields[1]), Last) ||
+					First.family() != Last.family())
+					return false;
+				R.First = ToKey(First);
+				R.Last = ToKey(Last);
+				if (R.Last < R.First)
+					return false;
+				Country = Unquote(Fields[2]);
+			}
+			if (Country.size() != 2)
+				return false;
+			R.Country = Poco::toUpper(Country);
+			return true;
+		}
+	};
+
 	template <typename BaseClass, typename T, typename... Args>
 	std::unique_ptr<BaseClass> IPLocationProvider(const std::string &RequestProvider) {
 		if (T::Name() == RequestProvider) {
@@ -125,7 +271,12 @@ namespace OpenWifi {
 		}
 	}
 
-	class FindCountryFromIP : public SubSystemServer {
+	/*
+	 * 	Answers are kept in an expiring LRU whatever the provider. The device connect path uses
+	 * Lookup(), which never blocks: a miss with a remote provider is handed to a refresher thread
+	 * and the caller gets the default country until the answer lands in the cache.
+	 */
+	class FindCountryFromIP : public SubSystemServer, Poco::Runnable {
 	  public:
 		static auto instance() {
 			static auto instance_ = new FindCountryFromIP;
@@ -134,21 +285,36 @@ namespace OpenWifi {
 
 		inline int Start() final {
 			poco_notice(Logger(), "Starting...");
+			Default_ = MicroServiceConfigGetString("iptocountry.default", "US");
+			Cache_ = std::make_unique<Poco::ExpireLRUCache<std::string, std::string>>(
+				MicroServiceConfigGetInt("iptocountry.cache.size", 32768),
+				MicroServiceConfigGetInt("iptocountry.cache.ttl", 24 * 60 * 60) * 1000);
+			MaxPending_ = MicroServiceConfigGetInt("iptocountry.refresh.maxpending", 4096);
 			ProviderName_ = MicroServiceConfigGetString("iptocountry.provider", "");
 			if (!ProviderName_.empty()) {
-				Provider_ = IPLocationProvider<IPToCountryProvider, IPInfo, IPData, IP2Location>(
-					ProviderName_);
+				Provider_ = IPLocationProvider<IPToCountryProvider, IPInfo, IPData, IP2Location,
+											   IPFile>(ProviderName_);
 				if (Provider_ != nullptr) {
 					Enabled_ = Provider_->Init();
 				}
 			}
-			Default_ = MicroServiceConfigGetString("iptocountry.default", "US");
+			if (Enabled_ && !Provider_->Local()) {
+				Running_ = true;
+				Worker_.start(*this);
+			}
 			return 0;
 		}
 
 		inline void Stop() final {
 			poco_notice(Logger(), "Stopping...");
-			//	Nothing to do - just to provide the same look at the others.
+			if (Running_) {
+				{
+					std::lock_guard G(QueueMutex_);
+					Running_ = false;
+				}
+				Signal_.notify_one();
+				Worker_.join();
+			}
 			poco_notice(Logger(), "Stopped...");
 		}
 
@@ -160,6 +326,29 @@ namespace OpenWifi {
 			return I;
 		}
 
+		//	Never blocks. Returns false when the answer is not known yet: Country is then set to the
+		//	default and a remote lookup has been queued.
+		inline bool Lookup(const Poco::Net::IPAddress &IP, std::string &Country) {
+			Country = Default_;
+			if (!Enabled_)
+				return true;
+			auto Address = ReformatAddress(IP.toString());
+			if (auto Hit = Cache_->get(Address); !Hit.isNull()) {
+				if (!Hit->empty())
+					Country = *Hit;
+				return true;
+			}
+			if (Provider_->Local()) {
+				auto Answer = Provider_->Find(IP);
+				Cache_->add(Address, Answer);
+				if (!Answer.empty())
+					Country = Answer;
+				return true;
+			}
+			QueueRefresh(Address);
+			return false;
+		}
+
 		inline std::string Get(const Poco::Net::IPAddress &IP) {
 			if (!Enabled_)
 				return Default_;
@@ -169,17 +358,44 @@ namespace OpenWifi {
 		inline std::string Get(const std::string &IP) {
 			if (!Enabled_)
 				return Default_;
-			try {
-				std::string URL = Provider_->URI(IP).toString();
-				std::string Response;
-				if (Utils::wgets(URL, Response)) {
-					auto Answer = Provider_->Country(Response);
+			if (auto Hit = Cache_->get(IP); !Hit.isNull()) {
+				return Hit->empty() ? Default_ : *Hit;
+			}
+			std::string Answer;
+			if (Provider_->Local()) {
+				Poco::Net::IPAddress Address;
+				if (!Poco::Net::IPAddress::tryParse(IP, Address))
+					return Default_;
+				Answer = Provider_->Find(Address);
+				Cache_->add(IP, Answer);
+			} else {
+				Answer = Fetch(IP);
+				if (!Answer.empty())
+					Cache_->add(IP, Answer);
+			}
+			return Answer.empty() ? Default_ : Answer;
+		}
+
+		inline void run() final {
+			Utils::SetThreadName("iptocountry");
+			while (true) {
+				std::string Address;
+				{
+					std::unique_lock Lock(QueueMutex_);
+					Signal_.wait(Lock, [this] { return !Running_ || !Pending_.empty(); });
+					if (!Running_)
+						break;
+					Address = Pending_.front();
+					Pending_.pop_front();
+				}
+				if (!Cache_->has(Address)) {
+					auto Answer = Fetch(Address);
 					if (!Answer.empty())
-						return Answer;
+						Cache_->add(Address, Answer);
 				}
-			} catch (...) {
+				std::lock_guard G(QueueMutex_);
+				PendingSet_.erase(Address);
 			}
-			return Default_;
 		}
 
 		inline auto Enabled() const { return Enabled_; }
@@ -189,6 +405,38 @@ namespace OpenWifi {
 		std::string Default_;
 		std::unique_ptr<IPToCountryProvider> Provider_;
 		std::string ProviderName_;
+		std::unique_ptr<Poco::ExpireLRUCache<std::string, std::string>> Cache_;
+
+		std::mutex QueueMutex_;
+		std::condition_variable Signal_;
+		Poco::Thread Worker_;
+		std::atomic_bool Running_ = false;
+		std::deque<std::string> Pending_;
+		std::set<std::string> PendingSet_;
+		std::uint64_t MaxPending_ = 4096;
+
+		inline void QueueRefresh(const std::string &Address) {
+			{
+				std::lock_guard G(QueueMutex_);
+				if (!Running_ || Pending_.size() >= MaxPending_ ||
+					!PendingSet_.insert(Address).second)
+					return;
+				Pending_.push_back(Address);
+			}
+			Signal_.notify_one();
+		}
+
+		inline std::string Fetch(const std::string &IP) {
+			try {
+				std::string URL = Provider_->URI(IP).toString();
+				std::string Response;
+				if (Utils::wgets(URL, Response)) {
+					return Provider_->Country(Response);
+				}
+			} catch (...) {
+			}
+			return "";
+		}
 
 		FindCountryFromIP() noexcept : SubSystemServer("IpToCountry", "IPTOC-SVR", "iptocountry") {}
 	};
@@ -14,6 +14,126 @@ using OpenWifi::RESTAPI_utils::field_to_json;
 
 namespace OpenWifi {
 
+	RADIUSSessionPtr RADIUSSessionShard::Find(const std::string &SerialNumber, const std::string &Index) const {
+		auto ap_hint = Sessions_.find(SerialNumber);
+		if(ap_hint==end(Sessions_)) {
+			return nullptr;
+		}
+		auto session_hint = ap_hint->second.find(Index);
+		if(session_hint==end(ap_hint->second)) {
+			return nullptr;
+		}
+		return session_hint->second;
+	}
+
+	void RADIUSSessionShard::Add(const std::string &Index, const RADIUSSessionPtr &Session) {
+		Remove(Session->serialNumber, Index);
+		Sessions_[Session->serialNumber][Index] = Session;
+		ByUserName_[Session->userName].insert(Session);
+		ByCallingStationId_[Session->callingStationId].insert(Session);
+		NumberOfSessions_++;
+		Touch(Index, Session);
+	}
+
+	void RADIUSSessionShard::Touch(const std::string &Index, const RADIUSSessionPtr &Session) {
+		ByLastTransaction_.emplace(Session->lastTransaction, std::make_pair(Session->serialNumber, Index));
+	}
+
+	void RADIUSSessionShard::Unindex(NameIndex &Index, const std::string &Key, const RADIUSSessionPtr &Session) {
+		auto hint = Index.find(Key);
+		if(hint==end(Index)) {
+			return;
+		}
+		hint->second.erase(Session);
+		if(hint->second.empty()) {
+			Index.erase(hint);
+		}
+	}
+
+	void RADIUSSessionShard::Remove(const std::string &SerialNumber, const std::string &Index) {
+		auto ap_hint = Sessions_.find(SerialNumber);
+		if(ap_hint==end(Sessions_)) {
+			return;
+		}
+		auto session_hint = ap_hint->second.find(Index);
+		if(session_hint==end(ap_hint->second)) {
+			return;
+		}
+		Unindex(ByUserName_, session_hint->second->userName, session_hint->second);
+		Unindex(ByCallingStationId_, session_hint->second->callingStationId, session_hint->second);
+		ap_hint->second.erase(session_hint);
+		NumberOfSessions_--;
+		if(ap_hint->second.empty()) {
+			Sessions_.erase(ap_hint);
+		}
+	}
+
+	RADIUSSessionShard::SessionMap RADIUSSessionShard::RemoveDevice(const std::string &SerialNumber) {
+		SessionMap Removed;
+		auto ap_hint = Sessions_.find(SerialNumber);
+		if(ap_hint==end(Sessions_)) {
+			return Removed;
+		}
+		Removed.swap(ap_hint->second);
+		Sessions_.erase(ap_hint);
+		for(const auto &[_,session]:Removed) {
+			Unindex(ByUserName_, session->userName, session);
+			Unindex(ByCallingStationId_, session->callingStationId, session);
+		}
+		NumberOfSessions_ -= Removed.size();
+		return Removed;
+	}
+
+	std::vector<RADIUSSessionPtr> RADIUSSessionShard::Expire(std::uint64_t Oldest) {
+		std::vector<RADIUSSessionPtr> Expired;
+		while(!ByLastTransaction_.empty() && ByLastTransaction_.begin()->first < Oldest) {
+			auto Entry = ByLastTransaction_.begin();
+			auto LastTransaction = Entry->first;
+			auto [SerialNumber, Index] = std::move(Entry->second);
+			ByLastTransaction_.erase(Entry);
+			auto Session = Find(SerialNumber, Index);
+			if(Session!=nullptr && Session->lastTransaction==LastTransaction) {
+				Remove(SerialNumber, Index);
+				Expired.emplace_back(Session);
+			}
+		}
+		return Expired;
+	}
+
+	template <typename F> static void SearchIndex(const RADIUSSessionShard::NameIndex &Index, const std::string &Pattern, F Found) {
+		auto Wildcard = Pattern.find_first_of("*?");
+		if(Wildcard==std::string::npos) {
+			auto hint = Index.find(Pattern);
+			if(hint!=end(Index)) {
+				Found(hint->second);
+			}
+			return;
+		}
+
+		auto Prefix = Pattern.substr(0, Wildcard);
+		for(auto hint = Index.lower_bound(Prefix);
+			 hint!=end(Index) && hint->first.compare(0, Prefix.size(), Prefix)==0; ++hint) {
+			if(Utils::match(Pattern.c_str(), hint->first.c_str())) {
+				Found(hint->second);
+			}
+		}
+	}
+
+	void RADIUSSessionShard::Search(const NameIndex &Index, const std::string &Pattern, GWObjects::RADIUSSessionList &List) {
+		SearchIndex(Index, Pattern, [&](const std::set<RADIUSSessionPtr> &Sessions) {
+			for(const auto &session:Sessions) {
+				List.sessions.emplace_back(*session);
+			}
+		});
+	}
+
+	void RADIUSSessionShard::Lookup(const NameIndex &Index, const std::string &Key, std::vector<RADIUSSessionPtr> &List) {
+		auto hint = Index.find(Key);
+		if(hint!=end(Index)) {
+			List.insert(end(List), hint->second.begin(), hint->second.end());
+		}
+	}
+
 	int RADIUSSessionTracker::Start() {
 		poco_information(Logger(),"Starting...");
 		QueueManager_.start(*this);
@@ -35,30 +155,17 @@ namespace OpenWifi {
 	}
 
 	void RADIUSSessionTracker::GarbageCollection([[maybe_unused]] Poco::Timer &timer) {
-		std::lock_guard		G(Mutex_);
-
 		auto Now = Utils::Now();
+		auto Oldest = Now > SessionTimeout_ ? Now - SessionTimeout_ : 0;
 		std::uint64_t active_sessions=0, active_devices=0;
-		for(auto device_it = AccountingSessions_.begin(); device_it != end(AccountingSessions_); ) {
-			auto & serialNumber = device_it->first;
-			auto & session_list = device_it->second;
-			for(auto session_it=session_list.begin();session_it!=end(session_list);) {
-				auto & session_name = session_it->first;
-				auto & session = session_it->second;
-				if((Now-session->lastTransaction)>SessionTimeout_) {
-					poco_debug(Logger(),fmt::format("{}: Session {} timeout for {}", serialNumber, session_name, session->userName));
-					session_it = session_list.erase(session_it);
-				} else {
-					++active_sessions;
-					++session_it;
-				}
-			}
-			if(session_list.empty()) {
-				device_it = AccountingSessions_.erase(device_it);
-			} else {
-				++active_devices;
-				++device_it;
+		for(auto &Shard:Shards_) {
+			std::lock_guard		G(Shard.Mutex_);
+			for(const auto &session:Shard.Expire(Oldest)) {
+				poco_debug(Logger(),fmt::format("{}: Session {}{} timeout for {}", session->serialNumber,
+												session->accountingSessionId, session->accountingMultiSessionId, session->userName));
 			}
+			active_sessions += Shard.NumberOfSessions_;
+			active_devices += Shard.Sessions_.size();
 		}
 		poco_information(Logger(),fmt::format("{} active sessions on {} devices",active_sessions, active_devices));
 	}
@@ -96,51 +203,33 @@ namespace OpenWifi {
 	}
 
 	void RADIUSSessionTracker::ProcessAuthenticationSession([[maybe_unused]] OpenWifi::SessionNotification &Notification) {
-		std::lock_guard Guard(Mutex_);
-
 		std::string CallingStationId, CalledStationId, AccountingSessionId, AccountingMultiSessionId, UserName, ChargeableUserIdentity, Interface, nasId;
-		for (const auto &attribute : Notification.Packet_.Attrs_) {
-			switch (attribute.type) {
+		Notification.Packet_.View().ForEachAttribute([&](std::uint8_t Type, std::string_view Value) {
+			switch (Type) {
 			case RADIUS::Attributes::AUTH_USERNAME: {
-				UserName.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				UserName.assign(Value);
 			} break;
 			case RADIUS::Attributes::CALLING_STATION_ID: {
-				CallingStationId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				CallingStationId.assign(Value);
 			} break;
 			case RADIUS::Attributes::CALLED_STATION_ID: {
-				CalledStationId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				CalledStationId.assign(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_SESSION_ID: {
-				AccountingSessionId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				AccountingSessionId.assign(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_MULTI_SESSION_ID: {
-				AccountingMultiSessionId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				AccountingMultiSessionId.assign(Value);
 			} break;
 			case RADIUS::Attributes::CHARGEABLE_USER_IDENTITY:{
-				ChargeableUserIdentity.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				ChargeableUserIdentity.assign(Value);
 			} break;
 			case RADIUS::Attributes::NAS_IDENTIFIER:{
-				nasId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				nasId.assign(Value);
 			} break;
 			case RADIUS::Attributes::PROXY_STATE: {
 				std::string Tmp;
-				Tmp.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				Tmp.assign(Value);
 				auto ProxyParts = Poco::StringTokenizer(Tmp,":");
 				if(ProxyParts.count()==4)
 					Interface=ProxyParts[3];
@@ -149,18 +238,15 @@ namespace OpenWifi {
 			default: {
 			} break;
 			}
-		}
+			return false;
+		});
 
-		auto ap_hint = AccountingSessions_.find(Notification.SerialNumber_);
-		if(ap_hint==end(AccountingSessions_)) {
-			SessionMap M;
-			AccountingSessions_[Notification.SerialNumber_ ] = M;
-			ap_hint = AccountingSessions_.find(Notification.SerialNumber_);
-		}
+		auto &Shard = ShardFor(Notification.SerialNumber_);
+		std::lock_guard Guard(Shard.Mutex_);
 
 		auto Index = AccountingSessionId +AccountingMultiSessionId;
-		auto session_hint = ap_hint->second.find(Index);
-		if(session_hint==end(ap_hint->second)) {
+		auto Session = Shard.Find(Notification.SerialNumber_, Index);
+		if(Session==nullptr) {
 			auto NewSession = std::make_shared<GWObjects::RADIUSSession>();
 			NewSession->serialNumber = Notification.SerialNumber_;
 			NewSession->started = NewSession->lastTransaction = Utils::Now();
@@ -173,22 +259,17 @@ namespace OpenWifi {
 			NewSession->interface = Interface;
 			NewSession->nasId = nasId;
 			NewSession->secret = Notification.Secret_;
-			ap_hint->second[Index] = NewSession;
+			Shard.Add(Index, NewSession);
 		} else {
-			session_hint->second->lastTransaction = Utils::Now();
-		}
-
-/*
-		if(ap_hint!=AccountingSessions_.end()) {
-			std::cout << "Auth table:" << std::endl;
-			for(const auto &session:ap_hint->second) {
-				std::cout << Notification.SerialNumber_ << ":  Index: " << session.first << ": ID: " << session.second->accountingSessionId << "  MID:" << session.second->accountingMultiSessionId << std::endl;
-			}
+			Session->lastTransaction = Utils::Now();
+			Shard.Touch(Index, Session);
 		}
-*/
 	}
 
-	std::uint32_t GetUiInt32(const std::uint8_t *buf) {
+	std::uint32_t GetUiInt32(std::string_view Value) {
+		if (Value.size() < 4)
+			return 0;
+		auto buf = (const std::uint8_t *)Value.data();
 		return (buf[0] << 24) + (buf[1] << 16) + (buf[2] << 8) + (buf[3] << 0);
 	}
 
@@ -200,73 +281,58 @@ namespace OpenWifi {
 
 	void
 	RADIUSSessionTracker::ProcessAccountingSession(OpenWifi::SessionNotification &Notification) {
-		std::lock_guard     Guard(Mutex_);
-
 		std::string CallingStationId, CalledStationId, AccountingSessionId, AccountingMultiSessionId, UserName, ChargeableUserIdentity, Interface;
 		std::uint8_t AccountingPacketType = 0;
 		std::uint32_t InputOctets=0, OutputOctets=0, InputPackets=0, OutputPackets=0, InputGigaWords=0, OutputGigaWords=0,
 					  SessionTime = 0;
-		for (const auto &attribute : Notification.Packet_.Attrs_) {
-			switch (attribute.type) {
+		Notification.Packet_.View().ForEachAttribute([&](std::uint8_t Type, std::string_view Value) {
+			switch (Type) {
 			case RADIUS::Attributes::AUTH_USERNAME: {
-				UserName.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				UserName.assign(Value);
 			} break;
 			case RADIUS::Attributes::CALLING_STATION_ID: {
-				CallingStationId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				CallingStationId.assign(Value);
 			} break;
 			case RADIUS::Attributes::CALLED_STATION_ID: {
-				CalledStationId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				CalledStationId.assign(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_SESSION_ID: {
-				AccountingSessionId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				AccountingSessionId.assign(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_MULTI_SESSION_ID: {
-				AccountingMultiSessionId.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				AccountingMultiSessionId.assign(Value);
 			} break;
 			case RADIUS::Attributes::CHARGEABLE_USER_IDENTITY:{
-				ChargeableUserIdentity.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				ChargeableUserIdentity.assign(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_STATUS_TYPE: {
-				AccountingPacketType = Notification.Packet_.P_.attributes[attribute.pos + 3];
+				if (Value.size() >= 4)
+					AccountingPacketType = Value[3];
 			} break;
 			case RADIUS::Attributes::ACCT_INPUT_OCTETS: {
-				InputOctets = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				InputOctets = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_INPUT_PACKETS: {
-				InputPackets = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				InputPackets = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_INPUT_GIGAWORDS: {
-				InputGigaWords = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				InputGigaWords = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_OUTPUT_OCTETS: {
-				OutputOctets = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				OutputOctets = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_OUTPUT_PACKETS: {
-				OutputPackets= GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				OutputPackets= GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_OUTPUT_GIGAWORDS: {
-				OutputGigaWords = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				OutputGigaWords = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::ACCT_SESSION_TIME: {
-				SessionTime = GetUiInt32(&Notification.Packet_.P_.attributes[attribute.pos]);
+				SessionTime = GetUiInt32(Value);
 			} break;
 			case RADIUS::Attributes::PROXY_STATE: {
 				std::string Tmp;
-				Tmp.assign(
-					&Notification.Packet_.P_.attributes[attribute.pos],
-					&Notification.Packet_.P_.attributes[attribute.pos + attribute.len]);
+				Tmp.assign(Value);
 				auto ProxyParts = Poco::StringTokenizer(Tmp,":");
 				if(ProxyParts.count()==4)
 					Interface=ProxyParts[3];
@@ -275,18 +341,15 @@ namespace OpenWifi {
 			default: {
 			} break;
 			}
-		}
+			return false;
+		});
 
-		auto ap_hint = AccountingSessions_.find(Notification.SerialNumber_);
-		if(ap_hint==end(AccountingSessions_)) {
-			SessionMap M;
-			AccountingSessions_[Notification.SerialNumber_ ] = M;
-			ap_hint = AccountingSessions_.find(Notification.SerialNumber_);
-		}
+		auto &Shard = ShardFor(Notification.SerialNumber_);
+		std::lock_guard Guard(Shard.Mutex_);
 
 		auto Index = AccountingSessionId + AccountingMultiSessionId;
-		auto session_hint = ap_hint->second.find(Index);
-		if(session_hint==end(ap_hint->second)) {
+		auto Session = Shard.Find(Notification.SerialNumber_, Index);
+		if(Session==nullptr) {
 			//  find the calling_station_id
 			//  if we are getting a stop for something we do not know, nothing to do...
 			if( AccountingPacketType!=OpenWifi::RADIUS::AccountingPacketTypes::ACCT_STATUS_TYPE_START &&
@@ -305,7 +368,7 @@ namespace OpenWifi {
 			NewSession->calledStationId = CalledStationId;
 			NewSession->accountingSessionId = AccountingSessionId;
 			NewSession->accountingMultiSessionId = AccountingMultiSessionId;
-			NewSession->accountingPacket = Notification.Packet_;
+			NewSession->accountingPacket = std::move(Notification.Packet_);
 			NewSession->destination = Notification.Destination_;
 			NewSession->inputOctets = InputOctets;
 			NewSession->inputPackets = InputPackets;
@@ -319,36 +382,29 @@ namespace OpenWifi {
 			NewSession->secret = Notification.Secret_;
 
 			poco_debug(Logger(),fmt::format("{}: Creating session", CallingStationId));
-			ap_hint->second[Index] = NewSession;
+			Shard.Add(Index, NewSession);
 
 		} else {
 
 			//  If we receive a stop, just remove that session
 			if(AccountingPacketType==OpenWifi::RADIUS::AccountingPacketTypes::ACCT_STATUS_TYPE_STOP) {
 				poco_debug(Logger(),fmt::format("{}: Deleting session", CallingStationId));
-				ap_hint->second.erase(Index);
+				Shard.Remove(Notification.SerialNumber_, Index);
 			} else {
 				poco_debug(Logger(),fmt::format("{}: Updating session", CallingStationId));
-				session_hint->second->accountingPacket = Notification.Packet_;
-				session_hint->second->destination = Notification.Destination_;
-				session_hint->second->lastTransaction = Utils::Now();
-				session_hint->second->inputOctets = InputOctets;
-				session_hint->second->inputPackets = InputPackets;
-				session_hint->second->inputGigaWords = InputGigaWords;
-				session_hint->second->outputOctets = OutputOctets;
-				session_hint->second->outputOctets = OutputPackets;
-				session_hint->second->outputGigaWords = OutputGigaWords;
-				session_hint->second->sessionTime = SessionTime;
+				Session->accountingPacket = std::move(Notification.Packet_);
+				Session->destination = Notification.Destination_;
+				Session->lastTransaction = Utils::Now();
+				Session->inputOctets = InputOctets;
+				Session->inputPackets = InputPackets;
+				Session->inputGigaWords = InputGigaWords;
+				Session->outputOctets = OutputOctets;
+				Session->outputOctets = OutputPackets;
+				Session->outputGigaWords = OutputGigaWords;
+				Session->sessionTime = SessionTime;
+				Shard.Touch(Index, Session);
 			}
 		}
-
-/*		if(ap_hint!=AccountingSessions_.end()) {
-			std::cout << "Acct table:" << std::endl;
-			for(const auto &session:ap_hint->second) {
-				std::cout << Notification.SerialNumber_ << ":  Index: " << session.first << ": ID: " << session.second->accountingSessionId << "  MID:" << session.second->accountingMultiSessionId << std::endl;
-  			}
-		}
-*/
 	}
 
 	[[maybe_unused]] static void store_packet(const std::string &serialNumber, const char *buffer, std::size_t size, int i) {
@@ -392,16 +448,19 @@ namespace OpenWifi {
 
 	bool RADIUSSessionTracker::SendCoADM(const std::string &serialNumber, const std::string &sessionId) {
 		poco_information(Logger(),fmt::format("{}: SendCoADM for {}.", serialNumber, sessionId));
-		std::lock_guard		Guard(Mutex_);
+		RADIUSSessionPtr Session;
+		{
+			auto &Shard = ShardFor(serialNumber);
+			std::lock_guard		Guard(Shard.Mutex_);
 
-		auto ap_hint = AccountingSessions_.find(serialNumber);
-		if(ap_hint==end(AccountingSessions_)) {
-			return false;
+			if(Shard.Sessions_.find(serialNumber)==end(Shard.Sessions_)) {
+				return false;
+			}
+			Session = Shard.Find(serialNumber, sessionId);
 		}
 
-		auto session_hint = ap_hint->second.find(sessionId);
-		if(session_hint!=ap_hint->second.end()) {
-			SendCoADM(session_hint->second);
+		if(Session!=nullptr) {
+			SendCoADM(Session);
 		}
 
 		return true;
@@ -409,14 +468,15 @@ namespace OpenWifi {
 
 	bool RADIUSSessionTracker::DisconnectUser(const std::string &UserName) {
 		poco_information(Logger(),fmt::format("Disconnect user {}.", UserName));
-		std::lock_guard		Guard(Mutex_);
 
-		for(const auto &AP:AccountingSessions_) {
-			for(const auto &Session:AP.second) {
-				if(Session.second->userName==UserName) {
-					SendCoADM(Session.second);
-				}
-			}
+		std::vector<RADIUSSessionPtr>	Sessions;
+		for(auto &Shard:Shards_) {
+			std::lock_guard		Guard(Shard.Mutex_);
+			RADIUSSessionShard::Lookup(Shard.ByUserName_, UserName, Sessions);
+		}
+
+		for(const auto &Session:Sessions) {
+			SendCoADM(Session);
 		}
 
 		return true;
@@ -425,15 +485,15 @@ namespace OpenWifi {
 	void RADIUSSessionTracker::DisconnectSession(const std::string &SerialNumber) {
 		poco_information(Logger(),fmt::format("{}: Disconnecting.", SerialNumber));
 
-		std::lock_guard		Guard(Mutex_);
-
-		auto hint = AccountingSessions_.find(SerialNumber);
-		if(hint==end(AccountingSessions_)) {
-			return;
+		RADIUSSessionShard::SessionMap	Sessions;
+		{
+			auto &Shard = ShardFor(SerialNumber);
+			std::lock_guard		Guard(Shard.Mutex_);
+			Sessions = Shard.RemoveDevice(SerialNumber);
 		}
 
 		//	we need to go through all sessions and send an accounting stop
-		for(const auto &session:hint->second) {
+		for(const auto &session:Sessions) {
 			poco_debug(Logger(), fmt::format("Stopping accounting for {}:{}", SerialNumber, session.first ));
 
 			RADIUS::RadiusPacket	P(session.second->accountingPacket);
@@ -444,8 +504,6 @@ namespace OpenWifi {
 			P.AppendAttribute(RADIUS::Attributes::ACCT_TERMINATE_CAUSE, (std::uint32_t) RADIUS::AccountingTerminationReasons::ACCT_TERMINATE_LOST_CARRIER);
 			RADIUS_proxy_server()->RouteAndSendAccountingPacket(session.second->destination, SerialNumber, P, true, session.second->secret);
 		}
-
-		AccountingSessions_.erase(hint);
 	}
 
 
@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <array>
+#include <map>
+#include <mutex>
+#include <set>
+
 #include <framework/SubSystemServer.h>
 #include <Poco/Runnable.h>
 #include <Poco/Notification.h>
@@ -26,8 +31,8 @@ namespace OpenWifi {
 			ap_disconnect
 		};
 
-		explicit SessionNotification(NotificationType T, const std::string &Destination, const std::string &SerialNumber, const RADIUS::RadiusPacket &P, const std::string &secret)
-			: Type_(T), Destination_(Destination), SerialNumber_(SerialNumber), Packet_(P), Secret_(secret) {
+		explicit SessionNotification(NotificationType T, const std::string &Destination, const std::string &SerialNumber, RADIUS::RadiusPacket &&P, const std::string &secret)
+			: Type_(T), Destination_(Destination), SerialNumber_(SerialNumber), Packet_(std::move(P)), Secret_(secret) {
 		}
 
 		explicit SessionNotification(const std::string &SerialNumber)
@@ -84,6 +89,40 @@ namespace OpenWifi {
 
 	using RADIUSSessionPtr = std::shared_ptr<GWObjects::RADIUSSession>;
 
+	/*
+	 * 	The sessions of a group of devices. Besides the per-device map, sessions are indexed by user
+	 * name and calling station id, and by last transaction time so that garbage collection only
+	 * visits sessions that may have expired. Callers hold Mutex_.
+	 */
+	class RADIUSSessionShard {
+	  public:
+		using SessionMap = std::map<std::string,RADIUSSessionPtr>;	//	accounting-session-id + accounting-multi-session-id
+		using NameIndex = std::map<std::string,std::set<RADIUSSessionPtr>>;
+
+		std::mutex								Mutex_;
+		std::map<std::string,SessionMap>		Sessions_;			//	serial-number -> sessions
+		NameIndex								ByUserName_;
+		NameIndex								ByCallingStationId_;
+		std::uint64_t 							NumberOfSessions_=0;
+
+		RADIUSSessionPtr Find(const std::string &SerialNumber, const std::string &Index) const;
+		void Add(const std::string &Index, const RADIUSSessionPtr &Session);
+		void Touch(const std::string &Index, const RADIUSSessionPtr &Session);
+		void Remove(const std::string &SerialNumber, const std::string &Index);
+		SessionMap RemoveDevice(const std::string &SerialNumber);
+		std::vector<RADIUSSessionPtr> Expire(std::uint64_t Oldest);
+
+		//	Exact lookup when the pattern has no wildcard, otherwise only the keys sharing its prefix are matched.
+		static void Search(const NameIndex &Index, const std::string &Pattern, GWObjects::RADIUSSessionList &List);
+		static void Lookup(const NameIndex &Index, const std::string &Key, std::vector<RADIUSSessionPtr> &List);
+
+	  private:
+		//	last transaction -> serial-number, session index. Entries made stale by a later transaction are skipped.
+		std::multimap<std::uint64_t,std::pair<std::string,std::string>>	ByLastTransaction_;
+
+		static void Unindex(NameIndex &Index, const std::string &Key, const RADIUSSessionPtr &Session);
+	};
+
 	class RADIUSSessionTracker : public SubSystemServer, Poco::Runnable {
 	  public:
 
@@ -97,23 +136,22 @@ namespace OpenWifi {
 		void run() final;
 
 		inline void AddAccountingSession(const std::string &Destination, const std::string &SerialNumber,
-										 const RADIUS::RadiusPacket &P, const std::string &secret) {
-			SessionMessageQueue_.enqueueNotification(new SessionNotification(SessionNotification::NotificationType::accounting_session_message, Destination, SerialNumber, P, secret));
+										 RADIUS::RadiusPacket &&P, const std::string &secret) {
+			SessionMessageQueue_.enqueueNotification(new SessionNotification(SessionNotification::NotificationType::accounting_session_message, Destination, SerialNumber, std::move(P), secret));
 		}
 
 		inline void AddAuthenticationSession(const std::string &Destination, const std::string &SerialNumber,
-											 const RADIUS::RadiusPacket &P, const std::string &secret) {
-			std::lock_guard	G(Mutex_);
-			auto ap_hint = AccountingSessions_.find(SerialNumber);
-			if(AccountingSessions_.find(SerialNumber)!=end(AccountingSessions_)) {
+											 RADIUS::RadiusPacket &&P, const std::string &secret) {
+			{
 				//	if we have already added the info, do not need to add it again
-				auto CallingStationId = P.ExtractCallingStationID();
-				auto AccountingSessionId = P.ExtractAccountingSessionID();
-				if(ap_hint->second.find(CallingStationId+AccountingSessionId)!=end(ap_hint->second)) {
+				auto Index = P.ExtractAccountingSessionID() + P.ExtractAccountingMultiSessionID();
+				auto &Shard = ShardFor(SerialNumber);
+				std::lock_guard	G(Shard.Mutex_);
+				if(!Index.empty() && Shard.Find(SerialNumber, Index)!=nullptr) {
 					return;
 				}
 			}
-			SessionMessageQueue_.enqueueNotification(new SessionNotification(SessionNotification::NotificationType::authentication_session_message, Destination, SerialNumber, P, secret));
+			SessionMessageQueue_.enqueueNotification(new SessionNotification(SessionNotification::NotificationType::authentication_session_message, Destination, SerialNumber, std::move(P), secret));
 		}
 
 		inline void DeviceDisconnect(const std::string &serialNumber) {
@@ -121,18 +159,20 @@ namespace OpenWifi {
 		}
 
 		inline void GetAPList(std::vector<std::string> &SerialNumbers) {
-			std::lock_guard	G(Mutex_);
-
-			for(const auto &[serialNumber,_]:AccountingSessions_) {
-				SerialNumbers.emplace_back(serialNumber);
+			for(auto &Shard:Shards_) {
+				std::lock_guard	G(Shard.Mutex_);
+				for(const auto &[serialNumber,_]:Shard.Sessions_) {
+					SerialNumbers.emplace_back(serialNumber);
+				}
 			}
 		}
 
 		inline void GetAPSessions(const std::string &SerialNumber, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
+			auto &Shard = ShardFor(SerialNumber);
+			std::lock_guard	G(Shard.Mutex_);
 
-			auto ap_hint = AccountingSessions_.find(SerialNumber);
-			if(ap_hint!=end(AccountingSessions_)) {
+			auto ap_hint = Shard.Sessions_.find(SerialNumber);
+			if(ap_hint!=end(Shard.Sessions_)) {
 				for(const auto &[index,session]:ap_hint->second) {
 					list.sessions.emplace_back(*session);
 				}
@@ -140,26 +180,16 @@ namespace OpenWifi {
 		}
 
 		inline void GetUserNameAPSessions(const std::string &userName, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
-
-			for(const auto &[_,sessions]:AccountingSessions_) {
-				for(const auto &[_,session]:sessions) {
-					if(Utils::match(userName.c_str(),session->userName.c_str())) {
-						list.sessions.emplace_back(*session);
-					}
-				}
+			for(auto &Shard:Shards_) {
+				std::lock_guard	G(Shard.Mutex_);
+				RADIUSSessionShard::Search(Shard.ByUserName_, userName, list);
 			}
 		}
 
 		inline void GetMACAPSessions(const std::string &mac, GWObjects::RADIUSSessionList & list) {
-			std::lock_guard	G(Mutex_);
-
-			for(const auto &[_,sessions]:AccountingSessions_) {
-				for(const auto &[_,session]:sessions) {
-					if(Utils::match(mac.c_str(),session->callingStationId.c_str())) {
-						list.sessions.emplace_back(*session);
-					}
-				}
+			for(auto &Shard:Shards_) {
+				std::lock_guard	G(Shard.Mutex_);
+				RADIUSSessionShard::Search(Shard.ByCallingStationId_, mac, list);
 			}
 		}
 
@@ -168,9 +198,10 @@ namespace OpenWifi {
 		bool DisconnectUser(const std::string &UserName);
 
 		inline std::uint32_t HasSessions(const std::string & serialNumber) {
-			std::lock_guard	G(Mutex_);
-			auto ap_hint = AccountingSessions_.find(serialNumber);
-			if(ap_hint==end(AccountingSessions_)) {
+			auto &Shard = ShardFor(serialNumber);
+			std::lock_guard	G(Shard.Mutex_);
+			auto ap_hint = Shard.Sessions_.find(serialNumber);
+			if(ap_hint==end(Shard.Sessions_)) {
 				return 0;
 			}
 			return ap_hint->second.size();
@@ -183,14 +214,17 @@ namespace OpenWifi {
 		Poco::NotificationQueue 	SessionMessageQueue_;
 		Poco::Thread				QueueManager_;
 
-		using SessionMap = std::map<std::string,RADIUSSessionPtr>;	//	calling-station-id + accounting-session-id
-		std::map<std::string,SessionMap>		AccountingSessions_;				//	serial-number -> session< accounting-session -> session>
+		//	The accounting thread and REST lookups only meet on the shard of the device they touch.
+		std::array<RADIUSSessionShard,32>	Shards_;
 
 		Poco::Timer 												GarbageCollectionTimer_;
 		std::unique_ptr<Poco::TimerCallback<RADIUSSessionTracker>> 	GarbageCollectionCallback_;
 
 		std::uint64_t 				SessionTimeout_=10*60;
 
+		inline RADIUSSessionShard & ShardFor(const std::string &SerialNumber) {
+			return Shards_[Utils::CalculateMacAddressHash(SerialNumber) % Shards_.size()];
+		}
 
 		void ProcessAccountingSession(SessionNotification &Notification);
 		void ProcessAuthenticationSession(SessionNotification &Notification);
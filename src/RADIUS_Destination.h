@@ -4,8 +4,15 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <numeric>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
 
 #include "RESTObjects/RESTAPI_GWobjects.h"
 
@@ -27,13 +34,176 @@
 
 namespace OpenWifi {
 
+	/*
+	 * 	Chooses the server of a generic pool for each packet, without locks. The pool strategy is
+	 * honoured: round_robin, random, or weighted (a smooth weighted round-robin schedule computed once).
+	 * The choice is sticky: a session key is mapped onto the schedule, so every round of an EAP
+	 * exchange reaches the server that holds its State. Sessions only move when their server is
+	 * down: it failed a send, or left a request unanswered for ResponseTimeout seconds. A server
+	 * that is down is skipped until its retry time, unless every server is down.
+	 */
+	class RADIUS_ServerSelector {
+	  public:
+		static constexpr std::uint64_t RetryDelay = 30;
+		static constexpr std::uint64_t ResponseTimeout = 10;
+
+		//	CoA servers send the requests and only get our answers: they are never timed out.
+		explicit RADIUS_ServerSelector(const GWObjects::RadiusProxyServerConfig &Config,
+									   bool ExpectsReplies = true)
+			: ExpectsReplies_(ExpectsReplies) {
+			std::vector<std::uint64_t> Weights;
+			for (const auto &server : Config.servers) {
+				if (server.ignore)
+					continue;
+				Poco::Net::IPAddress a;
+				if (!Poco::Net::IPAddress::tryParse(server.ip, a))
+					continue;
+				Servers_.emplace_back(
+					std::make_unique<Server>(Poco::Net::SocketAddress(a, server.port)));
+				Weights.emplace_back(server.weight == 0 ? 1 : server.weight);
+			}
+
+			Random_ = Config.strategy == "random";
+			if (Config.strategy == "weighted" && Servers_.size() > 1) {
+				BuildWeightedSchedule(Weights);
+			} else {
+				for (std::size_t i = 0; i < Servers_.size(); ++i)
+					Schedule_.emplace_back(i);
+			}
+		}
+
+		[[nodiscard]] inline bool Empty() const { return Servers_.empty(); }
+
+		inline std::size_t Next(std::uint64_t SessionKey) {
+			//	Random scatters the sessions over the schedule; the others keep them in order.
+			auto Start = Random_ ? Scatter(SessionKey) : SessionKey;
+			auto Now = Utils::Now();
+			for (std::size_t i = 0; i < Schedule_.size(); ++i) {
+				auto Index = Schedule_[(Start + i) % Schedule_.size()];
+				if (Available(*Servers_[Index], Now))
+					return Index;
+			}
+			return Schedule_[Start % Schedule_.size()];
+		}
+
+		[[nodiscard]] inline const Poco::Net::SocketAddress &Address(std::size_t Index) const {
+			return Servers_[Index]->Address;
+		}
+
+		inline void Failed(std::size_t Index) {
+			Servers_[Index]->RetryAfter.store(Utils::Now() + RetryDelay, std::memory_order_relaxed);
+		}
+
+		//	The packet left. A server that answers requests is only healthy once it replies.
+		inline void Sent(std::size_t Index) {
+			auto &S = *Servers_[Index];
+			if (!ExpectsReplies_) {
+				Up(S);
+				return;
+			}
+			std::uint64_t None = 0;
+			S.WaitingSince.compare_exchange_strong(None, Utils::Now(), std::memory_order_relaxed);
+		}
+
+		inline void Replied(const Poco::Net::SocketAddress &From) {
+			for (auto &S : Servers_) {
+				if (S->Address == From) {
+					S->WaitingSince.store(0, std::memory_order_relaxed);
+					Up(*S);
+					return;
+				}
+			}
+		}
+
+	  private:
+		struct Server {
+			explicit Server(const Poco::Net::SocketAddress &A) : Address(A) {}
+			Poco::Net::SocketAddress Address;
+			std::atomic_uint64_t RetryAfter = 0;
+			//	When the oldest request not followed by any reply was sent, 0 when none is.
+			std::atomic_uint64_t WaitingSince = 0;
+		};
+
+		bool ExpectsReplies_ = true;
+
+		static inline void Up(Server &S) {
+			if (S.RetryAfter.load(std::memory_order_relaxed) != 0)
+				S.RetryAfter.store(0, std::memory_order_relaxed);
+		}
+
+		static inline bool Available(Server &S, std::uint64_t Now) {
+			auto RetryAfter = S.RetryAfter.load(std::memory_order_relaxed);
+			if (RetryAfter != 0 && RetryAfter > Now)
+				return false;
+			auto WaitingSince = S.WaitingSince.load(std::memory_order_relaxed);
+			if (WaitingSince != 0 && (Now - WaitingSince) > ResponseTimeout) {
+				//	Silent for too long: down until the retry time, then it gets requests again.
+				S.RetryAfter.store(Now + RetryDelay, std::memory_order_relaxed);
+				S.WaitingSince.store(0, std::memory_order_relaxed);
+				return false;
+			}
+			return true;
+		}
+
+		std::vector<std::unique_ptr<Server>> Servers_;
+		std::vector<std::size_t> Schedule_;
+		bool Random_ = false;
+
+		static inline std::uint64_t Scatter(std::uint64_t Key) {
+			Key ^= Key >> 33;
+			Key *= 0xff51afd7ed558ccdULL;
+			Key ^= Key >> 33;
+			return Key;
+		}
+
+		void BuildWeightedSchedule(std::vector<std::uint64_t> &Weights) {
+			std::uint64_t Divisor = 0;
+			for (const auto w : Weights)
+				Divisor = std::gcd(Divisor, w);
+			std::uint64_t Total = 0;
+			for (auto &w : Weights) {
+				w /= Divisor;
+				Total += w;
+			}
+
+			//	Keep the schedule small: large weights are scaled down, never to zero.
+			constexpr std::uint64_t MaxScheduleSize = 1024;
+			if (Total > MaxScheduleSize) {
+				std::uint64_t Scaled = 0;
+				for (auto &w : Weights) {
+					w = std::max<std::uint64_t>(1, (w * MaxScheduleSize) / Total);
+					Scaled += w;
+				}
+				Total = Scaled;
+			}
+
+			std::vector<std::int64_t> Current(Weights.size(), 0);
+			for (std::uint64_t slot = 0; slot < Total; ++slot) {
+				std::size_t Best = 0;
+				for (std::size_t i = 0; i < Weights.size(); ++i) {
+					Current[i] += (std::int64_t)Weights[i];
+					if (Current[i] > Current[Best])
+						Best = i;
+				}
+				Current[Best] -= (std::int64_t)Total;
+				Schedule_.emplace_back(Best);
+			}
+		}
+	};
+
 	class RADIUS_Destination : public Poco::Runnable {
 	  public:
-		RADIUS_Destination(Poco::Net::SocketReactor &R, const GWObjects::RadiusProxyPool &P)
-			: Reactor_(R),
+		//	Generic pools get one socket per reactor for each port. RadSec pools use a single reactor.
+		RADIUS_Destination(const std::vector<Poco::Net::SocketReactor *> &Reactors, std::size_t Index,
+						   const GWObjects::RadiusProxyPool &P)
+			: Reactors_(Reactors),
+			  Reactor_(*Reactors[Index % Reactors.size()]),
 			  Logger_(Poco::Logger::get(
 				  fmt::format("RADSEC: {}", P.name))),
-			  Pool_(P)
+			  Pool_(P),
+			  AuthServers_(P.authConfig),
+			  AcctServers_(P.acctConfig),
+			  CoAServers_(P.coaConfig, false)
 		{
 			Type_ = GWObjects::RadiusEndpointType(P.radsecPoolType);
 			Start();
@@ -72,10 +242,12 @@ namespace OpenWifi {
 							CurrentDelay = 10;
 						}
 					}
-				} else if ((Utils::Now() - LastKeepAlive) > Pool_.radsecKeepAlive) {
+				} else if (Type_ != GWObjects::RadiusEndpointType::generic &&
+						   (Utils::Now() - LastKeepAlive) > Pool_.radsecKeepAlive) {
 					RADIUS::RadiusOutputPacket P(Pool_.authConfig.servers[ServerIndex_].radsecSecret);
 					P.MakeStatusMessage(Pool_.authConfig.servers[ServerIndex_].name);
 					poco_trace(Logger_, fmt::format("{}: Keep-Alive message.", Pool_.authConfig.servers[ServerIndex_].name));
+					std::lock_guard G(SendMutex_);
 					Socket_->sendBytes(P.Data(), P.Len());
 					LastKeepAlive = Utils::Now();
 				}
@@ -87,6 +259,8 @@ namespace OpenWifi {
 							 int length) {
 			try {
 				if (Connected_) {
+					//	Packets arrive from many device reactors, a TLS stream takes one writer at a time.
+					std::lock_guard G(SendMutex_);
 					RADIUS::RadiusPacket P(buffer, length);
 					int sent_bytes;
 					if (P.VerifyMessageAuthenticator(Pool_.authConfig.servers[ServerIndex_].radsecSecret)) {
@@ -188,85 +362,116 @@ namespace OpenWifi {
 			Disconnect();
 		}
 
-		inline void OnAccountingSocketReadable(
-			const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
-			Poco::Net::SocketAddress Sender;
+		//	Drains the datagrams waiting on a socket. On Linux, one system call reads a whole batch.
+		//	Process gets each packet with the address of the server that sent it.
+		template <typename F>
+		inline void ReceivePackets(const Poco::Net::Socket &Socket, F Process) {
+#if defined(__linux__)
+			constexpr std::size_t BatchSize = 16;
+			thread_local std::array<RADIUS::RadiusPacket, BatchSize> Packets;
+			std::array<struct mmsghdr, BatchSize> Headers{};
+			std::array<struct iovec, BatchSize> Vectors{};
+			std::array<struct sockaddr_storage, BatchSize> Sources{};
+			for (std::size_t i = 0; i < BatchSize; ++i) {
+				Vectors[i].iov_base = Packets[i].Buffer();
+				Vectors[i].iov_len = Packets[i].BufferLen();
+				Headers[i].msg_hdr.msg_iov = &Vectors[i];
+				Headers[i].msg_hdr.msg_iovlen = 1;
+				Headers[i].msg_hdr.msg_name = &Sources[i];
+				Headers[i].msg_hdr.msg_namelen = sizeof(Sources[i]);
+			}
+			auto Received =
+				recvmmsg(Socket.impl()->sockfd(), Headers.data(), BatchSize, MSG_DONTWAIT, nullptr);
+			for (int i = 0; i < Received; ++i)
+				Process(Packets[i], (int)Headers[i].msg_len,
+						Poco::Net::SocketAddress((const struct sockaddr *)&Sources[i],
+												 Headers[i].msg_hdr.msg_namelen));
+#else
 			RADIUS::RadiusPacket P;
+			Poco::Net::SocketAddress Source;
+			auto ReceiveSize = Socket.impl()->receiveFrom(P.Buffer(), P.BufferLen(), Source);
+			Process(P, ReceiveSize, Source);
+#endif
+		}
 
-			auto ReceiveSize = pNf->socket().impl()->receiveBytes(P.Buffer(), P.BufferLen());
-			if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
-				poco_warning(Logger_, "Accounting: bad packet received.");
-				return;
-			}
-			P.Evaluate(ReceiveSize);
-			auto SerialNumber = P.ExtractSerialNumberFromProxyState();
-			if (SerialNumber.empty()) {
-				poco_warning(Logger_, "Accounting: missing serial number. Dropping request.");
-				return;
-			}
-			poco_debug(
-				Logger_,
-				fmt::format(
-					"Accounting Packet Response received for {}", SerialNumber ));
-			AP_WS_Server()->SendRadiusAccountingData(SerialNumber, P.Buffer(), P.Size());
+		inline void OnAccountingSocketReadable(
+			const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
+			ReceivePackets(pNf->socket(), [this](RADIUS::RadiusPacket &P, int ReceiveSize,
+												 const Poco::Net::SocketAddress &Source) {
+				if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
+					poco_warning(Logger_, "Accounting: bad packet received.");
+					return;
+				}
+				AcctServers_.Replied(Source);
+				P.Evaluate(ReceiveSize);
+				auto SerialNumber = P.ExtractSerialNumberFromProxyState();
+				if (SerialNumber.empty()) {
+					poco_warning(Logger_, "Accounting: missing serial number. Dropping request.");
+					return;
+				}
+				poco_debug(
+					Logger_,
+					fmt::format(
+						"Accounting Packet Response received for {}", SerialNumber ));
+				AP_WS_Server()->SendRadiusAccountingData(SerialNumber, P.Buffer(), P.Size());
+			});
 		}
 
 		inline void OnAuthenticationSocketReadable(
 			const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
-			Poco::Net::SocketAddress Sender;
-			RADIUS::RadiusPacket P;
-
-			auto ReceiveSize = pNf->socket().impl()->receiveBytes(P.Buffer(), P.BufferLen());
-			if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
-				poco_warning(Logger_, "Authentication: bad packet received.");
-				return;
-			}
-			P.Evaluate(ReceiveSize);
-
-			if(Logger_.trace()) {
-				P.Log(std::cout);
-			}
-			auto SerialNumber = P.ExtractSerialNumberFromProxyState();
-			if (SerialNumber.empty()) {
-				poco_warning(Logger_, "Authentication: missing serial number. Dropping request.");
-				return;
-			}
-			auto CallingStationID = P.ExtractCallingStationID();
-			auto CalledStationID = P.ExtractCalledStationID();
+			ReceivePackets(pNf->socket(), [this](RADIUS::RadiusPacket &P, int ReceiveSize,
+												 const Poco::Net::SocketAddress &Source) {
+				if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
+					poco_warning(Logger_, "Authentication: bad packet received.");
+					return;
+				}
+				AuthServers_.Replied(Source);
+				P.Evaluate(ReceiveSize);
 
-			poco_debug(
-				Logger_,
-				fmt::format(
-					"Authentication Packet received for {}, CalledStationID: {}, CallingStationID:{}",
-					SerialNumber, CalledStationID, CallingStationID));
-			AP_WS_Server()->SendRadiusAuthenticationData(SerialNumber, P.Buffer(), P.Size());
+				if(Logger_.trace()) {
+					P.Log(std::cout);
+				}
+				auto SerialNumber = P.ExtractSerialNumberFromProxyState();
+				if (SerialNumber.empty()) {
+					poco_warning(Logger_, "Authentication: missing serial number. Dropping request.");
+					return;
+				}
+				auto CallingStationID = P.ExtractCallingStationID();
+				auto CalledStationID = P.ExtractCalledStationID();
+
+				poco_debug(
+					Logger_,
+					fmt::format(
+						"Authentication Packet received for {}, CalledStationID: {}, CallingStationID:{}",
+						SerialNumber, CalledStationID, CallingStationID));
+				AP_WS_Server()->SendRadiusAuthenticationData(SerialNumber, P.Buffer(), P.Size());
+			});
 		}
 
 		inline void OnCoASocketReadable(
 			const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
-			Poco::Net::SocketAddress Sender;
-			RADIUS::RadiusPacket P;
-
-			auto ReceiveSize = pNf.get()->socket().impl()->receiveBytes(P.Buffer(), P.BufferLen());
-			if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
-				poco_warning(Logger_, "CoA/DM: bad packet received.");
-				return;
-			}
-
-			P.Evaluate(ReceiveSize);
-			auto SerialNumber = P.ExtractSerialNumberTIP();
-			if (SerialNumber.empty()) {
-				poco_warning(Logger_, "CoA/DM: missing serial number. Dropping request.");
-				return;
-			}
-			auto CallingStationID = P.ExtractCallingStationID();
-			auto CalledStationID = P.ExtractCalledStationID();
+			ReceivePackets(pNf->socket(), [this](RADIUS::RadiusPacket &P, int ReceiveSize,
+												 [[maybe_unused]] const Poco::Net::SocketAddress &Source) {
+				if (ReceiveSize < SMALLEST_RADIUS_PACKET) {
+					poco_warning(Logger_, "CoA/DM: bad packet received.");
+					return;
+				}
 
-			poco_debug(
-				Logger_,
-				fmt::format("CoA Packet received for {}, CalledStationID: {}, CallingStationID:{}",
-							SerialNumber, CalledStationID, CallingStationID));
-			AP_WS_Server()->SendRadiusCoAData(SerialNumber, P.Buffer(), P.Size());
+				P.Evaluate(ReceiveSize);
+				auto SerialNumber = P.ExtractSerialNumberTIP();
+				if (SerialNumber.empty()) {
+					poco_warning(Logger_, "CoA/DM: missing serial number. Dropping request.");
+					return;
+				}
+				auto CallingStationID = P.ExtractCallingStationID();
+				auto CalledStationID = P.ExtractCalledStationID();
+
+				poco_debug(
+					Logger_,
+					fmt::format("CoA Packet received for {}, CalledStationID: {}, CallingStationID:{}",
+								SerialNumber, CalledStationID, CallingStationID));
+				AP_WS_Server()->SendRadiusCoAData(SerialNumber, P.Buffer(), P.Size());
+			});
 		}
 		
 		static inline bool IsExpired(const Poco::Crypto::X509Certificate &C) {
@@ -497,74 +702,51 @@ namespace OpenWifi {
 			return false;
 		}
 
+		//	Every reactor gets its own socket on each port. SO_REUSEPORT lets the kernel spread the
+		//	replies over them, so the readable handlers run on all the reactor threads.
+		inline void OpenGenericSockets(std::vector<std::unique_ptr<Poco::Net::DatagramSocket>> &Sockets,
+									   std::uint64_t Port,
+									   void (RADIUS_Destination::*Handler)(
+										   const Poco::AutoPtr<Poco::Net::ReadableNotification> &)) {
+			Poco::Net::SocketAddress Address(Poco::Net::AddressFamily::IPv4, Port);
+			for (auto *Reactor : Reactors_) {
+				auto Socket = std::make_unique<Poco::Net::DatagramSocket>(Address, true, true);
+				Reactor->addEventHandler(
+					*Socket,
+					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(*this, Handler));
+				Sockets.emplace_back(std::move(Socket));
+			}
+		}
+
+		inline void CloseGenericSockets(std::vector<std::unique_ptr<Poco::Net::DatagramSocket>> &Sockets,
+										void (RADIUS_Destination::*Handler)(
+											const Poco::AutoPtr<Poco::Net::ReadableNotification> &)) {
+			for (std::size_t i = 0; i < Sockets.size(); ++i) {
+				Reactors_[i]->removeEventHandler(
+					*Sockets[i],
+					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(*this, Handler));
+				Sockets[i]->close();
+			}
+			Sockets.clear();
+		}
+
 		inline bool Connect_Generic() {
 			if (TryAgain_) {
 				std::lock_guard G(LocalMutex_);
 
-				Poco::Net::SocketAddress AuthSockAddrV4(
-					Poco::Net::AddressFamily::IPv4,
-					MicroServiceConfigGetInt("radius.proxy.authentication.port",
-											 DEFAULT_RADIUS_AUTHENTICATION_PORT));
-				AuthenticationSocketV4_ =
-					std::make_unique<Poco::Net::DatagramSocket>(AuthSockAddrV4, true, true);
-
-				Poco::Net::SocketAddress AcctSockAddrV4(
-					Poco::Net::AddressFamily::IPv4,
-					MicroServiceConfigGetInt("radius.proxy.accounting.port",
-											 DEFAULT_RADIUS_ACCOUNTING_PORT));
-				AccountingSocketV4_ =
-					std::make_unique<Poco::Net::DatagramSocket>(AcctSockAddrV4, true, true);
-
-				Poco::Net::SocketAddress CoASockAddrV4(
-					Poco::Net::AddressFamily::IPv4,
-					MicroServiceConfigGetInt("radius.proxy.coa.port", DEFAULT_RADIUS_CoA_PORT));
-				CoASocketV4_ = std::make_unique<Poco::Net::DatagramSocket>(CoASockAddrV4, true, true);
-
-/*
-				AuthenticationSocketV6_ =
-					std::make_unique<Poco::Net::DatagramSocket>(AuthSockAddrV6, true, true);
- 				Poco::Net::SocketAddress AuthSockAddrV6(
-					Poco::Net::AddressFamily::IPv6,
-					MicroServiceConfigGetInt("radius.proxy.authentication.port",
-											 DEFAULT_RADIUS_AUTHENTICATION_PORT));
-
-				Poco::Net::SocketAddress AcctSockAddrV6(
-					Poco::Net::AddressFamily::IPv6,
-					MicroServiceConfigGetInt("radius.proxy.accounting.port",
-											 DEFAULT_RADIUS_ACCOUNTING_PORT));
-				AccountingSocketV6_ =
-					std::make_unique<Poco::Net::DatagramSocket>(AcctSockAddrV6, true, true);
-
-				Poco::Net::SocketAddress CoASockAddrV6(
-					Poco::Net::AddressFamily::IPv6,
-					MicroServiceConfigGetInt("radius.proxy.coa.port", DEFAULT_RADIUS_CoA_PORT));
-				CoASocketV6_ = std::make_unique<Poco::Net::DatagramSocket>(CoASockAddrV6, true, true);
-*/
-				Reactor_.addEventHandler(
-					*AuthenticationSocketV4_,
-					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-						*this, &RADIUS_Destination::OnAuthenticationSocketReadable));
-				Reactor_.addEventHandler(
-					*AccountingSocketV4_,
-					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-						*this, &RADIUS_Destination::OnAccountingSocketReadable));
-				Reactor_.addEventHandler(
-					*CoASocketV4_, Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-									   *this, &RADIUS_Destination::OnCoASocketReadable));
-/*
-				Reactor_.addEventHandler(
-					*AuthenticationSocketV6_,
-					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-						*this, &RADIUS_Destination::OnAuthenticationSocketReadable));
-				Reactor_.addEventHandler(
-					*AccountingSocketV6_,
-					Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-						*this, &RADIUS_Destination::OnAccountingSocketReadable));
-
-				Reactor_.addEventHandler(
-					*CoASocketV6_, Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-									   *this, &RADIUS_Destination::OnCoASocketReadable));
-*/
+				OpenGenericSockets(AuthenticationSockets_,
+								   MicroServiceConfigGetInt("radius.proxy.authentication.port",
+															DEFAULT_RADIUS_AUTHENTICATION_PORT),
+								   &RADIUS_Destination::OnAuthenticationSocketReadable);
+				OpenGenericSockets(AccountingSockets_,
+								   MicroServiceConfigGetInt("radius.proxy.accounting.port",
+															DEFAULT_RADIUS_ACCOUNTING_PORT),
+								   &RADIUS_Destination::OnAccountingSocketReadable);
+				OpenGenericSockets(CoASockets_,
+								   MicroServiceConfigGetInt("radius.proxy.coa.port",
+															DEFAULT_RADIUS_CoA_PORT),
+								   &RADIUS_Destination::OnCoASocketReadable);
+				Connected_ = true;
 			}
 			return true;
 		}
@@ -590,60 +772,11 @@ namespace OpenWifi {
 			if (Connected_) {
 				std::lock_guard G(LocalMutex_);
 				if(Type_==GWObjects::RadiusEndpointType::generic) {
-					if(AuthenticationSocketV4_) {
-						Reactor_.removeEventHandler(
-							*AuthenticationSocketV4_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnAuthenticationSocketReadable));
-						AuthenticationSocketV4_->close();
-						AuthenticationSocketV4_.reset();
-					}
-
-					if(AccountingSocketV4_) {
-						Reactor_.removeEventHandler(
-							*AccountingSocketV4_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnAccountingSocketReadable));
-						AccountingSocketV4_->close();
-						AccountingSocketV4_.reset();
-					}
-
-					if(CoASocketV4_) {
-						Reactor_.removeEventHandler(
-							*CoASocketV4_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnCoASocketReadable));
-						CoASocketV4_->close();
-						CoASocketV4_.reset();
-					}
-
-/*					if(AuthenticationSocketV6_) {
-						Reactor_.removeEventHandler(
-							*AuthenticationSocketV6_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnAuthenticationSocketReadable));
-						AuthenticationSocketV6_->close();
-						AuthenticationSocketV6_.reset();
-					}
-
-					if(AccountingSocketV6_) {
-						Reactor_.removeEventHandler(
-							*AccountingSocketV6_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnAccountingSocketReadable));
-						AccountingSocketV6_->close();
-						AccountingSocketV6_.reset();
-					}
-
-					if(CoASocketV6_) {
-						Reactor_.removeEventHandler(
-							*CoASocketV6_,
-							Poco::NObserver<RADIUS_Destination, Poco::Net::ReadableNotification>(
-								*this, &RADIUS_Destination::OnCoASocketReadable));
-						CoASocketV6_->close();
-						CoASocketV6_.reset();
-					}
-*/
+					CloseGenericSockets(AuthenticationSockets_,
+										&RADIUS_Destination::OnAuthenticationSocketReadable);
+					CloseGenericSockets(AccountingSockets_,
+										&RADIUS_Destination::OnAccountingSocketReadable);
+					CloseGenericSockets(CoASockets_, &RADIUS_Destination::OnCoASocketReadable);
 				} else {
 					if(Socket_!=nullptr) {
 						std::lock_guard G(LocalMutex_);
@@ -697,37 +830,32 @@ namespace OpenWifi {
 
 		inline bool SendRadiusDataAuthData(const std::string &serialNumber, const unsigned char *buffer, std::size_t  size) {
 			poco_trace(Logger_, fmt::format("{}: Sending RADIUS Auth {} bytes.", serialNumber, size));
-			AuthenticationSocketV4_->sendTo(buffer, size, Poco::Net::SocketAddress(Pool_.authConfig.servers[0].ip, Pool_.authConfig.servers[0].port));
-			return true;
+			return SendDatagram(AuthenticationSockets_, AuthServers_, serialNumber, buffer, size);
 		}
 
 		inline bool SendRadiusDataAcctData(const std::string &serialNumber, const unsigned char *buffer, std::size_t  size) {
 			poco_trace(Logger_, fmt::format("{}: Sending RADIUS Acct {} bytes.", serialNumber, size));
-			AccountingSocketV4_->sendTo(buffer, size, Poco::Net::SocketAddress(Pool_.acctConfig.servers[0].ip, Pool_.acctConfig.servers[0].port));
-			return true;
+			return SendDatagram(AccountingSockets_, AcctServers_, serialNumber, buffer, size);
 		}
 
 		inline bool SendRadiusDataCoAData(const std::string &serialNumber, const unsigned char *buffer, std::size_t  size) {
 			poco_trace(Logger_, fmt::format("{}: Sending RADIUS CoA {} bytes.", serialNumber, size));
-			CoASocketV4_->sendTo(buffer, size, Poco::Net::SocketAddress(Pool_.coaConfig.servers[0].ip, Pool_.coaConfig.servers[0].port));
-			return true;
+			return SendDatagram(CoASockets_, CoAServers_, serialNumber, buffer, size);
 		}
 
 	  private:
 		std::recursive_mutex 							LocalMutex_;
+		std::mutex 										SendMutex_;
+		std::vector<Poco::Net::SocketReactor *> 		Reactors_;
 		Poco::Net::SocketReactor 						&Reactor_;
 		Poco::Logger 									&Logger_;
 
 		std::unique_ptr<Poco::Net::SecureStreamSocket> 	Socket_;
 
-		std::unique_ptr<Poco::Net::DatagramSocket> 		AccountingSocketV4_;
-		std::unique_ptr<Poco::Net::DatagramSocket> 		AuthenticationSocketV4_;
-		std::unique_ptr<Poco::Net::DatagramSocket> 		CoASocketV4_;
-
-/*		std::unique_ptr<Poco::Net::DatagramSocket> 		CoASocketV6_;
-		std::unique_ptr<Poco::Net::DatagramSocket> 		AccountingSocketV6_;
-		std::unique_ptr<Poco::Net::DatagramSocket> 		AuthenticationSocketV6_;
-*/
+		using DatagramSockets = std::vector<std::unique_ptr<Poco::Net::DatagramSocket>>;
+		DatagramSockets 								AccountingSockets_;
+		DatagramSockets 								AuthenticationSockets_;
+		DatagramSockets 								CoASockets_;
 
 		Poco::Thread 									ReconnectThread_;
 		std::unique_ptr<Poco::Crypto::X509Certificate> 	Peer_Cert_;
@@ -735,6 +863,40 @@ namespace OpenWifi {
 		volatile bool 									TryAgain_ = true;
 		enum GWObjects::RadiusEndpointType				Type_{GWObjects::RadiusEndpointType::unknown};
 		GWObjects::RadiusProxyPool						Pool_;
+		RADIUS_ServerSelector 							AuthServers_;
+		RADIUS_ServerSelector 							AcctServers_;
+		RADIUS_ServerSelector 							CoAServers_;
 		uint64_t 										ServerIndex_=0;
+
+		//	A session is the device and the client station: all its packets go to the same server.
+		static inline std::uint64_t SessionKey(const std::string &serialNumber,
+											   const unsigned char *buffer, std::size_t size) {
+			RADIUS::RadiusPacketView View(buffer, size);
+			auto Station = View.Find(RADIUS::Attributes::CALLING_STATION_ID, 1);
+			return std::hash<std::string>{}(serialNumber) * 31 +
+				   std::hash<std::string_view>{}(Station);
+		}
+
+		//	Any socket of the group can send. Picking it by serial number spreads the send buffers.
+		inline bool SendDatagram(const DatagramSockets &Sockets, RADIUS_ServerSelector &Servers,
+								 const std::string &serialNumber, const unsigned char *buffer,
+								 std::size_t size) {
+			if (!Connected_ || Sockets.empty() || Servers.Empty())
+				return false;
+			auto Index = Servers.Next(SessionKey(serialNumber, buffer, size));
+			try {
+				auto &Socket = *Sockets[Utils::CalculateMacAddressHash(serialNumber) % Sockets.size()];
+				if (Socket.sendTo(buffer, size, Servers.Address(Index)) == (int)size) {
+					Servers.Sent(Index);
+					return true;
+				}
+			} catch (const Poco::Exception &E) {
+				Logger_.log(E);
+			}
+			poco_warning(Logger_, fmt::format("{}: RADIUS server {} did not take the packet.",
+											  serialNumber, Servers.Address(Index).toString()));
+			Servers.Failed(Index);
+			return false;
+		}
 	};
 } // namespace OpenWifi
\ No newline at end of file
@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "Poco/HMACEngine.h"
 #include "Poco/MD5Engine.h"
@@ -249,7 +253,8 @@ namespace OpenWifi::RADIUS {
 		unsigned char identifier{0};
 		uint16_t rawlen{0};
 		unsigned char authenticator[16]{0};
-		unsigned char attributes[4096]{0};
+		//	Left uninitialized: only the first rawlen - 20 bytes are ever read.
+		unsigned char attributes[4096];
 	};
 #pragma pack(pop)
 
@@ -296,7 +301,7 @@ namespace OpenWifi::RADIUS {
 	// From: https://github.com/Telecominfraproject/wlan-dictionary/blob/main/dictionary.tip
 	//
 
-	using AttributeList = std::list<RadiusAttribute>;
+	using AttributeList = std::vector<RadiusAttribute>;
 
 	inline std::ostream &operator<<(std::ostream &os, AttributeList const &P) {
 		for (const auto &attr : P) {
@@ -310,8 +315,7 @@ namespace OpenWifi::RADIUS {
 							AttributeList &Attrs) {
 		Attrs.clear();
 		uint16_t pos = 0;
-		auto x = 25;
-		while (pos < Size && x) {
+		while (pos < Size) {
 			RadiusAttribute Attr{.type = Buffer[pos],
 								 .pos = (uint16_t)(pos + 2 + offset),
 								 .len = (unsigned int)(Buffer[pos + 1] - 2)};
@@ -328,11 +332,152 @@ namespace OpenWifi::RADIUS {
 				return false;
 			}
 			pos += Buffer[pos + 1];
-			x--;
 		}
 		return true;
 	}
 
+	/*
+	 * 	A read-only view over a packet already in memory, usually the buffer it was received in.
+	 * Nothing is copied and attributes are decoded only when asked for: routing a packet only walks
+	 * its attributes until Proxy-State is found.
+	 */
+	class RadiusPacketView {
+	  public:
+		RadiusPacketView(const unsigned char *Buffer, std::size_t Size)
+			: Buffer_(Buffer), Size_(Size) {}
+
+		[[nodiscard]] inline std::uint8_t Code() const { return Size_ > 0 ? Buffer_[0] : 0; }
+		[[nodiscard]] inline std::uint8_t Identifier() const { return Size_ > 1 ? Buffer_[1] : 0; }
+		[[nodiscard]] inline std::size_t Size() const { return Size_; }
+
+		//	Calls Visit(type, value) for every attribute, in order, until it returns true.
+		template <typename F> inline bool ForEachAttribute(F Visit) const {
+			return ForEachAttribute(AttributeOffset, Size_, Visit);
+		}
+
+		//	The first attribute of that type holding at least MinLength bytes, empty if there is none.
+		[[nodiscard]] inline std::string_view Find(std::uint8_t Type, std::size_t MinLength = 0) const {
+			std::string_view Result;
+			ForEachAttribute([&](std::uint8_t T, std::string_view Value) {
+				if (T != Type || Value.size() < MinLength)
+					return false;
+				Result = Value;
+				return true;
+			});
+			return Result;
+		}
+
+		[[nodiscard]] inline bool Has(std::uint8_t Type) const {
+			return ForEachAttribute([Type](std::uint8_t T, std::string_view) { return T == Type; });
+		}
+
+		[[nodiscard]] inline std::string ExtractSerialNumberTIP() const {
+			std::string Result;
+			ForEachAttribute([&](std::uint8_t Type, std::string_view Value) {
+				if (Type != 26 || Value.size() <= (4 + 2))
+					return false;
+				auto Vendor = (std::uint32_t)(((std::uint8_t)Value[0] << 24) | ((std::uint8_t)Value[1] << 16) |
+											  ((std::uint8_t)Value[2] << 8) | (std::uint8_t)Value[3]);
+				if (Vendor != TIP_vendor_id)
+					return false;
+				auto Start = (std::size_t)(Value.data() - (const char *)Buffer_) + 4;
+				return ForEachAttribute(Start, Start + Value.size() - 4,
+										[&](std::uint8_t VendorType, std::string_view Serial) {
+											if (VendorType != TIP_serial)
+												return false;
+											for (const auto c : Serial)
+												if (c != '-')
+													Result += c;
+											return true;
+										});
+			});
+			return Result;
+		}
+
+		[[nodiscard]] inline std::string ExtractSerialNumberFromProxyState() const {
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(Find(Attributes::PROXY_STATE), Parts))
+				return std::string(Parts[0]);
+			return "";
+		}
+
+		[[nodiscard]] inline std::string ExtractProxyStateDestination() const {
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(Find(Attributes::PROXY_STATE, 3), Parts)) {
+				Poco::Net::SocketAddress D{std::string(Parts[1]), std::string(Parts[2])};
+				return D.toString();
+			}
+			return "";
+		}
+
+		[[nodiscard]] inline std::uint32_t ExtractProxyStateDestinationIPint() const {
+			std::array<std::string_view, 4> Parts;
+			if (SplitProxyState(Find(Attributes::PROXY_STATE, 3), Parts))
+				return Utils::IPtoInt(std::string(Parts[1]));
+			return 0;
+		}
+
+		[[nodiscard]] inline std::string ExtractCallingStationID() const {
+			return std::string(Find(Attributes::CALLING_STATION_ID, 1));
+		}
+
+		[[nodiscard]] inline std::string ExtractCalledStationID() const {
+			return std::string(Find(Attributes::CALLED_STATION_ID, 1));
+		}
+
+		[[nodiscard]] inline std::string ExtractAccountingSessionID() const {
+			return std::string(Find(Attributes::ACCT_SESSION_ID, 1));
+		}
+
+		[[nodiscard]] inline std::string ExtractAccountingMultiSessionID() const {
+			return std::string(Find(Attributes::ACCT_MULTI_SESSION_ID, 1));
+		}
+
+		[[nodiscard]] inline std::string UserName() const {
+			return std::string(Find(Attributes::AUTH_USERNAME));
+		}
+
+		//	Proxy-State is serial:IP:port:interface. Older gateways used '|' as the separator.
+		static inline bool SplitProxyState(std::string_view State,
+										   std::array<std::string_view, 4> &Parts) {
+			for (const char Separator : {'|', ':'}) {
+				std::size_t Count = 0, Start = 0;
+				bool Complete = false;
+				while (Count < Parts.size()) {
+					auto End = State.find(Separator, Start);
+					Parts[Count++] = State.substr(
+						Start, End == std::string_view::npos ? End : End - Start);
+					if (End == std::string_view::npos) {
+						Complete = true;
+						break;
+					}
+					Start = End + 1;
+				}
+				if (Complete && Count == Parts.size())
+					return true;
+			}
+			return false;
+		}
+
+	  private:
+		const unsigned char *Buffer_;
+		std::size_t Size_;
+
+		template <typename F>
+		inline bool ForEachAttribute(std::size_t Pos, std::size_t End, F Visit) const {
+			while (Pos + 2 <= End) {
+				std::size_t Length = Buffer_[Pos + 1];
+				if (Length < 2 || Pos + Length > End)
+					return false;
+				if (Visit(Buffer_[Pos],
+						  std::string_view((const char *)&Buffer_[Pos + 2], Length - 2)))
+					return true;
+				Pos += Length;
+			}
+			return false;
+		}
+	};
+
 	class RadiusPacket {
 	  public:
 		explicit RadiusPacket(const Poco::Buffer<char> &Buf) {
@@ -343,8 +488,6 @@ namespace OpenWifi::RADIUS {
 			memcpy((void *)&P_, Buf.begin(), Buf.size());
 			Size_ = Buf.size();
 			Valid_ = (Size_ == ntohs(P_.rawlen));
-			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
 		}
 
 		explicit RadiusPacket(const unsigned char *buffer, uint16_t size) {
@@ -355,8 +498,6 @@ namespace OpenWifi::RADIUS {
 			memcpy((void *)&P_, buffer, size);
 			Size_ = size;
 			Valid_ = (Size_ == ntohs(P_.rawlen));
-			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
 		}
 
 		explicit RadiusPacket(const std::string &p) {
@@ -367,41 +508,66 @@ namespace OpenWifi::RADIUS {
 			memcpy((void *)&P_, (const unsigned char *)p.c_str(), p.size());
 			Size_ = p.size();
 			Valid_ = (Size_ == ntohs(P_.rawlen));
-			if (Valid_)
-				Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
 		}
 
-		RadiusPacket(const RadiusPacket &P) {
-			Valid_ = P.Valid_;
-			Size_ = P.Size_;
-			P_ = P.P_;
-			Attrs_ = P.Attrs_;
+		RadiusPacket(const RadiusPacket &P) { CopyPacket(P); }
+
+		RadiusPacket(RadiusPacket &&P) noexcept {
+			CopyPacket(P);
+			Attrs_ = std::move(P.Attrs_);
+			Parsed_ = P.Parsed_;
 		}
 
+		//	The packet was edited: attributes are decoded again on their next use.
         void ReParse() {
             P_.rawlen = htons(Size_);
-            Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+            Parsed_ = false;
         }
 
 		inline RadiusPacket& operator=(const RadiusPacket& other) {
-			Valid_ = other.Valid_;
-			Size_ = other.Size_;
-			P_ = other.P_;
-			Attrs_ = other.Attrs_;
+			if (this != &other)
+				CopyPacket(other);
 			return *this;
 		}
 
-		explicit RadiusPacket() :
- 			P_{0}, Size_(AttributeOffset)
-		{
-		};
+		inline RadiusPacket& operator=(RadiusPacket&& other) noexcept {
+			if (this != &other) {
+				CopyPacket(other);
+				Attrs_ = std::move(other.Attrs_);
+				Parsed_ = other.Parsed_;
+			}
+			return *this;
+		}
+
+		//	Only the header is in use until attributes are added or a packet is read into Buffer(),
+		//	so the rest of the 4 KB buffer is left uninitialized.
+		explicit RadiusPacket() : Size_(AttributeOffset) {
+			memset((void *)&P_, 0, AttributeOffset);
+		}
 
 		unsigned char *Buffer() { return (unsigned char *)&P_; }
 		[[nodiscard]] uint16_t BufferLen() const { return sizeof(P_); }
 
 		void Evaluate(uint16_t size) {
 			Size_ = size;
-			Valid_ = ParseRadius(0, (unsigned char *)&P_.attributes[0], Size_ - 20, Attrs_);
+			Valid_ = Size_ >= AttributeOffset;
+			Parsed_ = false;
+		}
+
+		[[nodiscard]] inline RadiusPacketView View() const {
+			return RadiusPacketView((const unsigned char *)&P_, Size_);
+		}
+
+		//	Only the calls that edit or print the packet need the decoded attribute list.
+		[[nodiscard]] inline const AttributeList &ParsedAttributes() const {
+			if (!Parsed_) {
+				Attrs_.clear();
+				if (Size_ < AttributeOffset ||
+					!ParseRadius(0, &P_.attributes[0], Size_ - AttributeOffset, Attrs_))
+					Valid_ = false;
+				Parsed_ = true;
+			}
+			return Attrs_;
 		}
 
 		[[nodiscard]] uint16_t Len() const { return ntohs(P_.rawlen); }
@@ -439,24 +605,16 @@ namespace OpenWifi::RADIUS {
 		}
 
 		inline bool IsStatusMessageReply(std::string &ReplySource) {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE) {
-					std::string Attr33;
-					// format is statis:server name
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, ":");
-					if(Parts.count() == 2 && Parts[0] == "status") {
-						ReplySource = Parts[1];
-						return true;
-					}
-					return false;
-				}
-			}
-			DBGLINE
-			return false;
+			// format is status:server name
+			auto State = View().Find(RADIUS::Attributes::PROXY_STATE);
+			auto Colon = State.find(':');
+			if (Colon == std::string_view::npos || State.substr(0, Colon) != "status" ||
+				State.find(':', Colon + 1) != std::string_view::npos)
+				return false;
+			ReplySource = std::string(State.substr(Colon + 1));
+			return true;
 		}
+
 		void Log(std::ostream &os) {
 			uint16_t p = 0;
 
@@ -481,11 +639,12 @@ namespace OpenWifi::RADIUS {
 		inline void PacketType(std::uint8_t T) { P_.code = T; }
 
 		void ComputeMessageAuthenticator(const std::string &secret) {
-			RawRadiusPacket P = P_;
+			RawRadiusPacket P;
+			memcpy((void *)&P, (const void *)&P_, Size_);
 
 			if (P_.code == 1) {
 				unsigned char OldAuthenticator[16]{0};
-				for (const auto &attr : Attrs_) {
+				for (const auto &attr : ParsedAttributes()) {
 					if (attr.type == 80) {
 						memcpy(OldAuthenticator, &P_.attributes[attr.pos], 16);
 						memset(&P.attributes[attr.pos], 0, 16);
@@ -504,7 +663,7 @@ namespace OpenWifi::RADIUS {
 					// std::cout << "Authenticator match..." << std::endl;
 				} else {
 					// std::cout << "Authenticator MIS-match..." << std::endl;
-					for (const auto &attr : Attrs_) {
+					for (const auto &attr : ParsedAttributes()) {
 						if (attr.type == 80) {
 							memcpy(&P_.attributes[attr.pos], NewAuthenticator, 16);
 						}
@@ -529,10 +688,11 @@ namespace OpenWifi::RADIUS {
 		}
 
 		bool VerifyMessageAuthenticator(const std::string &secret) {
-			RawRadiusPacket P = P_;
+			RawRadiusPacket P;
+			memcpy((void *)&P, (const void *)&P_, Size_);
 			if (P_.code == 1) {
 				unsigned char OldAuthenticator[16]{0};
-				for (const auto &attr : Attrs_) {
+				for (const auto &attr : ParsedAttributes()) {
 					if (attr.type == 80) {
 						memcpy(OldAuthenticator, &P_.attributes[attr.pos], 16);
 						memset(&P.attributes[attr.pos], 0, 16);
@@ -603,7 +763,7 @@ namespace OpenWifi::RADIUS {
 			os << "  Authenticator: ";
 			BufLog(os, "", P_.authenticator, sizeof(P_.authenticator));
 			os << "  Attributes: " << std::endl;
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				os << "    " << std::setfill(' ') << "(" << std::setw(4) << (uint)attr.type << ") "
 				   << AttributeName(attr.type) << "   Len:" << attr.len << std::endl;
 				std::string attr_offset = "           ";
@@ -617,165 +777,34 @@ namespace OpenWifi::RADIUS {
 			os << std::dec << std::endl << std::endl;
 		}
 
-		std::string ExtractSerialNumberTIP() {
-			std::string R;
-
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == 26) {
-					AttributeList VendorAttributes;
-					uint32_t VendorId = htonl(*(const uint32_t *)&(P_.attributes[attribute.pos]));
-					// std::cout << VendorId << std::endl;
-					if (VendorId == TIP_vendor_id && attribute.len > (4 + 2)) {
-						if (ParseRadius(attribute.pos + 4, &P_.attributes[attribute.pos + 4],
-										attribute.len - 4 - 2, VendorAttributes)) {
-							// std::cout << VendorAttributes << std::endl;
-							for (const auto &vendorAttr : VendorAttributes) {
-								if (vendorAttr.type == TIP_serial) {
-									for (uint16_t i = 0; i < vendorAttr.len; i++) {
-										if (P_.attributes[vendorAttr.pos + i] == '-')
-											continue;
-										R += (char)P_.attributes[vendorAttr.pos + i];
-									}
-									return R;
-								}
-							}
-						}
-					}
-				}
-			}
-			return R;
-		}
+		std::string ExtractSerialNumberTIP() const { return View().ExtractSerialNumberTIP(); }
 
 		std::string ExtractSerialNumberFromProxyState() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE) {
-					std::string Attr33;
-					// format is serial:IP:port:interface
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						return Parts[0];
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						return Parts[0];
-					}
-					return Result;
-				}
-			}
-			return Result;
+			return View().ExtractSerialNumberFromProxyState();
 		}
 
 		std::string ExtractProxyStateDestination() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE && attribute.len > 2) {
-					std::string Attr33;
-					// format is
-
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						Poco::Net::SocketAddress D(Parts[1], Parts[2]);
-						return D.toString();
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						Poco::Net::SocketAddress D(Parts[1], Parts[2]);
-						return D.toString();
-					}
-					return Result;
-				}
-			}
-			return Result;
+			return View().ExtractProxyStateDestination();
 		}
 
 		std::uint32_t ExtractProxyStateDestinationIPint() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::PROXY_STATE && attribute.len > 2) {
-					std::string Attr33;
-					// format is
-
-					Attr33.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					auto Parts = Poco::StringTokenizer(Attr33, "|");
-					if (Parts.count() == 4) {
-						return Utils::IPtoInt(Parts[1]);
-					}
-					Parts = Poco::StringTokenizer(Attr33, ":");
-					if (Parts.count() == 4) {
-						return Utils::IPtoInt(Parts[1]);
-					}
-					return 0;
-				}
-			}
-			return 0;
+			return View().ExtractProxyStateDestinationIPint();
 		}
 
-		std::string ExtractCallingStationID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::CALLING_STATION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					return Result;
-				}
-			}
-			return Result;
-		}
+		std::string ExtractCallingStationID() const { return View().ExtractCallingStationID(); }
 
-		std::string ExtractAccountingSessionID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::ACCT_SESSION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len );
-					return Result;
-				}
-			}
-			return Result;
-		}
+		std::string ExtractAccountingSessionID() const { return View().ExtractAccountingSessionID(); }
 
 		std::string ExtractAccountingMultiSessionID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::ACCT_MULTI_SESSION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len );
-					return Result;
-				}
-			}
-			return Result;
+			return View().ExtractAccountingMultiSessionID();
 		}
 
-		std::string ExtractCalledStationID() const {
-			std::string Result;
-			for (const auto &attribute : Attrs_) {
-				if (attribute.type == RADIUS::Attributes::CALLED_STATION_ID && attribute.len > 0) {
-					Result.assign((const char *)(const char *)&P_.attributes[attribute.pos],
-								  attribute.len);
-					return Result;
-				}
-			}
-			return Result;
-		}
+		std::string ExtractCalledStationID() const { return View().ExtractCalledStationID(); }
 
-		[[nodiscard]] std::string UserName() const {
-			for (const auto &attr : Attrs_) {
-				if (attr.type == RADIUS::Attributes::AUTH_USERNAME) {
-					std::string user_name{(const char *)&P_.attributes[attr.pos], attr.len};
-					return user_name;
-				}
-			}
-			return "";
-		}
+		[[nodiscard]] std::string UserName() const { return View().UserName(); }
 
 		void ReplaceAttribute(std::uint8_t attribute, std::uint8_t value) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==attribute) {
 					P_.attributes[attr.pos] = value;
 					return;
@@ -784,7 +813,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void ReplaceAttribute(std::uint8_t attribute, std::uint16_t value) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==attribute) {
 					P_.attributes[attr.pos+0] = value >> 8;
 					P_.attributes[attr.pos+1] = value & 0x00ff;
@@ -794,7 +823,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void ReplaceAttribute(std::uint8_t attribute, std::uint32_t value) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==attribute) {
 					P_.attributes[attr.pos+0] = (std::uint8_t ) ((value & 0xff000000) >> 24);
 					P_.attributes[attr.pos+1] = (std::uint8_t ) ((value & 0x00ff0000) >> 16);
@@ -806,7 +835,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void ReplaceAttribute(std::uint8_t attribute, const char *attribute_value, std::uint8_t attribute_len) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==attribute) {
 					if(attr.len==attribute_len) {
 						memcpy(&P_.attributes[attr.pos], attribute_value, attribute_len);
@@ -835,7 +864,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void RemoveAttribute(std::uint8_t attribute) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==attribute) {
 					auto Shrink = attr.len+2;
 					memmove(&P_.attributes[attr.pos-2], &P_.attributes[attr.pos+attr.len], Size_ - Shrink);
@@ -895,7 +924,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void AddAttribute(std::uint8_t location, std::uint8_t attribute, std::uint8_t value) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==location) {
 					int Augment = 1;
 					memmove(&P_.attributes[attr.pos+attr.len+1+1+Augment], &P_.attributes[attr.pos+attr.len], Size_-(attr.pos+attr.len));
@@ -910,7 +939,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void AddAttribute(std::uint8_t location, std::uint8_t attribute, std::uint16_t value) {
-			for (const auto &attr : Attrs_) {
+			for (const auto &attr : ParsedAttributes()) {
 				if(attr.type==location) {
 					int Augment = 2;
 					memmove(&P_.attributes[attr.pos+attr.len+1+1+Augment], &P_.attributes[attr.pos+attr.len], Size_-(attr.pos+attr.len));
@@ -926,7 +955,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		void AddAttribute(std::uint8_t location, std::uint8_t attribute, std::uint32_t value) {
-			for (const auto &attr: Attrs_) {
+			for (const auto &attr: ParsedAttributes()) {
 				if (attr.type == location) {
 					int Augment = 4;
 					memmove(&P_.attributes[attr.pos + attr.len + 1 + 1 + Augment], &P_.attributes[attr.pos + attr.len],
@@ -946,7 +975,7 @@ namespace OpenWifi::RADIUS {
 
 
 		void AddAttribute(std::uint8_t location, std::uint8_t attribute, const char *attribute_value, std::uint8_t attribute_len) {
-			for (const auto &attr: Attrs_) {
+			for (const auto &attr: ParsedAttributes()) {
 				if (attr.type == location) {
 					int Augment = attribute_len;
 					memmove(&P_.attributes[attr.pos + attr.len + 1 + 1 + Augment], &P_.attributes[attr.pos + attr.len],
@@ -966,7 +995,7 @@ namespace OpenWifi::RADIUS {
 		}
 
 		bool HasAttribute(std::uint8_t attribute) const {
-			return std::any_of(Attrs_.begin(),Attrs_.end(),[attribute](const RadiusAttribute &Attr) { return Attr.type ==attribute; });
+			return View().Has(attribute);
 		}
 
 		void ReplaceOrAdd(std::uint8_t attribute, std::uint8_t attribute_value) {
@@ -1005,10 +1034,21 @@ namespace OpenWifi::RADIUS {
 
 		}
 
-		AttributeList Attrs_;
+		mutable AttributeList Attrs_;
 		RawRadiusPacket P_;
 		uint16_t Size_{0};
-		bool Valid_ = false;
+		mutable bool Valid_ = false;
+		mutable bool Parsed_ = false;
+
+	  private:
+		//	Only the bytes in use are copied. The attributes are decoded again when needed.
+		inline void CopyPacket(const RadiusPacket &Other) {
+			Size_ = Other.Size_;
+			Valid_ = Other.Valid_;
+			Parsed_ = false;
+			memcpy((void *)&P_, (const void *)&Other.P_,
+				   std::clamp<std::size_t>(Size_, AttributeOffset, sizeof(P_)));
+		}
 	};
 
 	class RadiusOutputPacket {
@@ -1055,7 +1095,7 @@ namespace OpenWifi::RADIUS {
 	};
 
 	inline std::ostream &operator<<(std::ostream &os, RadiusPacket const &P) {
-		os << P.Attrs_;
+		os << P.ParsedAttributes();
 		return os;
 	}
 } // namespace OpenWifi::RADIUS
\ No newline at end of file
@@ -2,6 +2,7 @@
 // Created by stephane bourque on 2022-05-18.
 //
 
+#include "Poco/Environment.h"
 #include "Poco/JSON/Parser.h"
 
 #include "AP_WS_Server.h"
@@ -36,9 +37,21 @@ namespace OpenWifi {
 		Enabled_ = true;
 
 		ParseConfig();
+
+		auto NumberOfReactors = MicroServiceConfigGetInt("radius.proxy.reactors",
+														 Poco::Environment::processorCount());
+		if (NumberOfReactors < 1)
+			NumberOfReactors = 1;
+		for (std::uint64_t i = 0; i < NumberOfReactors; ++i) {
+			auto Reactor = std::make_unique<Poco::Net::SocketReactor>();
+			auto Thread = std::make_unique<Poco::Thread>();
+			Thread->start(*Reactor);
+			Utils::SetThreadName(*Thread, fmt::format("rad:reactor:{}", i).c_str());
+			RadiusReactors_.emplace_back(std::move(Reactor));
+			RadiusReactorThreads_.emplace_back(std::move(Thread));
+		}
+
 		StartRADIUSDestinations();
-		RadiusReactorThread_.start(RadiusReactor_);
-		Utils::SetThreadName(RadiusReactorThread_, "rad:reactor");
 		Running_ = true;
 		return 0;
 	}
@@ -48,8 +61,12 @@ namespace OpenWifi {
 			poco_information(Logger(), "Stopping...");
 
 			StopRADIUSDestinations();
-			RadiusReactor_.stop();
-			RadiusReactorThread_.join();
+			for (auto &Reactor : RadiusReactors_)
+				Reactor->stop();
+			for (auto &Thread : RadiusReactorThreads_)
+				Thread->join();
+			RadiusReactorThreads_.clear();
+			RadiusReactors_.clear();
 			Running_ = false;
 			poco_information(Logger(), "Stopped...");
 		}
@@ -62,10 +79,15 @@ namespace OpenWifi {
 
 	void RADIUS_proxy_server::StartRADIUSDestinations() {
 		std::lock_guard G(Mutex_);
+		std::unique_lock Destinations(DestinationsMutex_);
+		std::vector<Poco::Net::SocketReactor *> Reactors;
+		for (const auto &Reactor : RadiusReactors_)
+			Reactors.emplace_back(Reactor.get());
+		std::size_t Index = 0;
 		for (const auto &pool : PoolList_.pools) {
 			if(pool.enabled) {
 				RADIUS_Destinations_[Utils::IPtoInt(pool.poolProxyIp)] =
-						std::make_unique<RADIUS_Destination>(RadiusReactor_, pool);
+						std::make_unique<RADIUS_Destination>(Reactors, Index++, pool);
 			} else {
 				poco_information(Logger(),fmt::format("Pool {} is not enabled.", pool.name));
 			}
@@ -74,6 +96,7 @@ namespace OpenWifi {
 
 	void RADIUS_proxy_server::StopRADIUSDestinations() {
 		std::lock_guard G(Mutex_);
+		std::unique_lock Destinations(DestinationsMutex_);
 		RADIUS_Destinations_.clear();
 	}
 
@@ -84,7 +107,7 @@ namespace OpenWifi {
 			auto DstParts = Utils::Split(Destination, ':');
 			std::uint32_t DtsIp = Utils::IPtoInt(DstParts[0]);
 
-			std::lock_guard G(Mutex_);
+			std::shared_lock G(DestinationsMutex_);
 
 			auto DestinationServer = RADIUS_Destinations_.find(DtsIp);
 			if (DestinationServer != end(RADIUS_Destinations_)) {
@@ -140,7 +163,7 @@ namespace OpenWifi {
 			auto Destination = P.ExtractProxyStateDestination();
 			std::string Secret;
 			RouteAndSendAccountingPacket(Destination, serialNumber, P, false, Secret);
-			RADIUSSessionTracker()->AddAccountingSession(Destination, serialNumber, P, Secret);
+			RADIUSSessionTracker()->AddAccountingSession(Destination, serialNumber, std::move(P), Secret);
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		} catch (...) {
@@ -161,9 +184,9 @@ namespace OpenWifi {
 			return;
 
 		try {
-			RADIUS::RadiusPacket P((unsigned char *)buffer, size);
+			RADIUS::RadiusPacketView P((const unsigned char *)buffer, size);
 
-			std::lock_guard G(Mutex_);
+			std::shared_lock G(DestinationsMutex_);
 
 			std::uint32_t 	DstIp = P.ExtractProxyStateDestinationIPint();
 			auto DestinationServer = RADIUS_Destinations_.find(DstIp);
@@ -203,12 +226,12 @@ namespace OpenWifi {
 			return;
 
 		try {
-			RADIUS::RadiusPacket P((unsigned char *)buffer, size);
+			RADIUS::RadiusPacketView P((const unsigned char *)buffer, size);
 			auto CallingStationID = P.ExtractCallingStationID();
 			auto CalledStationID = P.ExtractCalledStationID();
 			Poco::Net::SocketAddress Dst(Destination);
 
-			std::lock_guard G(Mutex_);
+			std::shared_lock G(DestinationsMutex_);
 			std::uint32_t 	DstIp = P.ExtractProxyStateDestinationIPint();
 			auto DestinationServer = RADIUS_Destinations_.find(DstIp);
 			if (DestinationServer != end(RADIUS_Destinations_)) {
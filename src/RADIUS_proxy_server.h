@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "RESTObjects/RESTAPI_GWobjects.h"
 
 #include "Poco/Net/DatagramSocket.h"
@@ -62,12 +64,15 @@ namespace OpenWifi {
 		inline bool Continue() const { return Running_ && Enabled_ && !Pools_.empty(); }
 
 	  private:
-		Poco::Net::SocketReactor 	RadiusReactor_;
-		Poco::Thread 				RadiusReactorThread_;
+		//	The datagram sockets of every generic pool are spread over these reactors.
+		std::vector<std::unique_ptr<Poco::Net::SocketReactor>> 	RadiusReactors_;
+		std::vector<std::unique_ptr<Poco::Thread>> 				RadiusReactorThreads_;
 
 		GWObjects::RadiusProxyPoolList PoolList_;
 		std::string ConfigFilename_;
 
+		//	Packets to the RADIUS servers only need to find their destination: a shared lock is enough.
+		std::shared_mutex DestinationsMutex_;
 		std::map<std::uint32_t, std::unique_ptr<RADIUS_Destination>> RADIUS_Destinations_;
 
 		struct RadiusPool {
@@ -194,7 +194,7 @@ namespace OpenWifi::RESTAPI_RPC {
 				fmt::format("{},{}: Completed in {:.3f}ms.", Cmd.UUID, RPCID, Cmd.executionTime));
 			return;
 		}
-		CommandManager()->RemovePendingCommand(RPCID);
+		CommandManager()->RemovePendingCommand(SerialNumberInt, RPCID);
 		if (RetryLater) {
 			Logger.information(fmt::format("{},{}: Pending completion.", Cmd.UUID, RPCID));
 			SetCommandStatus(Cmd, Request, Response, Handler,
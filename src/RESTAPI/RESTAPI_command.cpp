@@ -11,6 +11,7 @@
 #include "CommandManager.h"
 #include "StorageService.h"
 #include "framework/ow_constants.h"
+#include "framework/utils.h"
 
 namespace OpenWifi {
 	void RESTAPI_command::DoGet() {
@@ -41,7 +42,7 @@ namespace OpenWifi {
 			return NotFound();
 		}
 
-		CommandManager()->RemoveCommand(CommandUUID);
+		CommandManager()->RemoveCommand(Utils::SerialNumberToInt(C.SerialNumber), CommandUUID);
 		if (StorageService()->DeleteCommand(CommandUUID)) {
 			return OK();
 		}
@@ -18,13 +18,22 @@ namespace OpenWifi {
 		}
 
 		std::vector<GWObjects::CommandDetails> Commands;
+		SeekCursor Cursor;
+		if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+			return BadRequest(RESTAPI::Errors::InvalidCursor);
+		}
+		bool Seek = !QB_.Newest && (QB_.Offset == 0 || Cursor.Valid);
 		if (QB_.Newest) {
 			StorageService()->GetNewestCommands(SerialNumber, QB_.Limit, Commands);
 		} else {
 			StorageService()->GetCommands(SerialNumber, QB_.StartDate, QB_.EndDate, QB_.Offset,
-										  QB_.Limit, Commands);
+										  QB_.Limit, Commands, Seek ? &Cursor : nullptr);
 		}
-		return Object(RESTAPI::Protocol::COMMANDS, Commands);
+		Poco::JSON::Object Answer;
+		RESTAPI_utils::field_to_json(Answer, RESTAPI::Protocol::COMMANDS, Commands);
+		if (Seek && Cursor.Valid)
+			Answer.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
+		return ReturnObject(Answer);
 	}
 
 	void RESTAPI_commands::DoDelete() {
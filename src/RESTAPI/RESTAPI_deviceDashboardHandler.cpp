@@ -10,7 +10,7 @@ namespace OpenWifi {
 	void RESTAPI_deviceDashboardHandler::DoGet() {
 		poco_information(Logger(), fmt::format("GET-DASHBOARD: {}", Requester()));
 		GWObjects::Dashboard Data;
-		if (Daemon()->GetDashboard().Get(Data, Logger())) {
+		if (DeviceDashboard()->Get(Data)) {
 			return Object(Data);
 		}
 		return BadRequest(RESTAPI::Errors::InternalError);
@@ -264,6 +264,11 @@ namespace OpenWifi {
 		}
 
 		std::vector<GWObjects::Statistics> Stats;
+		SeekCursor Cursor;
+		if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+			return BadRequest(RESTAPI::Errors::InvalidCursor);
+		}
+		bool Seek = !QB_.Newest && (QB_.Offset == 0 || Cursor.Valid);
 		if (QB_.Newest) {
 			StorageService()->GetNewestStatisticsData(SerialNumber_, QB_.Limit, Stats);
 		} else {
@@ -277,7 +282,8 @@ namespace OpenWifi {
 				QB_.Limit = 100;
 
 			StorageService()->GetStatisticsData(SerialNumber_, QB_.StartDate, QB_.EndDate,
-												QB_.Offset, QB_.Limit, Stats);
+												QB_.Offset, QB_.Limit, Stats,
+												Seek ? &Cursor : nullptr);
 		}
 
 		Poco::JSON::Array::Ptr ArrayObj = Poco::SharedPtr<Poco::JSON::Array>(new Poco::JSON::Array);
@@ -291,6 +297,8 @@ namespace OpenWifi {
 		Poco::JSON::Object RetObj;
 		RetObj.set(RESTAPI::Protocol::DATA, ArrayObj);
 		RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+		if (Seek && Cursor.Valid)
+			RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 		return ReturnObject(RetObj);
 	}
 
@@ -327,11 +335,16 @@ namespace OpenWifi {
 				   fmt::format("GET-LOGS: TID={} user={} serial={}. thr_id={}", TransactionId_,
 							   Requester(), SerialNumber_, Poco::Thread::current()->id()));
 		std::vector<GWObjects::DeviceLog> Logs;
+		SeekCursor Cursor;
+		if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+			return BadRequest(RESTAPI::Errors::InvalidCursor);
+		}
+		bool Seek = !QB_.Newest && (QB_.Offset == 0 || Cursor.Valid);
 		if (QB_.Newest) {
 			StorageService()->GetNewestLogData(SerialNumber_, QB_.Limit, Logs, QB_.LogType);
 		} else {
 			StorageService()->GetLogData(SerialNumber_, QB_.StartDate, QB_.EndDate, QB_.Offset,
-										 QB_.Limit, Logs, QB_.LogType);
+										 QB_.Limit, Logs, QB_.LogType, Seek ? &Cursor : nullptr);
 		}
 
 		Poco::JSON::Array ArrayObj;
@@ -343,6 +356,8 @@ namespace OpenWifi {
 		Poco::JSON::Object RetObj;
 		RetObj.set(RESTAPI::Protocol::VALUES, ArrayObj);
 		RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+		if (Seek && Cursor.Valid)
+			RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 		ReturnObject(RetObj);
 	}
 
@@ -373,11 +388,17 @@ namespace OpenWifi {
 			}
 		} else {
 			std::vector<GWObjects::HealthCheck> Checks;
+			SeekCursor Cursor;
+			if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			}
+			bool Seek = !QB_.Newest && (QB_.Offset == 0 || Cursor.Valid);
 			if (QB_.Newest) {
 				StorageService()->GetNewestHealthCheckData(SerialNumber_, QB_.Limit, Checks);
 			} else {
 				StorageService()->GetHealthCheckData(SerialNumber_, QB_.StartDate, QB_.EndDate,
-													 QB_.Offset, QB_.Limit, Checks);
+													 QB_.Offset, QB_.Limit, Checks,
+													 Seek ? &Cursor : nullptr);
 			}
 
 			Poco::JSON::Array ArrayObj;
@@ -390,6 +411,8 @@ namespace OpenWifi {
 			Poco::JSON::Object RetObj;
 			RetObj.set(RESTAPI::Protocol::VALUES, ArrayObj);
 			RetObj.set(RESTAPI::Protocol::SERIALNUMBER, SerialNumber_);
+			if (Seek && Cursor.Valid)
+				RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 			ReturnObject(RetObj);
 		}
 	}
@@ -55,22 +55,17 @@ namespace OpenWifi {
 			std::set<std::string> Set;
 			std::vector<GWObjects::Device> Devices;
 
-			bool Done = false;
-			uint64_t Offset = 1;
-			while (!Done) {
-
-				StorageService()->GetDevices(Offset, 500, Devices);
+			SeekCursor Cursor;
+			do {
+				Devices.clear();
+				if (!StorageService()->GetDevices(0, 500, Devices, "", &Cursor))
+					break;
 				for (const auto &i : Devices) {
 					if (i.SerialNumber.substr(0, 6) == SerialNumber) {
 						Set.insert(i.SerialNumber);
 					}
 				}
-
-				if (Devices.size() < 500)
-					Done = true;
-
-				Offset += Devices.size();
-			}
+			} while (Cursor.Valid);
 
 			for (auto &i : Set) {
 				std::string SNum{i};
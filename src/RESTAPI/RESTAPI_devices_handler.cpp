@@ -123,12 +123,20 @@ namespace OpenWifi {
 			}
 		} else if (serialOnly) {
 			std::vector<std::string> SerialNumbers;
-			StorageService()->GetDeviceSerialNumbers(QB_.Offset, QB_.Limit, SerialNumbers, OrderBy);
+			SeekCursor Cursor;
+			if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			}
+			bool Seek = OrderBy.empty() && (QB_.Offset == 0 || Cursor.Valid);
+			StorageService()->GetDeviceSerialNumbers(QB_.Offset, QB_.Limit, SerialNumbers, OrderBy,
+													 Seek ? &Cursor : nullptr);
 			Poco::JSON::Array Objects;
 			for (const auto &i : SerialNumbers) {
 				Objects.add(i);
 			}
 			RetObj.set(RESTAPI::Protocol::SERIALNUMBERS, Objects);
+			if (Seek && Cursor.Valid)
+				RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 		} else if (GetBoolParameter("health")) {
 			auto lowLimit = GetParameter("lowLimit",30);
 			auto highLimit = GetParameter("highLimit",80);
@@ -141,7 +149,13 @@ namespace OpenWifi {
 			RetObj.set("serialNumbers", Objects);
 		} else {
 			std::vector<GWObjects::Device> Devices;
-			StorageService()->GetDevices(QB_.Offset, QB_.Limit, Devices, OrderBy);
+			SeekCursor Cursor;
+			if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+				return BadRequest(RESTAPI::Errors::InvalidCursor);
+			}
+			bool Seek = OrderBy.empty() && (QB_.Offset == 0 || Cursor.Valid);
+			StorageService()->GetDevices(QB_.Offset, QB_.Limit, Devices, OrderBy,
+										 Seek ? &Cursor : nullptr);
 			Poco::JSON::Array Objects;
 			for (const auto &i : Devices) {
 				Poco::JSON::Object Obj;
@@ -155,6 +169,8 @@ namespace OpenWifi {
 				RetObj.set(RESTAPI::Protocol::DEVICESWITHSTATUS, Objects);
 			else
 				RetObj.set(RESTAPI::Protocol::DEVICES, Objects);
+			if (Seek && Cursor.Valid)
+				RetObj.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 		}
 		ReturnObject(RetObj);
 	}
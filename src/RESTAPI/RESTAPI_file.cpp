@@ -13,30 +13,137 @@
 #include "StorageService.h"
 
 #include "framework/ow_constants.h"
+#include "fmt/format.h"
 #include <fstream>
 
 namespace OpenWifi {
+
+	static void FileTypeToMedia(const std::string &FileType, const std::string &UUID,
+								std::string &ContentType, std::string &Name) {
+		if (FileType == "pcap") {
+			ContentType = "application/vnd.tcpdump.pcap";
+			Name = UUID + ".pcap";
+		} else if (FileType == "tgz") {
+			ContentType = "application/gzip";
+			Name = UUID + ".tgz";
+		} else if (FileType == "txt") {
+			ContentType = "txt/plain";
+			Name = UUID + ".txt";
+		} else {
+			ContentType = "application/octet-stream";
+			Name = UUID + ".bin";
+		}
+	}
+
+	enum class RangeRequest { Ignored, Satisfiable, Unsatisfiable };
+
+	//	Only a single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range is supported.
+	//	Anything else is ignored and the whole file is sent; a range past the end cannot be served.
+	static RangeRequest ParseRange(const std::string &Range, std::uint64_t Size,
+								   std::uint64_t &First, std::uint64_t &Last) {
+		if (Range.compare(0, 6, "bytes=") != 0 || Range.find(',') != std::string::npos)
+			return RangeRequest::Ignored;
+		auto Dash = Range.find('-', 6);
+		if (Dash == std::string::npos)
+			return RangeRequest::Ignored;
+		auto From = Range.substr(6, Dash - 6);
+		auto To = Range.substr(Dash + 1);
+		try {
+			if (From.empty()) {
+				if (To.empty())
+					return RangeRequest::Ignored;
+				auto Suffix = std::min<std::uint64_t>(std::stoull(To), Size);
+				if (Suffix == 0)
+					return RangeRequest::Unsatisfiable;
+				First = Size - Suffix;
+				Last = Size - 1;
+			} else {
+				First = std::stoull(From);
+				if (!To.empty() && std::stoull(To) < First)
+					return RangeRequest::Ignored;
+				if (First >= Size)
+					return RangeRequest::Unsatisfiable;
+				Last = To.empty() ? Size - 1 : std::min<std::uint64_t>(std::stoull(To), Size - 1);
+			}
+		} catch (...) {
+			return RangeRequest::Ignored;
+		}
+		return RangeRequest::Satisfiable;
+	}
+
+	void RESTAPI_file::SendStoredFile(const std::string &Path, const std::string &ContentType,
+									  const std::string &Name) {
+		Poco::File F(Path);
+		if (!F.exists())
+			return NotFound();
+		std::uint64_t Size = F.getSize();
+
+		std::uint64_t First = 0, Last = 0;
+		auto Range = Request->has("Range")
+						 ? ParseRange(Request->get("Range"), Size, First, Last)
+						 : RangeRequest::Ignored;
+		if (Range == RangeRequest::Unsatisfiable) {
+			PrepareResponse(Poco::Net::HTTPResponse::HTTP_REQUESTED_RANGE_NOT_SATISFIABLE);
+			Response->set("Content-Range", fmt::format("bytes */{}", Size));
+			Response->setContentLength(0);
+			Response->send();
+			return;
+		}
+
+		Response->setStatus(Poco::Net::HTTPResponse::HTTPStatus::HTTP_OK);
+		SetCommonHeaders();
+		Response->set("Access-Control-Expose-Headers", "Content-Disposition");
+		Response->set("Content-Disposition", "attachment; filename=" + Name);
+		Response->set("Content-Transfer-Encoding", "binary");
+		Response->set("Accept-Ranges", "bytes");
+		Response->set("Cache-Control", "no-store");
+		Response->set("Expires", "Mon, 26 Jul 2027 05:00:00 GMT");
+
+		if (Range == RangeRequest::Ignored) {
+			Response->sendFile(Path, ContentType);
+			return;
+		}
+
+		std::ifstream InputStream(Path, std::ios::binary);
+		InputStream.seekg((std::streamoff)First);
+		Response->setStatus(Poco::Net::HTTPResponse::HTTPStatus::HTTP_PARTIAL_CONTENT);
+		Response->set("Content-Range", fmt::format("bytes {}-{}/{}", First, Last, Size));
+		Response->setContentType(ContentType);
+		Response->setContentLength64(Last - First + 1);
+		auto &OutputStream = Response->send();
+		char Chunk[64 << 10];
+		std::uint64_t Remaining = Last - First + 1;
+		while (Remaining > 0 && InputStream && OutputStream) {
+			InputStream.read(Chunk, (std::streamsize)std::min<std::uint64_t>(sizeof(Chunk), Remaining));
+			auto Read = InputStream.gcount();
+			if (Read <= 0)
+				break;
+			OutputStream.write(Chunk, Read);
+			Remaining -= Read;
+		}
+	}
+
 	void RESTAPI_file::DoGet() {
 		auto UUID = GetBinding(RESTAPI::Protocol::FILEUUID, "");
 		auto SerialNumber = GetParameter(RESTAPI::Protocol::SERIALNUMBER, "");
 
 		std::string FileType;
+		std::string FileName;
 		std::string FileContent;
-		if (!StorageService()->GetAttachedFileContent(UUID, SerialNumber, FileContent, FileType) || FileContent.empty()) {
+		if (!StorageService()->GetAttachedFile(UUID, SerialNumber, FileName, FileContent,
+											   FileType)) {
 			return NotFound();
 		}
-		if (FileType == "pcap") {
-			SendFileContent(FileContent, "application/vnd.tcpdump.pcap", UUID + ".pcap");
-		}
-		else if (FileType == "tgz" ) {
-			SendFileContent(FileContent, "application/gzip", UUID + ".tgz");
-		}
-		else if (FileType == "txt") {
-			SendFileContent(FileContent, "txt/plain", UUID + ".txt");
+
+		std::string ContentType, Name;
+		FileTypeToMedia(FileType, UUID, ContentType, Name);
+		if (!FileName.empty()) {
+			return SendStoredFile(FileUploader()->FilePath(FileName), ContentType, Name);
 		}
-		else {
-			SendFileContent(FileContent, "application/octet-stream", UUID + ".bin");
+		if (FileContent.empty()) {
+			return NotFound();
 		}
+		SendFileContent(FileContent, ContentType, Name);
 	}
 
 	void RESTAPI_file::DoDelete() {
@@ -25,5 +25,9 @@ namespace OpenWifi {
 		void DoDelete() final;
 		void DoPost() final{};
 		void DoPut() final{};
+
+	  private:
+		void SendStoredFile(const std::string &Path, const std::string &ContentType,
+							const std::string &Name);
 	};
 } // namespace OpenWifi
@@ -11,9 +11,20 @@ namespace OpenWifi {
 	void RESTAPI_scripts_handler::DoGet() {
 		GWObjects::ScriptEntryList L;
 
-		StorageService()->ScriptDB().GetRecords(QB_.Offset, QB_.Limit, L.scripts);
+		SeekCursor Cursor;
+		if (!QB_.Cursor.empty() && !Cursor.FromToken(QB_.Cursor)) {
+			return BadRequest(RESTAPI::Errors::InvalidCursor);
+		}
+		if (QB_.Offset == 0 || Cursor.Valid) {
+			StorageService()->ScriptDB().GetRecordsAfter(Cursor.Key, QB_.Limit, L.scripts);
+			Cursor.Valid = !L.scripts.empty() && L.scripts.size() >= QB_.Limit;
+		} else {
+			StorageService()->ScriptDB().GetRecords(QB_.Offset, QB_.Limit, L.scripts);
+		}
 		Poco::JSON::Object Answer;
 		L.to_json(Answer);
+		if (Cursor.Valid)
+			Answer.set(RESTAPI::Protocol::NEXTCURSOR, Cursor.Token());
 		return ReturnObject(Answer);
 	}
 
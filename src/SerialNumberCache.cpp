@@ -8,6 +8,8 @@
 #include "StorageService.h"
 #include "framework/utils.h"
 
+#include "fmt/format.h"
+
 namespace OpenWifi {
 
 	int SerialNumberCache::Start() {
@@ -18,16 +20,18 @@ namespace OpenWifi {
 
 	void SerialNumberCache::Stop() {
 		poco_notice(Logger(), "Stopping...");
+		std::unique_lock G(CacheMutex_);
+		SNSet_.clear();
 		SNs_.clear();
 		Reverse_SNs_.clear();
 		poco_notice(Logger(), "Stopped...");
 	}
 
 	void SerialNumberCache::AddSerialNumber(const std::string &S) {
-		std::lock_guard G(Mutex_);
-
 		uint64_t SN = std::stoull(S, nullptr, 16);
-		if (std::find(std::begin(SNs_), std::end(SNs_), SN) == std::end(SNs_)) {
+		std::unique_lock G(CacheMutex_);
+
+		if (SNSet_.insert(SN).second) {
 			auto insert_point = std::lower_bound(SNs_.begin(), SNs_.end(), SN);
 			SNs_.insert(insert_point, SN);
 
@@ -38,18 +42,45 @@ namespace OpenWifi {
 		}
 	}
 
-	void SerialNumberCache::DeleteSerialNumber(const std::string &S) {
-		std::lock_guard G(Mutex_);
+	void SerialNumberCache::LoadSerialNumbers(const std::vector<std::string> &SerialNumbers) {
+		std::vector<uint64_t> SNs, Reverse_SNs;
+		SNs.reserve(SerialNumbers.size());
+		Reverse_SNs.reserve(SerialNumbers.size());
+		for (const auto &S : SerialNumbers) {
+			try {
+				SNs.push_back(std::stoull(S, nullptr, 16));
+				Reverse_SNs.push_back(std::stoull(ReverseSerialNumber(S), nullptr, 16));
+			} catch (...) {
+				poco_warning(Logger(), fmt::format("Invalid serial number '{}' ignored.", S));
+			}
+		}
 
+		std::sort(SNs.begin(), SNs.end());
+		SNs.erase(std::unique(SNs.begin(), SNs.end()), SNs.end());
+		std::sort(Reverse_SNs.begin(), Reverse_SNs.end());
+		Reverse_SNs.erase(std::unique(Reverse_SNs.begin(), Reverse_SNs.end()), Reverse_SNs.end());
+		std::unordered_set<uint64_t> SNSet(SNs.begin(), SNs.end());
+
+		std::unique_lock G(CacheMutex_);
+		SNSet_.swap(SNSet);
+		SNs_.swap(SNs);
+		Reverse_SNs_.swap(Reverse_SNs);
+	}
+
+	void SerialNumberCache::DeleteSerialNumber(const std::string &S) {
 		uint64_t SN = std::stoull(S, nullptr, 16);
-		auto It = std::find(SNs_.begin(), SNs_.end(), SN);
-		if (It != SNs_.end()) {
-			SNs_.erase(It);
+		std::unique_lock G(CacheMutex_);
+
+		if (SNSet_.erase(SN)) {
+			auto It = std::lower_bound(SNs_.begin(), SNs_.end(), SN);
+			if (It != SNs_.end() && *It == SN) {
+				SNs_.erase(It);
+			}
 
 			auto R = ReverseSerialNumber(S);
 			uint64_t RSN = std::stoull(R, nullptr, 16);
-			auto RIt = std::find(Reverse_SNs_.begin(), Reverse_SNs_.end(), RSN);
-			if (RIt != Reverse_SNs_.end()) {
+			auto RIt = std::lower_bound(Reverse_SNs_.begin(), Reverse_SNs_.end(), RSN);
+			if (RIt != Reverse_SNs_.end() && *RIt == RSN) {
 				Reverse_SNs_.erase(RIt);
 			}
 		}
@@ -69,13 +100,12 @@ namespace OpenWifi {
 	void SerialNumberCache::ReturnNumbers(const std::string &S, uint HowMany,
 										  const std::vector<uint64_t> &SNArr,
 										  std::vector<uint64_t> &A, bool ReverseResult) {
-		std::lock_guard G(Mutex_);
+		std::shared_lock G(CacheMutex_);
 
 		if (S.length() == 12) {
 			uint64_t SN = std::stoull(S, nullptr, 16);
-			auto It = std::find(SNArr.begin(), SNArr.end(), SN);
-			if (It != SNArr.end()) {
-				A.push_back(ReverseResult ? Reverse(*It) : *It);
+			if (std::binary_search(SNArr.begin(), SNArr.end(), SN)) {
+				A.push_back(ReverseResult ? Reverse(SN) : SN);
 			}
 		} else if (S.length() < 12) {
 			std::string SS{S};
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <shared_mutex>
+#include <unordered_set>
+
 #include "framework/SubSystemServer.h"
 
 namespace OpenWifi {
@@ -17,11 +20,13 @@ namespace OpenWifi {
 		int Start() override;
 		void Stop() override;
 		void AddSerialNumber(const std::string &SerialNumber);
+		//	Replaces the whole cache content. Sorts once instead of inserting one by one.
+		void LoadSerialNumbers(const std::vector<std::string> &SerialNumbers);
 		void DeleteSerialNumber(const std::string &SerialNumber);
 		void FindNumbers(const std::string &SerialNumber, uint HowMany, std::vector<uint64_t> &A);
 		inline bool NumberExists(uint64_t SerialNumber) {
-			std::lock_guard G(Mutex_);
-			return std::find(SNs_.begin(), SNs_.end(), SerialNumber) != SNs_.end();
+			std::shared_lock G(CacheMutex_);
+			return SNSet_.find(SerialNumber) != SNSet_.end();
 		}
 
 		static inline std::string ReverseSerialNumber(const std::string &S) {
@@ -31,6 +36,8 @@ namespace OpenWifi {
 		}
 
 	  private:
+		mutable std::shared_mutex CacheMutex_;
+		std::unordered_set<uint64_t> SNSet_;
 		std::vector<uint64_t> SNs_;
 		std::vector<uint64_t> Reverse_SNs_;
 
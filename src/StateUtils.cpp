@@ -2,8 +2,11 @@
 // Created by stephane bourque on 2022-01-18.
 //
 
+#include <sstream>
+
 #include "StateUtils.h"
 #include "Poco/JSON/Parser.h"
+#include "Poco/JSON/Stringifier.h"
 
 namespace OpenWifi::StateUtils {
 
@@ -95,4 +98,61 @@ namespace OpenWifi::StateUtils {
 		}
 		return false;
 	}
+
+	void ExtractUnitStatistics(const Poco::JSON::Object::Ptr &State, UnitStatistics &Stats) {
+		Stats = UnitStatistics{};
+		try {
+			Stats.hasGPS = State->isObject("gps");
+			if (!State->isObject("unit"))
+				return;
+			auto Unit = State->getObject("unit");
+			if (Unit->has("uptime")) {
+				Stats.uptime = Unit->get("uptime");
+				Stats.hasUptime = true;
+			}
+			if (Unit->isObject("memory")) {
+				auto Memory = Unit->getObject("memory");
+				Stats.memoryTotal = Memory->get("total");
+				Stats.memoryFree = Memory->get("free");
+				Stats.hasMemory = true;
+			}
+			if (Unit->isArray("load")) {
+				auto Load = Unit->getArray("load");
+				if (Load->size() > 2) {
+					for (std::size_t i = 0; i < 3; i++)
+						Stats.load[i] = Load->getElement<uint64_t>(i);
+					Stats.hasLoad = true;
+				}
+			}
+			if (Unit->isArray("temperature")) {
+				auto Temperature = Unit->getArray("temperature");
+				if (Temperature->size() > 0) {
+					Stats.temperature = Temperature->get(0);
+					Stats.hasTemperature = true;
+				}
+			}
+		} catch (...) {
+		}
+	}
+
+	std::string StringifyWithSerializedMember(const Poco::JSON::Object::Ptr &Obj,
+											  const std::string &Member,
+											  const std::string &SerializedMember) {
+		std::ostringstream OS;
+		OS << '{';
+		bool First = true;
+		for (const auto &[Name, Value] : *Obj) {
+			if (!First)
+				OS << ',';
+			First = false;
+			Poco::JSON::Stringifier::stringify(Poco::Dynamic::Var(Name), OS);
+			OS << ':';
+			if (Name == Member)
+				OS << SerializedMember;
+			else
+				Poco::JSON::Stringifier::stringify(Value, OS);
+		}
+		OS << '}';
+		return OS.str();
+	}
 } // namespace OpenWifi::StateUtils
\ No newline at end of file
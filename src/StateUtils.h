@@ -4,9 +4,33 @@
 
 #pragma once
 
+#include <cmath>
+#include <string>
+
 #include "Poco/JSON/Object.h"
 
 namespace OpenWifi::StateUtils {
 	bool ComputeAssociations(const Poco::JSON::Object::Ptr RawObject, uint64_t &Radios_2G,
 							 uint64_t &Radios_5G, uint64_t &Radio_6G);
-}
\ No newline at end of file
+
+	//	The values of the "unit" section of a state message, extracted once per message.
+	struct UnitStatistics {
+		bool hasGPS = false;
+		bool hasUptime = false;
+		std::uint64_t uptime = 0;
+		bool hasMemory = false;
+		std::uint64_t memoryTotal = 0, memoryFree = 0;
+		bool hasLoad = false;
+		std::uint64_t load[3]{0, 0, 0};
+		bool hasTemperature = false;
+		std::double_t temperature = 0.0;
+	};
+
+	void ExtractUnitStatistics(const Poco::JSON::Object::Ptr &State, UnitStatistics &Stats);
+
+	//	Stringify an object when one of its members has already been serialized, so that member
+	//	is not serialized a second time.
+	std::string StringifyWithSerializedMember(const Poco::JSON::Object::Ptr &Obj,
+											  const std::string &Member,
+											  const std::string &SerializedMember);
+}
@@ -18,22 +18,30 @@ namespace OpenWifi {
 	void Archiver::onTimer([[maybe_unused]] Poco::Timer &timer) {
 		Utils::SetThreadName("strg-archiver");
 		auto now = Utils::Now();
+		StorageService()->CreateTimePartitions();
 		for (const auto &[DBName, Keep] : DBs_) {
+			if (!Running_)
+				break;
+			auto Cutoff = now - (Keep * 24 * 60 * 60);
 			if (!Poco::icompare(DBName, "healthchecks")) {
 				poco_information(Logger(), "Archiving HealthChecks...");
-				StorageService()->RemoveHealthChecksRecordsOlderThan(now - (Keep * 24 * 60 * 60));
+				StorageService()->RemoveHealthChecksRecordsOlderThan(Cutoff, Budget(DBName));
+				Report(true);
 			} else if (!Poco::icompare(DBName, "statistics")) {
 				poco_information(Logger(), "Archiving Statistics...");
-				StorageService()->RemoveStatisticsRecordsOlderThan(now - (Keep * 24 * 60 * 60));
+				StorageService()->RemoveStatisticsRecordsOlderThan(Cutoff, Budget(DBName));
+				Report(true);
 			} else if (!Poco::icompare(DBName, "devicelogs")) {
 				poco_information(Logger(), "Archiving Device Logs...");
-				StorageService()->RemoveDeviceLogsRecordsOlderThan(now - (Keep * 24 * 60 * 60));
+				StorageService()->RemoveDeviceLogsRecordsOlderThan(Cutoff, Budget(DBName));
+				Report(true);
 			} else if (!Poco::icompare(DBName, "commandlist")) {
 				poco_information(Logger(), "Archiving Command History...");
-				StorageService()->RemoveCommandListRecordsOlderThan(now - (Keep * 24 * 60 * 60));
+				StorageService()->RemoveCommandListRecordsOlderThan(Cutoff, Budget(DBName));
+				Report(true);
 			} else if (!Poco::icompare(DBName, "fileuploads")) {
 				poco_information(Logger(), "Archiving Upload files...");
-				StorageService()->RemoveUploadedFilesRecordsOlderThan(now - (Keep * 24 * 60 * 60));
+				StorageService()->RemoveUploadedFilesRecordsOlderThan(Cutoff);
 			} else {
 				poco_information(Logger(), fmt::format("Cannot archive DB '{}'", DBName));
 			}
@@ -41,6 +49,40 @@ namespace OpenWifi {
 		AppServiceRegistry().Set("lastStorageArchiverRun", (uint64_t)now);
 	}
 
+	RetentionBudget Archiver::Budget(const std::string &DBName) {
+		CurrentDB_ = DBName;
+		Removed_ = 0;
+		Started_ = LastReport_ = std::chrono::steady_clock::now();
+		return RetentionBudget{BatchSize_, [this](std::uint64_t Deleted) { return Pace(Deleted); }};
+	}
+
+	//	Sleeps until the rows removed so far fit in the budget. Returns false when stopping.
+	bool Archiver::Pace(std::uint64_t Deleted) {
+		Removed_ += Deleted;
+		if (std::chrono::steady_clock::now() - LastReport_ > std::chrono::seconds(10))
+			Report(false);
+		if (RowsPerSecond_ == 0)
+			return Running_;
+		auto Due = Started_ + std::chrono::milliseconds(Removed_ * 1000 / RowsPerSecond_);
+		while (Running_) {
+			auto Left = std::chrono::duration_cast<std::chrono::milliseconds>(
+				Due - std::chrono::steady_clock::now());
+			if (Left.count() <= 0)
+				break;
+			Poco::Thread::sleep((long)std::min<std::int64_t>(Left.count(), 250));
+		}
+		return Running_;
+	}
+
+	void Archiver::Report(bool Done) {
+		LastReport_ = std::chrono::steady_clock::now();
+		auto Elapsed = std::chrono::duration<double>(LastReport_ - Started_).count();
+		poco_information(Logger(),
+						 fmt::format("{} {}: {} rows removed in {:.1f}s ({:.0f} rows/s).",
+									 Done ? "Archived" : "Archiving", CurrentDB_, Removed_, Elapsed,
+									 Elapsed > 0.0 ? Removed_ / Elapsed : 0.0));
+	}
+
 	static auto CalculateDelta(std::uint64_t H, std::uint64_t M) {
 		Poco::LocalDateTime dt;
 		Poco::LocalDateTime scheduled(dt.year(), dt.month(), dt.day(), (int)H, (int)M, 0);
@@ -63,7 +105,10 @@ namespace OpenWifi {
 			return 0;
 		}
 
-		Archiver_ = std::make_unique<Archiver>(Logger());
+		auto BatchSize = MicroServiceConfigGetInt("archiver.batchsize", 1000);
+		auto RowsPerSecond = MicroServiceConfigGetInt("archiver.rowspersecond", 10000);
+		Archiver_ = std::make_unique<Archiver>(Logger(), BatchSize == 0 ? 1 : BatchSize,
+											   RowsPerSecond);
 		ArchiverCallback_ =
 			std::make_unique<Poco::TimerCallback<Archiver>>(*Archiver_, &Archiver::onTimer);
 
@@ -107,6 +152,7 @@ namespace OpenWifi {
 	void StorageArchiver::Stop() {
 		poco_information(Logger(), "Stopping...");
 		if (Enabled_) {
+			Archiver_->Stop();
 			Timer_.stop();
 		}
 		poco_information(Logger(), "Stopped...");
@@ -4,11 +4,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <list>
 
 #include "Poco/Timer.h"
 
+#include "StorageService.h"
 #include "framework/SubSystemServer.h"
 
 namespace OpenWifi {
@@ -16,9 +19,15 @@ namespace OpenWifi {
 	static const std::list<std::string> AllInternalDBNames{
 		"healthchecks", "statistics", "devicelogs", "commandlist", "fileuploads"};
 
+	/*
+	 * 	Old rows are removed in batches of BatchSize. When RowsPerSecond is not 0, the archiver
+	 * sleeps between batches so that a run never removes more than that many rows per second.
+	 */
 	class Archiver {
 	  public:
-		explicit Archiver(Poco::Logger &Logger) : Logger_(Logger) {
+		explicit Archiver(Poco::Logger &Logger, std::uint64_t BatchSize,
+						  std::uint64_t RowsPerSecond)
+			: Logger_(Logger), BatchSize_(BatchSize), RowsPerSecond_(RowsPerSecond) {
 			for (const auto &db : AllInternalDBNames) {
 				DBs_[db] = 7;
 			}
@@ -28,11 +37,23 @@ namespace OpenWifi {
 		inline void AddDb(const std::string &dbname, std::uint64_t retain) {
 			DBs_[dbname] = retain;
 		}
+		inline void Stop() { Running_ = false; }
 		inline Poco::Logger &Logger() { return Logger_; }
 
 	  private:
 		Poco::Logger &Logger_;
 		std::map<std::string, std::uint64_t> DBs_;
+		std::atomic_bool Running_ = true;
+		std::uint64_t BatchSize_ = 1000;
+		std::uint64_t RowsPerSecond_ = 0;
+
+		std::string CurrentDB_;
+		std::uint64_t Removed_ = 0;
+		std::chrono::steady_clock::time_point Started_, LastReport_;
+
+		RetentionBudget Budget(const std::string &DBName);
+		bool Pace(std::uint64_t Deleted);
+		void Report(bool Done);
 	};
 
 	class StorageArchiver : public SubSystemServer {
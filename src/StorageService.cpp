@@ -6,21 +6,74 @@
 //	Arilia Wireless Inc.
 //
 
+#include "CapabilitiesCache.h"
 #include "StorageService.h"
+#include "framework/MicroServiceFuncs.h"
+
+#include "Poco/Base64Decoder.h"
+#include "Poco/Base64Encoder.h"
+#include "Poco/NumberParser.h"
+#include "Poco/StreamCopier.h"
 
 namespace OpenWifi {
 
+	//	Tokens are opaque to clients: "Recorded:Key", base64url encoded.
+	std::string SeekCursor::Token() const {
+		if (!Valid)
+			return "";
+		std::ostringstream OS;
+		Poco::Base64Encoder Encoder(OS, Poco::BASE64_URL_ENCODING | Poco::BASE64_NO_PADDING);
+		Encoder.rdbuf()->setLineLength(0);
+		Encoder << Recorded << ':' << Key;
+		Encoder.close();
+		return OS.str();
+	}
+
+	bool SeekCursor::FromToken(const std::string &Token) {
+		try {
+			std::istringstream IS(Token);
+			Poco::Base64Decoder Decoder(IS, Poco::BASE64_URL_ENCODING | Poco::BASE64_NO_PADDING);
+			std::string Decoded;
+			Poco::StreamCopier::copyToString(Decoder, Decoded);
+
+			auto First = Decoded.find(':');
+			if (First == std::string::npos)
+				return false;
+			if (!Poco::NumberParser::tryParseUnsigned64(Decoded.substr(0, First), Recorded))
+				return false;
+			Key = Decoded.substr(First + 1);
+			Valid = true;
+			return true;
+		} catch (const Poco::Exception &) {
+		}
+		return false;
+	}
+
 	int Storage::Start() {
 		std::lock_guard Guard(Mutex_);
 		StorageClass::Start();
 
+		Partitioned_ = dbType_ == pgsql &&
+					   MicroServiceConfigGetBool("storage.type.postgresql.partitioned", false);
+		PartitionsAhead_ = MicroServiceConfigGetInt("storage.type.postgresql.partitions.ahead", 7);
 		Create_Tables();
+		CreateTimePartitions();
 		InitializeBlackListCache();
 
+		auto DeviceCacheSize = MicroServiceConfigGetInt("storage.devicecache.size", 32768);
+		auto DeviceCacheTTL = MicroServiceConfigGetInt("storage.devicecache.ttl", 120);
+		if (DeviceCacheSize > 0 && DeviceCacheTTL > 0) {
+			DeviceCache_ = std::make_unique<Poco::ExpireLRUCache<std::string, GWObjects::Device>>(
+				DeviceCacheSize, DeviceCacheTTL * 1000);
+			CapabilitiesHashes_ = std::make_unique<Poco::ExpireLRUCache<std::string, std::size_t>>(
+				DeviceCacheSize, DeviceCacheTTL * 1000);
+		}
+
 		ScriptDB_ =
 			std::make_unique<OpenWifi::ScriptDB>("Scripts", "scr", dbType_, *Pool_, Logger());
 		ScriptDB_->Create();
 		ScriptDB_->Initialize();
+		CapabilitiesCache()->Start();
 
 		return 0;
 	}
@@ -28,6 +81,7 @@ namespace OpenWifi {
 	void Storage::Stop() {
 		std::lock_guard Guard(Mutex_);
 		poco_notice(Logger(), "Stopping...");
+		CapabilitiesCache()->Stop();
 		StorageClass::Stop();
 		poco_notice(Logger(), "Stopped...");
 	}
@@ -8,14 +8,41 @@
 
 #pragma once
 
+#include <array>
+#include <functional>
+#include <mutex>
+
 #include "CentralConfig.h"
+#include "Poco/ExpireLRUCache.h"
 #include "Poco/Net/IPAddress.h"
+#include "Poco/NumberParser.h"
 #include "RESTObjects//RESTAPI_GWobjects.h"
 #include "framework/StorageClass.h"
 #include "storage/storage_scripts.h"
 
+#include "fmt/format.h"
+
 namespace OpenWifi {
 
+	//	Rows are removed BatchSize at a time. Progress is called after every batch with the number
+	//	of rows it removed: it may pace the caller, and returning false ends the run.
+	struct RetentionBudget {
+		std::uint64_t BatchSize = 1000;
+		std::function<bool(std::uint64_t Deleted)> Progress;
+	};
+
+	//	Position after the last row of a keyset page: the last Recorded (or Submitted) value and the
+	//	unique key that breaks ties on it. Time series use their row id as the key. Valid is false
+	//	before the first page and after the last.
+	struct SeekCursor {
+		bool Valid = false;
+		std::uint64_t Recorded = 0;
+		std::string Key;
+
+		[[nodiscard]] std::string Token() const;
+		bool FromToken(const std::string &Token);
+	};
+
 	class Storage : public StorageClass {
 
 	  public:
@@ -64,25 +91,23 @@ namespace OpenWifi {
 			return " LIMIT " + std::to_string(HowMany) + " OFFSET " + std::to_string(From) + " ";
 		}
 
-		inline std::string ConvertParams(const std::string &S) const {
+		//	Builds "(?,?),(?,?),..." for a multi-row INSERT of Rows rows.
+		static inline std::string MultiRowValues(const std::string &RowValues, std::size_t Rows) {
 			std::string R;
-			R.reserve(S.size() * 2 + 1);
-			if (dbType_ == pgsql) {
-				auto Idx = 1;
-				for (auto const &i : S) {
-					if (i == '?') {
-						R += '$';
-						R.append(std::to_string(Idx++));
-					} else {
-						R += i;
-					}
-				}
-			} else {
-				R = S;
+			R.reserve((RowValues.size() + 3) * Rows);
+			for (std::size_t i = 0; i < Rows; ++i) {
+				if (i)
+					R += ',';
+				R += '(';
+				R += RowValues;
+				R += ')';
 			}
 			return R;
 		}
 
+		//	Number of rows written per multi-row INSERT statement.
+		static constexpr std::size_t MultiRowInsertSize = 100;
+
 		static auto instance() {
 			static auto instance_ = new Storage;
 			return instance_;
@@ -91,10 +116,14 @@ namespace OpenWifi {
 		// typedef std::map<std::string,std::string>	DeviceCapabilitiesCache;
 
 		bool AddLog(const GWObjects::DeviceLog &Log);
+		bool AddLog(const std::vector<GWObjects::DeviceLog> &Logs, std::uint64_t &Written);
 		bool AddStatisticsData(const GWObjects::Statistics &Stats);
+		bool AddStatisticsData(const std::vector<GWObjects::Statistics> &Stats,
+							   std::uint64_t &Written);
 		bool GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							   uint64_t Offset, uint64_t HowMany,
-							   std::vector<GWObjects::Statistics> &Stats);
+							   std::vector<GWObjects::Statistics> &Stats,
+							   SeekCursor *Cursor = nullptr);
 		bool GetNumberOfStatisticsDataRecords(std::string &SerialNumber, uint64_t FromDate,
 											  uint64_t ToDate, std::uint64_t &Count);
 		bool DeleteStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
@@ -102,9 +131,12 @@ namespace OpenWifi {
 									 std::vector<GWObjects::Statistics> &Stats);
 
 		bool AddHealthCheckData(const GWObjects::HealthCheck &Check);
+		bool AddHealthCheckData(const std::vector<GWObjects::HealthCheck> &Checks,
+								std::uint64_t &Written);
 		bool GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 								uint64_t Offset, uint64_t HowMany,
-								std::vector<GWObjects::HealthCheck> &Checks);
+								std::vector<GWObjects::HealthCheck> &Checks,
+								SeekCursor *Cursor = nullptr);
 		bool DeleteHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
 		bool GetNewestHealthCheckData(std::string &SerialNumber, uint64_t HowMany,
 									  std::vector<GWObjects::HealthCheck> &Checks);
@@ -124,7 +156,7 @@ namespace OpenWifi {
 
 		bool GetDevice(std::string &SerialNumber, GWObjects::Device &);
 		bool GetDevices(uint64_t From, uint64_t HowMany, std::vector<GWObjects::Device> &Devices,
-						const std::string &orderBy = "");
+						const std::string &orderBy = "", SeekCursor *Cursor = nullptr);
 		//		bool GetDevices(uint64_t From, uint64_t HowMany, const std::string & Select,
 		// std::vector<GWObjects::Device> &Devices, const std::string & orderBy="");
 		bool DeleteDevice(std::string &SerialNumber);
@@ -137,7 +169,8 @@ namespace OpenWifi {
 		bool GetDeviceCount(uint64_t &Count);
 		bool GetDeviceSerialNumbers(uint64_t From, uint64_t HowMany,
 									std::vector<std::string> &SerialNumbers,
-									const std::string &orderBy = "");
+									const std::string &orderBy = "",
+									SeekCursor *Cursor = nullptr);
 		bool GetDeviceFWUpdatePolicy(std::string &SerialNumber, std::string &Policy);
 		bool SetDevicePassword(std::string &SerialNumber, std::string &Password);
 		bool UpdateSerialNumberCache();
@@ -156,7 +189,7 @@ namespace OpenWifi {
 
 		bool GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						uint64_t Offset, uint64_t HowMany, std::vector<GWObjects::DeviceLog> &Stats,
-						uint64_t Type);
+						uint64_t Type, SeekCursor *Cursor = nullptr);
 		bool DeleteLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						   uint64_t Type);
 		bool GetNewestLogData(std::string &SerialNumber, uint64_t HowMany,
@@ -192,25 +225,26 @@ namespace OpenWifi {
 						CommandExecutionType Type);
 		bool GetCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 						 uint64_t Offset, uint64_t HowMany,
-						 std::vector<GWObjects::CommandDetails> &Commands);
+						 std::vector<GWObjects::CommandDetails> &Commands,
+						 SeekCursor *Cursor = nullptr);
 		bool DeleteCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate);
 		bool GetNonExecutedCommands(uint64_t Offset, uint64_t HowMany,
 									std::vector<GWObjects::CommandDetails> &Commands);
 		bool UpdateCommand(std::string &UUID, GWObjects::CommandDetails &Command);
 		bool GetCommand(const std::string &UUID, GWObjects::CommandDetails &Command);
 		bool DeleteCommand(std::string &UUID);
-		bool GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
-									   std::vector<GWObjects::CommandDetails> &Commands);
+		bool GetPendingCommands(std::vector<GWObjects::CommandDetails> &Commands);
 		bool CommandExecuted(std::string &UUID);
 		bool SetCommandLastTry(std::string &UUID);
 		bool CommandCompleted(std::string &UUID, Poco::JSON::Object::Ptr ReturnVars,
 							  const std::chrono::duration<double, std::milli> &execution_time,
 							  bool FullCommand);
-		bool AttachFileDataToCommand(std::string &UUID, const std::stringstream &s,
-									 const std::string &Type);
+		bool AttachFileDataToCommand(std::string &UUID, const std::string &FileName,
+									 std::uint64_t Size, const std::string &Type);
 		bool CancelWaitFile(std::string &UUID, std::string &ErrorText);
-		bool GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-									std::string &FileContent, std::string &Type);
+		void ReleaseStoredFile(const std::string &FileName);
+		bool GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+							 std::string &FileName, std::string &FileContent, std::string &Type);
 		bool RemoveAttachedFile(std::string &UUID);
 		bool SetCommandResult(std::string &UUID, std::string &Result);
 		bool GetNewestCommands(std::string &SerialNumber, uint64_t HowMany,
@@ -239,12 +273,16 @@ namespace OpenWifi {
 
 		bool DeleteSimulatedDevice(const std::string &SerialNumber);
 
-		bool RemoveHealthChecksRecordsOlderThan(uint64_t Date);
-		bool RemoveDeviceLogsRecordsOlderThan(uint64_t Date);
-		bool RemoveStatisticsRecordsOlderThan(uint64_t Date);
-		bool RemoveCommandListRecordsOlderThan(uint64_t Date);
+		bool RemoveHealthChecksRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget);
+		bool RemoveDeviceLogsRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget);
+		bool RemoveStatisticsRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget);
+		bool RemoveCommandListRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget);
 		bool RemoveUploadedFilesRecordsOlderThan(uint64_t Date);
 
+		bool RemoveRecordsOlderThan(const std::string &Table, const std::string &Column,
+									uint64_t Date, const RetentionBudget &Budget);
+		void CreateTimePartitions();
+
 		bool SetDeviceLastRecordedContact(std::string & SeialNumber, std::uint64_t lastRecordedContact);
 
 		int Create_Tables();
@@ -258,15 +296,87 @@ namespace OpenWifi {
 		int Create_BlackList();
 		int Create_FileUploads();
 		int Create_DefaultFirmwares();
+		void Create_TimeIndex(const std::string &Index, const std::string &Table,
+							  const std::string &Column);
+		[[nodiscard]] std::string PartitionClause() const;
+		[[nodiscard]] std::string TimeSeriesIdColumn() const;
+		void Upgrade_TimeSeriesId(const std::string &Table, const std::string &Index);
 
 		bool AnalyzeCommands(Types::CountedMap &R);
-		bool AnalyzeDevices(GWObjects::Dashboard &D);
+		bool GetDeviceInventory(std::vector<std::pair<std::string, std::string>> &Devices);
 
 		int Start() override;
 		void Stop() override;
 
 	  private:
 		std::unique_ptr<OpenWifi::ScriptDB> ScriptDB_;
+
+		void ReleaseStoredFiles(Poco::Data::Session &Sess, const std::vector<std::string> &FileNames);
+
+		/*
+		 * 	Keyset paging: a page starts where the cursor left off instead of counting rows from the
+		 * top. Time series have no natural key, so they seek on (Recorded, row id): SQLite's rowid,
+		 * or the Id column the other databases add to Statistics, HealthChecks and DeviceLogs.
+		 * A cursor whose key is not a number throws SyntaxException, which fails the query.
+		 */
+		[[nodiscard]] inline std::string RowIdColumn() const {
+			return dbType_ == sqlite ? "rowid" : "Id";
+		}
+
+		[[nodiscard]] inline std::string SeekAfter(const SeekCursor *Cursor, bool HasWhere,
+												   bool Descending) const {
+			if (Cursor == nullptr || !Cursor->Valid)
+				return "";
+			auto LastId = Poco::NumberParser::parseUnsigned64(Cursor->Key);
+			auto Recorded = std::to_string(Cursor->Recorded);
+			const char *Op = Descending ? "<" : ">";
+			return fmt::format("{}(Recorded{}{} OR (Recorded={} AND {}{}{}))",
+							   HasWhere ? " AND " : " WHERE ", Op, Recorded, Recorded,
+							   RowIdColumn(), Op, LastId);
+		}
+
+		[[nodiscard]] inline std::string SeekOrder(bool Descending) const {
+			return Descending ? " ORDER BY Recorded DESC, " + RowIdColumn() + " DESC "
+							  : " ORDER BY Recorded ASC, " + RowIdColumn() + " ASC ";
+		}
+
+		template <typename T>
+		static void AdvanceCursor(SeekCursor &Cursor, const std::vector<T> &Rows,
+								  const std::vector<std::uint64_t> &Ids, uint64_t HowMany) {
+			Cursor.Valid = !Rows.empty() && Rows.size() >= HowMany && Ids.size() == Rows.size();
+			if (Cursor.Valid) {
+				Cursor.Recorded = Rows.back().Recorded;
+				Cursor.Key = std::to_string(Ids.back());
+			}
+		}
+
+		/*
+		 * 	On PostgreSQL, Statistics, HealthChecks and DeviceLogs may be created partitioned by day
+		 * on Recorded. Retention then drops whole partitions and only deletes rows from the partition
+		 * that straddles the cut-off. Tables that already exist unpartitioned are left as they are.
+		 */
+		bool Partitioned_ = false;
+		std::uint64_t PartitionsAhead_ = 7;
+		bool TablePartitioned(Poco::Data::Session &Sess, const std::string &Table);
+		std::vector<std::string> TablePartitions(Poco::Data::Session &Sess, const std::string &Table);
+		std::uint64_t DropPartitionsOlderThan(Poco::Data::Session &Sess, const std::string &Table,
+											  uint64_t Date);
+
+		/*
+		 * 	Device records are cached on read and dropped by every write to the Devices table. Each
+		 * shard counts its writes: a read only fills the cache when no write to that shard happened
+		 * while it was reading, so an older record never replaces a newer one. Entries expire after
+		 * a short time to bound staleness when several gateways share the database.
+		 */
+		std::unique_ptr<Poco::ExpireLRUCache<std::string, GWObjects::Device>> DeviceCache_;
+		std::array<std::mutex, 256> DeviceCacheMutex_;
+		std::array<std::uint64_t, 256> DeviceCacheGeneration_{};
+		//	Hash of the capabilities last stored for a device, to skip rewriting identical ones.
+		std::unique_ptr<Poco::ExpireLRUCache<std::string, std::size_t>> CapabilitiesHashes_;
+
+		bool LoadDevice(std::string &SerialNumber, GWObjects::Device &DeviceDetails);
+		void ForgetDevice(const std::string &SerialNumber);
+		void ForgetAllDevices();
 	};
 
 	inline auto StorageService() { return Storage::instance(); }
@@ -0,0 +1,160 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include "StorageWriteBehind.h"
+#include "StorageService.h"
+
+#include "framework/MicroServiceFuncs.h"
+#include "framework/utils.h"
+
+#include "fmt/format.h"
+
+namespace OpenWifi {
+
+	int StorageWriteBehind::Start() {
+		poco_information(Logger(), "Starting...");
+		Enabled_ = MicroServiceConfigGetBool("storage.writebehind.enabled", true);
+		BatchSize_ = MicroServiceConfigGetInt("storage.writebehind.batchsize", 500);
+		MaxQueuedRows_ = MicroServiceConfigGetInt("storage.writebehind.maxrows", 50000);
+		FlushInterval_ = MicroServiceConfigGetInt("storage.writebehind.interval", 1000);
+		if (BatchSize_ == 0)
+			BatchSize_ = 1;
+		if (FlushInterval_ < 10)
+			FlushInterval_ = 10;
+
+		if (!Enabled_) {
+			poco_information(Logger(), "Write-behind is disabled. Rows are written synchronously.");
+			return 0;
+		}
+
+		Running_ = true;
+		Worker_.start(*this);
+		return 0;
+	}
+
+	void StorageWriteBehind::Stop() {
+		poco_information(Logger(), "Stopping...");
+		if (Running_) {
+			{
+				std::lock_guard G(Mutex_);
+				Running_ = false;
+			}
+			Signal_.notify_one();
+			Worker_.join();
+		}
+		poco_information(Logger(),
+						 fmt::format("Stopped... Written={} Dropped={} Failed={}", RowsWritten_,
+									 RowsDropped_, RowsFailed_));
+	}
+
+	//	Returns false when the row was not taken because the writer is not running.
+	template <typename T> bool StorageWriteBehind::Enqueue(std::vector<T> &Queue, const T &Row) {
+		bool WakeUp;
+		{
+			std::lock_guard G(Mutex_);
+			if (!Running_)
+				return false;
+			if (Queue.size() >= MaxQueuedRows_) {
+				RowsDropped_++;
+				return true;
+			}
+			Queue.emplace_back(Row);
+			WakeUp = Queue.size() >= BatchSize_;
+		}
+		if (WakeUp)
+			Signal_.notify_one();
+		return true;
+	}
+
+	void StorageWriteBehind::AddStatisticsData(const GWObjects::Statistics &Stats) {
+		if (!Enqueue(Statistics_, Stats))
+			StorageService()->AddStatisticsData(Stats);
+	}
+
+	void StorageWriteBehind::AddHealthCheckData(const GWObjects::HealthCheck &Check) {
+		if (!Enqueue(HealthChecks_, Check))
+			StorageService()->AddHealthCheckData(Check);
+	}
+
+	void StorageWriteBehind::AddLog(const GWObjects::DeviceLog &Log) {
+		if (!Enqueue(Logs_, Log))
+			StorageService()->AddLog(Log);
+	}
+
+	void StorageWriteBehind::Flush() {
+		std::vector<GWObjects::Statistics> Statistics;
+		std::vector<GWObjects::HealthCheck> HealthChecks;
+		std::vector<GWObjects::DeviceLog> Logs;
+		{
+			std::lock_guard G(Mutex_);
+			Statistics.swap(Statistics_);
+			HealthChecks.swap(HealthChecks_);
+			Logs.swap(Logs_);
+		}
+
+		//	Each multi-row chunk succeeds or fails on its own, so only the rows of failed chunks are lost.
+		std::uint64_t Written = 0, Failed = 0;
+		std::uint64_t Stored = 0;
+		auto Account = [&](std::size_t Rows) {
+			Written += Stored;
+			Failed += Rows - Stored;
+		};
+
+		if (!Statistics.empty()) {
+			StorageService()->AddStatisticsData(Statistics, Stored);
+			Account(Statistics.size());
+		}
+		if (!HealthChecks.empty()) {
+			StorageService()->AddHealthCheckData(HealthChecks, Stored);
+			Account(HealthChecks.size());
+		}
+		if (!Logs.empty()) {
+			StorageService()->AddLog(Logs, Stored);
+			Account(Logs.size());
+		}
+
+		std::lock_guard G(Mutex_);
+		RowsWritten_ += Written;
+		RowsFailed_ += Failed;
+		if (RowsDropped_ != LastDroppedReported_) {
+			poco_warning(Logger(), fmt::format("Queue overflow: {} rows dropped so far.",
+											   RowsDropped_));
+			LastDroppedReported_ = RowsDropped_;
+		}
+	}
+
+	void StorageWriteBehind::run() {
+		Utils::SetThreadName("strg-wbehind");
+
+		while (true) {
+			{
+				std::unique_lock Lock(Mutex_);
+				Signal_.wait_for(Lock, std::chrono::milliseconds(FlushInterval_), [this] {
+					return !Running_ || Statistics_.size() >= BatchSize_ ||
+						   HealthChecks_.size() >= BatchSize_ || Logs_.size() >= BatchSize_;
+				});
+			}
+
+			try {
+				Flush();
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
+			} catch (...) {
+			}
+
+			if (!Running_) {
+				//	Rows may have been queued while we were flushing. Drain them before leaving.
+				try {
+					Flush();
+				} catch (const Poco::Exception &E) {
+					Logger().log(E);
+				} catch (...) {
+				}
+				break;
+			}
+		}
+	}
+
+} // namespace OpenWifi
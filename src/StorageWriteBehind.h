@@ -0,0 +1,77 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+
+#include "RESTObjects/RESTAPI_GWobjects.h"
+#include "framework/SubSystemServer.h"
+
+namespace OpenWifi {
+
+	/*
+	 * 	Statistics, health checks and device logs arrive at a very high rate. Instead of doing one
+	 * INSERT per message on the reactor threads, rows are queued here and written by a single
+	 * thread as multi-row INSERTs, either when a batch is full or when the flush interval expires.
+	 */
+	class StorageWriteBehind : public SubSystemServer, Poco::Runnable {
+	  public:
+		static auto instance() {
+			static auto instance_ = new StorageWriteBehind;
+			return instance_;
+		}
+
+		int Start() override;
+		void Stop() override;
+		void run() final;
+
+		void AddStatisticsData(const GWObjects::Statistics &Stats);
+		void AddHealthCheckData(const GWObjects::HealthCheck &Check);
+		void AddLog(const GWObjects::DeviceLog &Log);
+
+		inline void GetCounters(std::uint64_t &Queued, std::uint64_t &Written,
+								std::uint64_t &Dropped, std::uint64_t &Failed) const {
+			std::lock_guard G(Mutex_);
+			Queued = Statistics_.size() + HealthChecks_.size() + Logs_.size();
+			Written = RowsWritten_;
+			Dropped = RowsDropped_;
+			Failed = RowsFailed_;
+		}
+
+	  private:
+		mutable std::mutex 							Mutex_;
+		std::condition_variable 					Signal_;
+		Poco::Thread 								Worker_;
+		std::atomic_bool 							Running_ = false;
+		bool 										Enabled_ = true;
+		std::uint64_t 								BatchSize_ = 500;
+		std::uint64_t 								MaxQueuedRows_ = 50000;
+		std::uint64_t 								FlushInterval_ = 1000;
+
+		std::vector<GWObjects::Statistics> 			Statistics_;
+		std::vector<GWObjects::HealthCheck> 		HealthChecks_;
+		std::vector<GWObjects::DeviceLog> 			Logs_;
+
+		std::uint64_t 								RowsWritten_ = 0;
+		std::uint64_t 								RowsDropped_ = 0;
+		std::uint64_t 								RowsFailed_ = 0;
+		std::uint64_t 								LastDroppedReported_ = 0;
+
+		template <typename T> bool Enqueue(std::vector<T> &Queue, const T &Row);
+		void Flush();
+
+		StorageWriteBehind() noexcept
+			: SubSystemServer("StorageWriteBehind", "STORAGE-WB", "storage.writebehind") {}
+	};
+
+	inline auto StorageWriteBehind() { return StorageWriteBehind::instance(); }
+
+} // namespace OpenWifi
@@ -77,7 +77,7 @@ namespace OpenWifi {
 		poco_information(Logger(), fmt::format("TELEMETRY-SHUTDOWN({}): Closing.", CId_));
 		DeRegister();
 		AP_WS_Server()->StopWebSocketTelemetry(CommandManager()->Next_RPC_ID(), SerialNumber_);
-		TelemetryStream()->DeRegisterClient(UUID_);
+		TelemetryStream()->DeRegisterClient(SerialNumber_, UUID_);
 	}
 
 	void TelemetryClient::OnSocketShutdown(
@@ -12,36 +12,56 @@
 
 #include "framework/MicroServiceFuncs.h"
 
+#include "fmt/format.h"
+
 namespace OpenWifi {
 
 	int TelemetryStream::Start() {
+		if (Shards_.empty()) {
+			auto NumberOfShards = MicroServiceConfigGetInt("openwifi.telemetry.shards", 4);
+			if (NumberOfShards < 1)
+				NumberOfShards = 1;
+			for (auto i = 0; i < NumberOfShards; ++i)
+				Shards_.emplace_back(std::make_unique<Shard>(Logger(), Running_));
+		}
+
 		Running_ = true;
-		ReactorThr_.start(Reactor_);
-		Utils::SetThreadName(ReactorThr_, "tel:reactor");
-		NotificationMgr_.start(*this);
+		for (std::size_t i = 0; i < Shards_.size(); ++i) {
+			auto &S = *Shards_[i];
+			S.ReactorThr_.start(S.Reactor_);
+			Utils::SetThreadName(S.ReactorThr_, fmt::format("tel:reactor:{}", i).c_str());
+			S.NotificationMgr_.start(S);
+			Utils::SetThreadName(S.NotificationMgr_, fmt::format("tel:notifier:{}", i).c_str());
+		}
 		return 0;
 	}
 
 	void TelemetryStream::Stop() {
 		poco_information(Logger(), "Stopping...");
 		Running_ = false;
-		Reactor_.stop();
-		ReactorThr_.join();
-		MsgQueue_.wakeUpAll();
-		NotificationMgr_.wakeUp();
-		NotificationMgr_.join();
+		for (auto &S : Shards_) {
+			S->Reactor_.stop();
+			S->ReactorThr_.join();
+			S->MsgQueue_.wakeUpAll();
+			S->NotificationMgr_.wakeUp();
+			S->NotificationMgr_.join();
+		}
 		poco_information(Logger(), "Stopped...");
 	}
 
 	bool TelemetryStream::IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID) {
-		std::lock_guard G(Mutex_);
+		auto Hint = ShardFor(SerialNumber);
+		if (Hint == nullptr)
+			return false;
+		auto &S = *Hint;
+		std::lock_guard G(S.Mutex_);
 
-		auto U = Clients_.find(UUID);
-		if (U == Clients_.end())
+		auto U = S.Clients_.find(UUID);
+		if (U == S.Clients_.end())
 			return false;
 
-		auto N = SerialNumbers_.find(SerialNumber);
-		if (N == SerialNumbers_.end())
+		auto N = S.SerialNumbers_.find(SerialNumber);
+		if (N == S.SerialNumbers_.end())
 			return false;
 
 		return (N->second.find(UUID) != N->second.end());
@@ -49,8 +69,6 @@ namespace OpenWifi {
 
 	bool TelemetryStream::CreateEndpoint(uint64_t SerialNumber, std::string &EndPoint,
 										 const std::string &UUID) {
-		std::lock_guard G(Mutex_);
-
 		Poco::URI Public(MicroServiceConfigGetString("openwifi.system.uri.public", ""));
 		Poco::URI U;
 		U.setScheme("wss");
@@ -61,75 +79,30 @@ namespace OpenWifi {
 		U.addQueryParameter("uuid", UUID);
 		U.addQueryParameter("serialNumber", Utils::IntToSerialNumber(SerialNumber));
 		EndPoint = U.toString();
-		auto S = SerialNumbers_[SerialNumber];
-		S.insert(UUID);
-		SerialNumbers_[SerialNumber] = S;
-		Clients_[UUID] = nullptr;
+
+		auto Hint = ShardFor(SerialNumber);
+		if (Hint == nullptr)
+			return false;
+		auto &S = *Hint;
+		std::lock_guard G(S.Mutex_);
+		S.SerialNumbers_[SerialNumber].insert(UUID);
+		S.ClientSerialNumbers_[UUID].insert(SerialNumber);
+		S.Clients_[UUID] = nullptr;
 		return true;
 	}
 
-	void TelemetryStream::run() {
-		Utils::SetThreadName("tel:notifier");
+	void TelemetryStream::Shard::run() {
 		Poco::AutoPtr<Poco::Notification> NextNotification(MsgQueue_.waitDequeueNotification());
 		while (NextNotification && Running_) {
 			auto Notification = dynamic_cast<TelemetryNotification *>(NextNotification.get());
 			if (Notification != nullptr) {
-				std::lock_guard Lock(Mutex_);
 				switch (Notification->Type_) {
 				case TelemetryNotification::NotificationType::data: {
-					auto SerialNumberSetOfUUIDs = SerialNumbers_.find(Notification->SerialNumber_);
-					if (SerialNumberSetOfUUIDs != SerialNumbers_.end()) {
-						for (auto &uuid : SerialNumberSetOfUUIDs->second) {
-							auto Client = Clients_.find(uuid);
-							if (Client != Clients_.end() && Client->second != nullptr) {
-								try {
-									// std::cout << "Sent WS telemetry notification" << std::endl;
-									Client->second->Send(Notification->Data_);
-								} catch (const Poco::Exception &E) {
-									Logger().log(E);
-								} catch (std::exception &E) {
-									poco_warning(
-										Logger(),
-										fmt::format(
-											"Std:Ex Cannot send WS telemetry notification: {} for "
-											"SerialNumber: {}",
-											E.what(),
-											Utils::IntToSerialNumber(Notification->SerialNumber_)));
-								}
-							} else {
-								poco_warning(Logger(),
-											 fmt::format("Cannot send WS telemetry notification "
-														 "for SerialNumber: {}",
-														 Utils::IntToSerialNumber(
-															 Notification->SerialNumber_)));
-							}
-						}
-					} else {
-						poco_warning(Logger(), fmt::format("Cannot find serial: {}",
-														   Utils::IntToSerialNumber(
-															   Notification->SerialNumber_)));
-					}
+					Send(*Notification);
 				} break;
 				case TelemetryNotification::NotificationType::unregister: {
-					std::lock_guard G(Mutex_);
-
-					auto client = Clients_.find(Notification->Data_);
-					if (client != Clients_.end()) {
-						for (auto i = SerialNumbers_.begin(); i != SerialNumbers_.end();) {
-							i->second.erase(Notification->Data_);
-							if (i->second.empty()) {
-								i = SerialNumbers_.erase(i);
-							} else {
-								++i;
-							}
-						}
-						Clients_.erase(client);
-					} else {
-						poco_warning(Logger(),
-									 fmt::format("Unknown connection: {}", Notification->Data_));
-					}
+					Unregister(*Notification);
 				} break;
-
 				default: {
 
 				} break;
@@ -139,15 +112,89 @@ namespace OpenWifi {
 		}
 	}
 
+	//	Sockets are written outside the shard lock so registrations are never blocked by a send.
+	void TelemetryStream::Shard::Send(const TelemetryNotification &Notification) {
+		std::vector<std::shared_ptr<TelemetryClient>> Targets;
+		{
+			std::lock_guard G(Mutex_);
+			auto SerialNumberSetOfUUIDs = SerialNumbers_.find(Notification.SerialNumber_);
+			if (SerialNumberSetOfUUIDs == SerialNumbers_.end()) {
+				poco_warning(Logger_, fmt::format("Cannot find serial: {}",
+												  Utils::IntToSerialNumber(
+													  Notification.SerialNumber_)));
+				return;
+			}
+			for (auto &uuid : SerialNumberSetOfUUIDs->second) {
+				auto Client = Clients_.find(uuid);
+				if (Client != Clients_.end() && Client->second != nullptr) {
+					Targets.emplace_back(Client->second);
+				} else {
+					poco_warning(Logger_,
+								 fmt::format("Cannot send WS telemetry notification "
+											 "for SerialNumber: {}",
+											 Utils::IntToSerialNumber(Notification.SerialNumber_)));
+				}
+			}
+		}
+
+		for (auto &Client : Targets) {
+			try {
+				Client->Send(*Notification.Payload_);
+			} catch (const Poco::Exception &E) {
+				Logger_.log(E);
+			} catch (std::exception &E) {
+				poco_warning(Logger_,
+							 fmt::format("Std:Ex Cannot send WS telemetry notification: {} for "
+										 "SerialNumber: {}",
+										 E.what(),
+										 Utils::IntToSerialNumber(Notification.SerialNumber_)));
+			}
+		}
+	}
+
+	void TelemetryStream::Shard::Unregister(const TelemetryNotification &Notification) {
+		std::shared_ptr<TelemetryClient> Client;
+		{
+			std::lock_guard G(Mutex_);
+			auto client = Clients_.find(Notification.UUID_);
+			if (client == Clients_.end()) {
+				poco_warning(Logger_, fmt::format("Unknown connection: {}", Notification.UUID_));
+				return;
+			}
+			auto Subscriptions = ClientSerialNumbers_.find(Notification.UUID_);
+			if (Subscriptions != ClientSerialNumbers_.end()) {
+				for (auto SerialNumber : Subscriptions->second) {
+					auto i = SerialNumbers_.find(SerialNumber);
+					if (i == SerialNumbers_.end())
+						continue;
+					i->second.erase(Notification.UUID_);
+					if (i->second.empty())
+						SerialNumbers_.erase(i);
+				}
+				ClientSerialNumbers_.erase(Subscriptions);
+			}
+			Client = std::move(client->second);
+			Clients_.erase(client);
+		}
+		//	The client is closed here, outside the lock.
+	}
+
 	bool TelemetryStream::NewClient(const std::string &UUID, uint64_t SerialNumber,
 									std::unique_ptr<Poco::Net::WebSocket> Client) {
-		std::lock_guard G(Mutex_);
+		auto Hint = ShardFor(SerialNumber);
+		if (Hint == nullptr)
+			return false;
+		auto &S = *Hint;
 		try {
-			Clients_[UUID] = std::make_unique<TelemetryClient>(
-				UUID, SerialNumber, std::move(Client), NextReactor(), Logger());
-			auto set = SerialNumbers_[SerialNumber];
-			set.insert(UUID);
-			SerialNumbers_[SerialNumber] = set;
+			auto NewClient = std::make_shared<TelemetryClient>(UUID, SerialNumber, std::move(Client),
+															   S.Reactor_, Logger());
+			std::shared_ptr<TelemetryClient> Previous;
+			std::lock_guard G(S.Mutex_);
+			auto &Entry = S.Clients_[UUID];
+			Previous = std::move(Entry);
+			Entry = std::move(NewClient);
+			S.SerialNumbers_[SerialNumber].insert(UUID);
+			S.ClientSerialNumbers_[UUID].insert(SerialNumber);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -5,6 +5,10 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "Poco/Net/HTTPRequestHandler.h"
 #include "Poco/Net/HTTPRequestHandlerFactory.h"
@@ -22,6 +26,7 @@
 #include "Poco/URI.h"
 
 #include "framework/SubSystemServer.h"
+#include "framework/utils.h"
 
 #include "AP_WS_ReactorPool.h"
 #include "TelemetryClient.h"
@@ -32,24 +37,27 @@ namespace OpenWifi {
 	  public:
 		enum class NotificationType { data, unregister };
 
-		explicit TelemetryNotification(std::uint64_t SerialNumber, const std::string &Payload)
-			: Type_(NotificationType::data), SerialNumber_(SerialNumber), Data_(Payload) {}
+		explicit TelemetryNotification(std::uint64_t SerialNumber,
+									   std::shared_ptr<const std::string> Payload)
+			: Type_(NotificationType::data), SerialNumber_(SerialNumber),
+			  Payload_(std::move(Payload)) {}
 
-		explicit TelemetryNotification(const std::string &UUID)
-			: Type_(NotificationType::unregister), Data_(UUID) {}
+		explicit TelemetryNotification(std::uint64_t SerialNumber, const std::string &UUID)
+			: Type_(NotificationType::unregister), SerialNumber_(SerialNumber), UUID_(UUID) {}
 
 		NotificationType Type_;
 		std::uint64_t SerialNumber_ = 0;
-		std::string Data_;
+		std::shared_ptr<const std::string> Payload_;
+		std::string UUID_;
 	};
 
-	class TelemetryStream : public SubSystemServer, Poco::Runnable {
+	/*
+	 * 	Telemetry is delivered by several shards, chosen by device serial number. Each shard has its
+	 * own notification queue, sender thread and reactor for its browser sockets, so a slow socket
+	 * only delays the devices of its own shard. A payload is shared by all the clients it is sent to.
+	 */
+	class TelemetryStream : public SubSystemServer {
 	  public:
-		struct QueueUpdate {
-			uint64_t SerialNumber;
-			std::string Payload;
-		};
-
 		static auto instance() {
 			static auto instance_ = new TelemetryStream;
 			return instance_;
@@ -57,33 +65,56 @@ namespace OpenWifi {
 
 		int Start() override;
 		void Stop() override;
-		void run() final;
 
 		bool IsValidEndPoint(uint64_t SerialNumber, const std::string &UUID);
 		bool CreateEndpoint(uint64_t SerialNumber, std::string &EndPoint, const std::string &UUID);
 
 		inline void NotifyEndPoint(uint64_t SerialNumber, const std::string &PayLoad) {
-			MsgQueue_.enqueueNotification(new TelemetryNotification(SerialNumber, PayLoad));
+			auto S = ShardFor(SerialNumber);
+			if (!Running_ || S == nullptr)
+				return;
+			S->MsgQueue_.enqueueNotification(new TelemetryNotification(
+				SerialNumber, std::make_shared<const std::string>(PayLoad)));
 		}
 
-		inline void DeRegisterClient(const std::string &UUID) {
-			MsgQueue_.enqueueNotification(new TelemetryNotification(UUID));
+		inline void DeRegisterClient(uint64_t SerialNumber, const std::string &UUID) {
+			auto S = ShardFor(SerialNumber);
+			if (!Running_ || S == nullptr)
+				return;
+			S->MsgQueue_.enqueueNotification(new TelemetryNotification(SerialNumber, UUID));
 		}
 
 		bool NewClient(const std::string &UUID, uint64_t SerialNumber,
 					   std::unique_ptr<Poco::Net::WebSocket> Client);
 
-		Poco::Net::SocketReactor &NextReactor() { return Reactor_; }
-
 	  private:
-		volatile std::atomic_bool Running_ = false;
-		std::map<uint64_t, std::set<std::string>> SerialNumbers_; //	serialNumber -> uuid
-		Poco::Net::SocketReactor Reactor_;
-		Poco::Thread ReactorThr_;
-		Poco::Thread NotificationMgr_;
-		Poco::NotificationQueue MsgQueue_;
-
-		std::map<std::string, std::unique_ptr<TelemetryClient>> Clients_; // 	uuid -> client
+		struct Shard : public Poco::Runnable {
+			Shard(Poco::Logger &L, const std::atomic_bool &Running) : Logger_(L), Running_(Running) {}
+			void run() final;
+			void Send(const TelemetryNotification &Notification);
+			void Unregister(const TelemetryNotification &Notification);
+
+			Poco::Logger &Logger_;
+			const std::atomic_bool &Running_;
+			std::mutex Mutex_;
+			std::unordered_map<uint64_t, std::set<std::string>> SerialNumbers_; //	serialNumber -> uuid
+			std::unordered_map<std::string, std::set<uint64_t>> ClientSerialNumbers_; // uuid -> serialNumber
+			std::unordered_map<std::string, std::shared_ptr<TelemetryClient>> Clients_; // uuid -> client
+			Poco::Net::SocketReactor Reactor_;
+			Poco::Thread ReactorThr_;
+			Poco::Thread NotificationMgr_;
+			Poco::NotificationQueue MsgQueue_;
+		};
+
+		std::atomic_bool Running_ = false;
+		std::vector<std::unique_ptr<Shard>> Shards_;
+
+		//	The shards are created by Start(): there are none before that.
+		inline Shard *ShardFor(uint64_t SerialNumber) {
+			if (Shards_.empty())
+				return nullptr;
+			return Shards_[Utils::CalculateMacAddressHash(SerialNumber) % Shards_.size()].get();
+		}
 
 		TelemetryStream() noexcept
 			: SubSystemServer("TelemetryServer", "TELEMETRY-SVR", "openwifi.telemetry") {}
@@ -80,7 +80,20 @@ namespace OpenWifi {
 		cppkafka::Configuration Config(
 			{{"client.id", MicroServiceConfigGetString("openwifi.kafka.client.id", "")},
 			 {"metadata.broker.list",
-			  MicroServiceConfigGetString("openwifi.kafka.brokerlist", "")}});
+			  MicroServiceConfigGetString("openwifi.kafka.brokerlist", "")},
+			 {"linger.ms",
+			  std::to_string(MicroServiceConfigGetInt("openwifi.kafka.queue.buffering.max.ms", 50))},
+			 {"batch.num.messages",
+			  std::to_string(MicroServiceConfigGetInt("openwifi.kafka.batch.num.messages", 10000))},
+			 {"compression.codec",
+			  MicroServiceConfigGetString("openwifi.kafka.compression.codec", "none")}});
+
+		//	Messages have the device serial number as key: let librdkafka hash it to a partition so
+		//	consumers can scale out while each device's messages stay ordered.
+		cppkafka::TopicConfiguration TopicConfig = {
+			{"partitioner",
+			 MicroServiceConfigGetString("openwifi.kafka.partitioner", "consistent_random")}};
+		Config.set_default_topic_configuration(TopicConfig);
 
 		AddKafkaSecurity(Config);
 
@@ -95,29 +108,63 @@ namespace OpenWifi {
 		cppkafka::Producer Producer(Config);
 		Running_ = true;
 
-		Poco::AutoPtr<Poco::Notification> Note(Queue_.waitDequeueNotification());
-		while (Note && Running_) {
-			try {
+		while (Running_) {
+			Poco::AutoPtr<Poco::Notification> Note(Queue_.waitDequeueNotification(100));
+			if (Note) {
+				SpaceAvailable_.notify_all();
 				auto Msg = dynamic_cast<KafkaMessage *>(Note.get());
 				if (Msg != nullptr) {
-					auto NewMessage = cppkafka::MessageBuilder(Msg->Topic());
-					NewMessage.key(Msg->Key());
-					NewMessage.partition(0);
-					NewMessage.payload(Msg->Payload());
+					Send(Producer, *Msg, Logger_);
+				}
+			}
+			//	Serve delivery reports and errors. librdkafka batches and sends on its own.
+			Producer.poll(std::chrono::milliseconds(0));
+		}
+
+		//	Drain whatever is left and give the brokers a chance to receive it before we leave.
+		Poco::AutoPtr<Poco::Notification> Note(Queue_.dequeueNotification());
+		while (Note) {
+			auto Msg = dynamic_cast<KafkaMessage *>(Note.get());
+			if (Msg != nullptr) {
+				Send(Producer, *Msg, Logger_);
+			}
+			Note = Queue_.dequeueNotification();
+		}
+		try {
+			Producer.flush(std::chrono::milliseconds(10000));
+		} catch (const cppkafka::HandleException &E) {
+			poco_warning(Logger_, fmt::format("Could not flush all messages: {}", E.what()));
+		}
+		poco_information(Logger_, fmt::format("Stopped... Produced={} Dropped={}",
+											  Produced_, Dropped_));
+	}
+
+	void KafkaProducer::Send(cppkafka::Producer &Producer, KafkaMessage &Msg,
+							 Poco::Logger &Logger) {
+		try {
+			auto NewMessage = cppkafka::MessageBuilder(Msg.Topic());
+			NewMessage.key(Msg.Key());
+			NewMessage.payload(Msg.Payload());
+			while (true) {
+				try {
 					Producer.produce(NewMessage);
-					Producer.flush();
+					Produced_++;
+					return;
+				} catch (const cppkafka::HandleException &E) {
+					if (E.get_error().get_error() != RD_KAFKA_RESP_ERR__QUEUE_FULL)
+						throw;
+					//	librdkafka's own queue is full: wait for some deliveries to complete.
+					Producer.poll(std::chrono::milliseconds(100));
 				}
-			} catch (const cppkafka::HandleException &E) {
-				poco_warning(Logger_,
-							 fmt::format("Caught a Kafka exception (producer): {}", E.what()));
-			} catch (const Poco::Exception &E) {
-				Logger_.log(E);
-			} catch (...) {
-				poco_error(Logger_, "std::exception");
 			}
-			Note = Queue_.waitDequeueNotification();
+		} catch (const cppkafka::HandleException &E) {
+			poco_warning(Logger, fmt::format("Caught a Kafka exception (producer): {}", E.what()));
+		} catch (const Poco::Exception &E) {
+			Logger.log(E);
+		} catch (...) {
+			poco_error(Logger, "std::exception");
 		}
-		poco_information(Logger_, "Stopped...");
+		Dropped_++;
 	}
 
 	inline void KafkaConsumer::run() {
@@ -209,6 +256,10 @@ namespace OpenWifi {
 
 	void KafkaProducer::Start() {
 		if (!Running_) {
+			MaxQueueSize_ = MicroServiceConfigGetInt("openwifi.kafka.producer.queue.max", 100000);
+			BlockWhenFull_ =
+				MicroServiceConfigGetString("openwifi.kafka.producer.queue.policy", "dropoldest") ==
+				"block";
 			Running_ = true;
 			Worker_.start(*this);
 		}
@@ -218,13 +269,28 @@ namespace OpenWifi {
 		if (Running_) {
 			Running_ = false;
 			Queue_.wakeUpAll();
+			SpaceAvailable_.notify_all();
 			Worker_.join();
 		}
 	}
 
 	void KafkaProducer::Produce(const char *Topic, const std::string &Key,
 								const std::string &Payload) {
-		std::lock_guard G(Mutex_);
+		std::unique_lock G(Mutex_);
+		if (MaxQueueSize_ && (std::uint64_t)Queue_.size() >= MaxQueueSize_) {
+			if (BlockWhenFull_) {
+				while (Running_ && (std::uint64_t)Queue_.size() >= MaxQueueSize_) {
+					SpaceAvailable_.wait_for(G, std::chrono::milliseconds(10));
+				}
+			} else {
+				while ((std::uint64_t)Queue_.size() >= MaxQueueSize_) {
+					Poco::AutoPtr<Poco::Notification> Oldest(Queue_.dequeueNotification());
+					if (!Oldest)
+						break;
+					Dropped_++;
+				}
+			}
+		}
 		Queue_.enqueueNotification(new KafkaMessage(Topic, Key, Payload));
 	}
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <condition_variable>
+
 #include "Poco/Notification.h"
 #include "Poco/NotificationQueue.h"
 #include "Poco/JSON/Object.h"
@@ -38,11 +40,25 @@ namespace OpenWifi {
 		void Stop();
 		void Produce(const char *Topic, const std::string &Key, const std::string & Payload);
 
+		inline void GetCounters(std::uint64_t &Queued, std::uint64_t &Produced,
+								std::uint64_t &Dropped) const {
+			Queued = Queue_.size();
+			Produced = Produced_;
+			Dropped = Dropped_;
+		}
+
 	  private:
 		std::mutex Mutex_;
+		std::condition_variable SpaceAvailable_;
 		Poco::Thread Worker_;
 		mutable std::atomic_bool Running_ = false;
 		Poco::NotificationQueue Queue_;
+		std::uint64_t MaxQueueSize_ = 100000;
+		bool BlockWhenFull_ = false;
+		std::atomic_uint64_t Produced_ = 0;
+		std::atomic_uint64_t Dropped_ = 0;
+
+		void Send(cppkafka::Producer &Producer, KafkaMessage &Msg, Poco::Logger &Logger);
 	};
 
 	class KafkaConsumer : public Poco::Runnable {
@@ -93,6 +109,10 @@ namespace OpenWifi {
 		inline void UnregisterTopicWatcher(const std::string &Topic, uint64_t Id) {
 			return ConsumerThr_.UnregisterTopicWatcher(Topic,Id);
 		}
+		inline void GetProducerCounters(std::uint64_t &Queued, std::uint64_t &Produced,
+										std::uint64_t &Dropped) const {
+			ProducerThr_.GetCounters(Queued, Produced, Dropped);
+		}
 
 	  private:
 		bool KafkaEnabled_ = false;
@@ -105,6 +105,7 @@ namespace OpenWifi {
 		virtual void GetExtraConfiguration(Poco::JSON::Object &Cfg) {
 			Cfg.set("additionalConfiguration", false);
 		}
+		virtual void GetExtraResources([[maybe_unused]] Poco::JSON::Object &Answer) {}
 		static MicroService &instance() { return *instance_; }
 
 		inline void Exit(int Reason);
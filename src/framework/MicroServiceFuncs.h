@@ -37,6 +37,7 @@ namespace OpenWifi {
 	Types::StringPairVec MicroServiceGetLogLevels();
 	bool MicroServiceSetSubsystemLogLevel(const std::string &SubSystem, const std::string &Level);
 	void MicroServiceGetExtraConfiguration(Poco::JSON::Object &Answer);
+	void MicroServiceGetExtraResources(Poco::JSON::Object &Answer);
 	std::string MicroServiceVersion();
 	std::uint64_t MicroServiceUptimeTotalSeconds();
 	std::uint64_t MicroServiceStartTimeEpochTime();
@@ -38,7 +38,7 @@ namespace OpenWifi {
 	  public:
 		struct QueryBlock {
 			uint64_t StartDate = 0, EndDate = 0, Offset = 0, Limit = 0, LogType = 0;
-			std::string SerialNumber, Filter;
+			std::string SerialNumber, Filter, Cursor;
 			std::vector<std::string> Select;
 			bool Lifetime = false, LastOnly = false, Newest = false, CountOnly = false,
 				 AdditionalInfo = false;
@@ -641,6 +641,7 @@ namespace OpenWifi {
 			QB_.EndDate = GetParameter(RESTAPI::Protocol::ENDDATE, 0);
 			QB_.Offset = GetParameter(RESTAPI::Protocol::OFFSET, 0);
 			QB_.Limit = GetParameter(RESTAPI::Protocol::LIMIT, 100);
+			QB_.Cursor = GetParameter(RESTAPI::Protocol::CURSOR, "");
 			QB_.Filter = GetParameter(RESTAPI::Protocol::FILTER, "");
 			QB_.Lifetime = GetBoolParameter(RESTAPI::Protocol::LIFETIME, false);
 			QB_.LogType = GetParameter(RESTAPI::Protocol::LOGTYPE, 0);
@@ -79,6 +79,7 @@ namespace OpenWifi {
 					Answer.set("peakRealMem", peakRealMem);
 					Answer.set("currVirtMem", currVirtMem);
 					Answer.set("peakVirtMem", peakVirtMem);
+					MicroServiceGetExtraResources(Answer);
 					return ReturnObject(Answer);
 				}
 			}
@@ -0,0 +1,244 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Poco/Data/Session.h"
+#include "Poco/Data/SessionPool.h"
+#include "Poco/Data/Statement.h"
+
+namespace OpenWifi {
+
+	/*
+	 * 	A few sessions are taken out of the pool and each keeps the statements run through it,
+	 * keyed by their SQL before parameter conversion. A statement is prepared once per session;
+	 * later calls only write new values into the variables it is bound to and execute it again.
+	 * When every cached session is busy, the statement runs on a plain pooled session instead.
+	 * A failure drops the session and everything prepared on it. If the failure came from a lost
+	 * connection, the statement is prepared again on a fresh session and run once more.
+	 */
+	class StatementCache {
+	  private:
+		struct PreparedBase {
+			explicit PreparedBase(Poco::Data::Session &Session) : Statement(Session) {}
+			virtual ~PreparedBase() = default;
+			Poco::Data::Statement Statement;
+		};
+
+		template <typename Bound> struct Prepared : PreparedBase {
+			using PreparedBase::PreparedBase;
+			Bound Values;
+		};
+
+		struct Slot {
+			std::mutex Mutex;
+			std::atomic<std::thread::id> Owner;
+			std::unique_ptr<Poco::Data::Session> Session;
+			std::unordered_map<std::string, std::unique_ptr<PreparedBase>> Statements;
+		};
+
+	  public:
+		//	A statement ready to run. Values are set through -> before Execute().
+		template <typename Bound> class Handle {
+		  public:
+			Handle(Handle &&) noexcept = default;
+			Handle &operator=(Handle &&) noexcept = default;
+			~Handle() {
+				if (Slot_ != nullptr && Lock_.owns_lock())
+					Slot_->Owner = std::thread::id();
+			}
+
+			Bound &operator*() { return Prepared_->Values; }
+			Bound *operator->() { return &Prepared_->Values; }
+
+			//	Returns the number of rows extracted or affected.
+			std::size_t Execute() {
+				try {
+					return Prepared_->Statement.execute();
+				} catch (const Poco::Exception &) {
+					if (Connected()) {
+						Discard();
+						throw;
+					}
+				} catch (...) {
+					Discard();
+					throw;
+				}
+
+				//	The database went away under this session: the values survive it, the
+				//	prepared statement does not.
+				Bound Values = std::move(Prepared_->Values);
+				Discard();
+				try {
+					Session_ = std::make_unique<Poco::Data::Session>(Cache_->Pool_.get());
+					Owned_ = std::make_unique<Prepared<Bound>>(*Session_);
+					Owned_->Values = std::move(Values);
+					Owned_->Statement << ConvertParams(SQL_, Cache_->NumberedParameters_);
+					Bind_(Owned_->Statement, Owned_->Values);
+					Prepared_ = Owned_.get();
+					return Prepared_->Statement.execute();
+				} catch (...) {
+					Discard();
+					throw;
+				}
+			}
+
+		  private:
+			friend class StatementCache;
+			Handle() = default;
+
+			[[nodiscard]] bool Connected() const {
+				auto Session = Slot_ != nullptr ? Slot_->Session.get() : Session_.get();
+				try {
+					return Session != nullptr && Session->isGood();
+				} catch (const Poco::Exception &) {
+				}
+				return false;
+			}
+
+			void Discard() {
+				if (Slot_ != nullptr)
+					Invalidate(*Slot_);
+				Prepared_ = nullptr;
+				Owned_.reset();
+				Session_.reset();
+			}
+
+			StatementCache *Cache_ = nullptr;
+			std::string SQL_;
+			std::function<void(Poco::Data::Statement &, Bound &)> Bind_;
+			Slot *Slot_ = nullptr;
+			std::unique_lock<std::mutex> Lock_;
+			std::unique_ptr<Poco::Data::Session> Session_;
+			std::unique_ptr<Prepared<Bound>> Owned_;
+			Prepared<Bound> *Prepared_ = nullptr;
+		};
+
+		StatementCache(Poco::Data::SessionPool &Pool, bool NumberedParameters, std::size_t Sessions,
+					   std::size_t MaxStatements)
+			: Pool_(Pool), NumberedParameters_(NumberedParameters), MaxStatements_(MaxStatements) {
+			for (std::size_t i = 0; i < Sessions; ++i)
+				Slots_.emplace_back(std::make_unique<Slot>());
+		}
+
+		//	PostgreSQL numbers its parameters: "?" becomes "$1", "$2", ...
+		static inline std::string ConvertParams(const std::string &S, bool NumberedParameters) {
+			if (!NumberedParameters)
+				return S;
+			std::string R;
+			R.reserve(S.size() * 2 + 1);
+			auto Idx = 1;
+			for (auto const &i : S) {
+				if (i == '?') {
+					R += '$';
+					R.append(std::to_string(Idx++));
+				} else {
+					R += i;
+				}
+			}
+			return R;
+		}
+
+		/*
+		 * 	Bind attaches the members of Bound to the statement with use() and into(); it only runs
+		 * when the statement is prepared. Statements whose text changes with their arguments should
+		 * pass Cacheable=false so they do not push the hot ones out.
+		 */
+		template <typename Bound>
+		Handle<Bound> Prepare(const std::string &SQL,
+							  std::function<void(Poco::Data::Statement &, Bound &)> Bind,
+							  bool Cacheable = true) {
+			Handle<Bound> H;
+			H.Cache_ = this;
+			H.SQL_ = SQL;
+			H.Bind_ = std::move(Bind);
+			if (Cacheable && Acquire(H.Lock_, H.Slot_)) {
+				auto &S = *H.Slot_;
+				try {
+					if (!S.Session)
+						S.Session = std::make_unique<Poco::Data::Session>(Pool_.get());
+					auto Hint = S.Statements.find(SQL);
+					if (Hint != S.Statements.end()) {
+						H.Prepared_ = dynamic_cast<Prepared<Bound> *>(Hint->second.get());
+						if (H.Prepared_ != nullptr)
+							return H;
+						S.Statements.erase(Hint);
+					}
+					if (S.Statements.size() >= MaxStatements_)
+						S.Statements.clear();
+					auto P = std::make_unique<Prepared<Bound>>(*S.Session);
+					P->Statement << ConvertParams(SQL, NumberedParameters_);
+					H.Bind_(P->Statement, P->Values);
+					H.Prepared_ = P.get();
+					S.Statements[SQL] = std::move(P);
+					return H;
+				} catch (...) {
+					Invalidate(S);
+					throw;
+				}
+			}
+
+			H.Session_ = std::make_unique<Poco::Data::Session>(Pool_.get());
+			H.Owned_ = std::make_unique<Prepared<Bound>>(*H.Session_);
+			H.Owned_->Statement << ConvertParams(SQL, NumberedParameters_);
+			H.Bind_(H.Owned_->Statement, H.Owned_->Values);
+			H.Prepared_ = H.Owned_.get();
+			return H;
+		}
+
+		//	Gives the cached sessions back to the pool. Must run before the pool shuts down.
+		void Clear() {
+			for (auto &S : Slots_) {
+				std::lock_guard G(S->Mutex);
+				Invalidate(*S);
+			}
+		}
+
+		~StatementCache() { Clear(); }
+
+	  private:
+		Poco::Data::SessionPool &Pool_;
+		bool NumberedParameters_ = false;
+		std::size_t MaxStatements_ = 64;
+		std::vector<std::unique_ptr<Slot>> Slots_;
+
+		//	Threads start at different slots so they rarely contend for the same one. A thread that
+		//	already holds a slot never tries to lock it a second time.
+		bool Acquire(std::unique_lock<std::mutex> &Lock, Slot *&S) {
+			if (Slots_.empty())
+				return false;
+			auto Self = std::this_thread::get_id();
+			auto Start = std::hash<std::thread::id>{}(Self) % Slots_.size();
+			for (std::size_t i = 0; i < Slots_.size(); ++i) {
+				auto &Candidate = *Slots_[(Start + i) % Slots_.size()];
+				if (Candidate.Owner == Self)
+					continue;
+				std::unique_lock L(Candidate.Mutex, std::try_to_lock);
+				if (L.owns_lock()) {
+					Candidate.Owner = Self;
+					Lock = std::move(L);
+					S = &Candidate;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static void Invalidate(Slot &S) {
+			S.Statements.clear();
+			S.Session.reset();
+		}
+	};
+
+} // namespace OpenWifi
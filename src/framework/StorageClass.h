@@ -15,6 +15,7 @@
 #endif
 
 #include "framework/MicroServiceFuncs.h"
+#include "framework/StatementCache.h"
 #include "framework/SubSystemServer.h"
 
 namespace OpenWifi {
@@ -36,13 +37,29 @@ namespace OpenWifi {
 			} else if (DBType == "mysql") {
 				Setup_MySQL();
 			}
+
+			if (Pool_) {
+				Statements_ = std::make_unique<StatementCache>(
+					*Pool_, dbType_ == pgsql,
+					MicroServiceConfigGetInt("storage.statementcache.sessions", 4),
+					MicroServiceConfigGetInt("storage.statementcache.size", 64));
+			}
 			return 0;
 		}
 
-		inline void Stop() override { Pool_->shutdown(); }
+		inline void Stop() override {
+			Statements_.reset();
+			Pool_->shutdown();
+		}
 
 		DBType Type() const { return dbType_; };
 
+		[[nodiscard]] inline std::string ConvertParams(const std::string &S) const {
+			return StatementCache::ConvertParams(S, dbType_ == pgsql);
+		}
+
+		inline StatementCache &Statements() { return *Statements_; }
+
         StorageClass() noexcept : SubSystemServer("StorageClass", "STORAGE-SVR", "storage") {
 
         }
@@ -55,6 +72,7 @@ namespace OpenWifi {
 
     protected:
 		std::shared_ptr<Poco::Data::SessionPool> Pool_;
+		std::unique_ptr<StatementCache> Statements_;
 		Poco::Data::SQLite::Connector SQLiteConn_;
 		Poco::Data::PostgreSQL::Connector PostgresConn_;
 		Poco::Data::MySQL::Connector MySQLConn_;
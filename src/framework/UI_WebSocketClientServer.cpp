@@ -28,21 +28,22 @@ namespace OpenWifi {
 											 const std::string &UserName, std::uint64_t TID) {
 
 		std::lock_guard G(LocalMutex_);
-		auto Client = std::make_unique<UI_WebSocketClientInfo>(WS, Id, UserName);
+		auto Client = std::make_shared<UI_WebSocketClientInfo>(WS, Id, UserName);
 		auto ClientSocket = Client->WS_->impl()->sockfd();
 		TID_ = TID;
 		Client->WS_->setNoDelay(true);
 		Client->WS_->setKeepAlive(true);
 		Client->WS_->setBlocking(false);
-		Reactor_.addEventHandler(
+		Client->Reactor_ = Reactors_[NextReactor_++ % Reactors_.size()].get();
+		Client->Reactor_->addEventHandler(
 			*Client->WS_,
 			Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ReadableNotification>(
 				*this, &UI_WebSocketClientServer::OnSocketReadable));
-		Reactor_.addEventHandler(
+		Client->Reactor_->addEventHandler(
 			*Client->WS_,
 			Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ShutdownNotification>(
 				*this, &UI_WebSocketClientServer::OnSocketShutdown));
-		Reactor_.addEventHandler(
+		Client->Reactor_->addEventHandler(
 			*Client->WS_, Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ErrorNotification>(
 							  *this, &UI_WebSocketClientServer::OnSocketError));
 		Client->SocketRegistered_ = true;
@@ -70,34 +71,61 @@ namespace OpenWifi {
 			}
 			ToBeRemoved_.clear();
 			UsersConnected_ = Clients_.size();
+
+			std::uint64_t Dropped = NotificationsDropped_;
+			if (Dropped != LastDroppedReported_) {
+				poco_warning(Logger(),
+							 fmt::format("Slow UI clients: {} notifications dropped so far, {} sent.",
+										 Dropped, NotificationsSent_.load()));
+				LastDroppedReported_ = Dropped;
+			}
 		}
 	}
 
+	//	A connection may be ended more than once before the cleaner runs: only queue it once.
 	void UI_WebSocketClientServer::EndConnection(ClientList::iterator Client) {
 		if (Client->second->SocketRegistered_) {
 			Client->second->SocketRegistered_ = false;
-			Reactor_.removeEventHandler(
+			RemoveFromIndex(Client->first, *Client->second);
+			{
+				std::lock_guard O(Client->second->OutboundMutex_);
+				RemoveWritableHandler(*Client->second);
+				Client->second->OutboundQueue_.clear();
+			}
+			Client->second->Reactor_->removeEventHandler(
 				*Client->second->WS_,
 				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ReadableNotification>(
 					*this, &UI_WebSocketClientServer::OnSocketReadable));
-			Reactor_.removeEventHandler(
+			Client->second->Reactor_->removeEventHandler(
 				*Client->second->WS_,
 				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ShutdownNotification>(
 					*this, &UI_WebSocketClientServer::OnSocketShutdown));
-			Reactor_.removeEventHandler(
+			Client->second->Reactor_->removeEventHandler(
 				*Client->second->WS_,
 				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::ErrorNotification>(
 					*this, &UI_WebSocketClientServer::OnSocketError));
+			ToBeRemoved_.push_back(Client);
 		}
-		ToBeRemoved_.push_back(Client);
 	}
 
 	int UI_WebSocketClientServer::Start() {
 		poco_information(Logger(), "Starting...");
 		GoogleApiKey_ = MicroServiceConfigGetString("google.apikey", "");
 		GeoCodeEnabled_ = !GoogleApiKey_.empty();
-		ReactorThread_.start(Reactor_);
-		ReactorThread_.setName("ws:ui-reactor");
+		MaxQueuedNotifications_ = MicroServiceConfigGetInt("websocketclients.queue.maxsize", 1000);
+		if (MaxQueuedNotifications_ == 0)
+			MaxQueuedNotifications_ = 1;
+		auto NumberOfReactors = MicroServiceConfigGetInt("websocketclients.reactors", 2);
+		if (NumberOfReactors < 1)
+			NumberOfReactors = 1;
+		for (auto i = 0; i < NumberOfReactors; ++i) {
+			auto NewReactor = std::make_unique<Poco::Net::SocketReactor>();
+			auto NewThread = std::make_unique<Poco::Thread>();
+			NewThread->start(*NewReactor);
+			NewThread->setName(fmt::format("ws:ui-reactor:{}", i));
+			Reactors_.emplace_back(std::move(NewReactor));
+			ReactorThreads_.emplace_back(std::move(NewThread));
+		}
 		CleanerThread_.start(*this);
 		CleanerThread_.setName("ws:ui-cleaner");
 		return 0;
@@ -106,9 +134,17 @@ namespace OpenWifi {
 	void UI_WebSocketClientServer::Stop() {
 		if (Running_) {
 			poco_information(Logger(), "Stopping...");
+			{
+				std::unique_lock G(IndexMutex_);
+				Recipients_.clear();
+				Users_.clear();
+				Dropped_.clear();
+			}
 			Clients_.clear();
-			Reactor_.stop();
-			ReactorThread_.join();
+			for (auto &Reactor : Reactors_)
+				Reactor->stop();
+			for (auto &Thread : ReactorThreads_)
+				Thread->join();
 			Running_ = false;
 			CleanerThread_.wakeUp();
 			CleanerThread_.join();
@@ -121,37 +157,112 @@ namespace OpenWifi {
 		return std::find(Client.Filter_.begin(), Client.Filter_.end(), id) != end(Client.Filter_);
 	}
 
-	bool UI_WebSocketClientServer::SendToUser(const std::string &UserName, std::uint64_t id,
-											  const std::string &Payload) {
-		std::lock_guard G(LocalMutex_);
+	void UI_WebSocketClientServer::IndexClient(int ClientSocket, const ClientPtr &Client) {
+		std::unique_lock G(IndexMutex_);
+		for (auto &[id, Sockets] : Dropped_)
+			Sockets.erase(ClientSocket);
+		for (const auto id : Client->Filter_)
+			Dropped_[id].insert(ClientSocket);
+		Recipients_[ClientSocket] = Client;
+		Users_[Client->UserName_].insert(ClientSocket);
+	}
 
-		for (const auto &Client : Clients_) {
-			if (Client.second->UserName_ == UserName) {
-				try {
-					if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_) {
-						return Client.second->WS_->sendFrame(
-								   Payload.c_str(), (int)Payload.size()) == (int)Payload.size();
-					} else {
-						return false;
-					}
-				} catch (...) {
-					return false;
-				}
-			}
+	void UI_WebSocketClientServer::RemoveFromIndex(int ClientSocket,
+												   const UI_WebSocketClientInfo &Client) {
+		std::unique_lock G(IndexMutex_);
+		Recipients_.erase(ClientSocket);
+		auto User = Users_.find(Client.UserName_);
+		if (User != Users_.end()) {
+			User->second.erase(ClientSocket);
+			if (User->second.empty())
+				Users_.erase(User);
+		}
+		for (const auto id : Client.Filter_) {
+			auto Dropped = Dropped_.find(id);
+			if (Dropped == Dropped_.end())
+				continue;
+			Dropped->second.erase(ClientSocket);
+			if (Dropped->second.empty())
+				Dropped_.erase(Dropped);
 		}
-		return false;
 	}
 
-	void UI_WebSocketClientServer::SendToAll(std::uint64_t id, const std::string &Payload) {
-		std::lock_guard G(LocalMutex_);
+	bool UI_WebSocketClientServer::HasRecipients(std::uint64_t id) {
+		std::shared_lock G(IndexMutex_);
+		auto Dropped = Dropped_.find(id);
+		return Recipients_.size() > (Dropped == Dropped_.end() ? 0 : Dropped->second.size());
+	}
 
-		for (const auto &Client : Clients_) {
+	//	Never blocks: the client's reactor writes the queue when its socket is writable.
+	bool UI_WebSocketClientServer::Enqueue(UI_WebSocketClientInfo &Client,
+										   const std::shared_ptr<const std::string> &Payload) {
+		std::lock_guard G(Client.OutboundMutex_);
+		if (Client.OutboundQueue_.size() >= MaxQueuedNotifications_) {
+			NotificationsDropped_++;
+			return false;
+		}
+		Client.OutboundQueue_.emplace_back(Payload);
+		if (!Client.WritableRegistered_) {
 			try {
-				if (!IsFiltered(id, *Client.second) && Client.second->Authenticated_)
-					Client.second->WS_->sendFrame(Payload.c_str(), (int)Payload.size());
-			} catch (...) {
+				Client.Reactor_->addEventHandler(
+					*Client.WS_,
+					Poco::NObserver<UI_WebSocketClientServer, Poco::Net::WritableNotification>(
+						*this, &UI_WebSocketClientServer::OnSocketWritable));
+				Client.WritableRegistered_ = true;
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
+				Client.OutboundQueue_.pop_back();
+				return false;
 			}
 		}
+		return true;
+	}
+
+	void UI_WebSocketClientServer::RemoveWritableHandler(UI_WebSocketClientInfo &Client) {
+		if (Client.WritableRegistered_) {
+			Client.WritableRegistered_ = false;
+			Client.Reactor_->removeEventHandler(
+				*Client.WS_,
+				Poco::NObserver<UI_WebSocketClientServer, Poco::Net::WritableNotification>(
+					*this, &UI_WebSocketClientServer::OnSocketWritable));
+		}
+	}
+
+	bool UI_WebSocketClientServer::SendToUser(const std::string &UserName, std::uint64_t id,
+											  const std::string &Payload) {
+		auto SharedPayload = std::make_shared<const std::string>(Payload);
+		std::shared_lock G(IndexMutex_);
+
+		auto User = Users_.find(UserName);
+		if (User == Users_.end())
+			return false;
+
+		auto Dropped = Dropped_.find(id);
+		bool Queued = false;
+		for (const auto ClientSocket : User->second) {
+			if (Dropped != Dropped_.end() && Dropped->second.count(ClientSocket))
+				continue;
+			auto Client = Recipients_.find(ClientSocket);
+			if (Client != Recipients_.end() && Enqueue(*Client->second, SharedPayload))
+				Queued = true;
+		}
+		return Queued;
+	}
+
+	void UI_WebSocketClientServer::SendToAll(std::uint64_t id, const std::string &Payload) {
+		SendToAll(id, std::make_shared<const std::string>(Payload));
+	}
+
+	void UI_WebSocketClientServer::SendToAll(std::uint64_t id,
+											 const std::shared_ptr<const std::string> &Payload) {
+		std::shared_lock G(IndexMutex_);
+
+		auto Dropped = Dropped_.find(id);
+		for (const auto &[ClientSocket, Client] : Recipients_) {
+			if (Dropped != Dropped_.end() && Dropped->second.count(ClientSocket))
+				continue;
+			Enqueue(*Client, Payload);
+		}
 	}
 
 	UI_WebSocketClientServer::ClientList::iterator UI_WebSocketClientServer::FindWSClient(
@@ -194,6 +305,48 @@ namespace OpenWifi {
 		EndConnection(Client);
 	}
 
+	void UI_WebSocketClientServer::OnSocketWritable(
+		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf) {
+		auto ClientSocket = pNf->socket().impl()->sockfd();
+		ClientPtr Client;
+		{
+			std::shared_lock G(IndexMutex_);
+			auto It = Recipients_.find(ClientSocket);
+			if (It == Recipients_.end())
+				return;
+			Client = It->second;
+		}
+
+		//	Do not monopolize the reactor: other sockets get their turn between bursts.
+		constexpr std::size_t MaxFramesPerNotification = 64;
+
+		try {
+			std::lock_guard G(Client->OutboundMutex_);
+			std::size_t FramesSent = 0;
+			while (!Client->OutboundQueue_.empty() && FramesSent < MaxFramesPerNotification) {
+				const auto &Frame = *Client->OutboundQueue_.front();
+				auto BytesSent = Client->WS_->sendFrame(Frame.c_str(), (int)Frame.size());
+				if (BytesSent <= 0) {
+					//	The socket would block, we will be called again once it drains.
+					break;
+				}
+				Client->OutboundQueue_.pop_front();
+				FramesSent++;
+			}
+			NotificationsSent_ += FramesSent;
+
+			if (Client->OutboundQueue_.empty())
+				RemoveWritableHandler(*Client);
+			return;
+		} catch (...) {
+		}
+
+		std::lock_guard G(LocalMutex_);
+		auto It = Clients_.find(ClientSocket);
+		if (It != end(Clients_))
+			EndConnection(It);
+	}
+
 	void UI_WebSocketClientServer::OnSocketReadable(
 		[[maybe_unused]] const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 
@@ -262,6 +415,7 @@ namespace OpenWifi {
 						WelcomeMessage.stringify(OS);
 						Client->second->WS_->sendFrame(OS.str().c_str(), (int)OS.str().size());
 						Client->second->UserName_ = Client->second->UserInfo_.userinfo.email;
+						IndexClient(Client->first, Client->second);
 					} else {
 						Poco::JSON::Object WelcomeMessage;
 						WelcomeMessage.set("error", "Invalid token. Closing connection.");
@@ -281,6 +435,7 @@ namespace OpenWifi {
 							Client->second->Filter_.emplace_back((std::uint64_t)Filter);
 						}
 						std::sort(begin(Client->second->Filter_), end(Client->second->Filter_));
+						IndexClient(Client->first, Client->second);
 						return;
 					}
 
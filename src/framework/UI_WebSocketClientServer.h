@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "Poco/JSON/Object.h"
 #include "Poco/Net/SocketNotification.h"
@@ -35,6 +41,12 @@ namespace OpenWifi {
 		bool SocketRegistered_ = false;
 		std::vector<std::uint64_t> Filter_;
 		SecurityObjects::UserInfoAndPolicy UserInfo_;
+		Poco::Net::SocketReactor *Reactor_ = nullptr;
+
+		//	Notifications waiting for the socket to become writable.
+		std::mutex OutboundMutex_;
+		std::deque<std::shared_ptr<const std::string>> OutboundQueue_;
+		bool WritableRegistered_ = false;
 
 		UI_WebSocketClientInfo(Poco::Net::WebSocket &WS, const std::string &Id,
 							   const std::string &username) {
@@ -44,6 +56,12 @@ namespace OpenWifi {
 		}
 	};
 
+	/*
+	 * 	Notifications are serialized once and queued for every client that has not dropped their
+	 * type. Each client socket belongs to one reactor of a small pool, and that reactor writes the
+	 * queue when the socket is writable. A client whose queue is full loses new notifications
+	 * instead of delaying the others.
+	 */
 	class UI_WebSocketClientServer : public SubSystemServer, Poco::Runnable {
 
 	  public:
@@ -57,7 +75,6 @@ namespace OpenWifi {
 		int Start() override;
 		void Stop() override;
 		void run() override;
-		Poco::Net::SocketReactor &Reactor() { return Reactor_; }
 		void NewClient(Poco::Net::WebSocket &WS, const std::string &Id, const std::string &UserName,
 					   std::uint64_t TID);
 		void SetProcessor(UI_WebSocketClientProcessor *F);
@@ -67,6 +84,8 @@ namespace OpenWifi {
 		template <typename T>
 		bool SendUserNotification(const std::string &userName,
 								  const WebSocketNotification<T> &Notification) {
+			if (!HasRecipients(Notification.type_id))
+				return false;
 
 			Poco::JSON::Object Payload;
 			Notification.to_json(Payload);
@@ -79,25 +98,31 @@ namespace OpenWifi {
 		}
 
 		template <typename T> void SendNotification(const WebSocketNotification<T> &Notification) {
+			if (!HasRecipients(Notification.type_id))
+				return;
+
 			Poco::JSON::Object Payload;
 			Notification.to_json(Payload);
 			Poco::JSON::Object Msg;
 			Msg.set("notification", Payload);
 			std::ostringstream OO;
 			Msg.stringify(OO);
-			SendToAll(Notification.type_id, OO.str());
+			SendToAll(Notification.type_id, std::make_shared<const std::string>(OO.str()));
 		}
 
 		[[nodiscard]] bool SendToUser(const std::string &userName, std::uint64_t id,
 									  const std::string &Payload);
 		void SendToAll(std::uint64_t id, const std::string &Payload);
+		void SendToAll(std::uint64_t id, const std::shared_ptr<const std::string> &Payload);
+		bool HasRecipients(std::uint64_t id);
 
 		struct NotificationEntry {
 			std::uint64_t id = 0;
 			std::string helper;
 		};
 
-		using ClientList = std::map<int, std::unique_ptr<UI_WebSocketClientInfo>>;
+		using ClientPtr = std::shared_ptr<UI_WebSocketClientInfo>;
+		using ClientList = std::map<int, ClientPtr>;
 		using NotificationTypeIdVec = std::vector<NotificationEntry>;
 
 		void RegisterNotifications(const NotificationTypeIdVec &Notifications);
@@ -106,8 +131,9 @@ namespace OpenWifi {
 	  private:
 		volatile bool Running_ = false;
 		std::atomic_uint64_t UsersConnected_ = 0;
-		Poco::Net::SocketReactor Reactor_;
-		Poco::Thread ReactorThread_;
+		std::vector<std::unique_ptr<Poco::Net::SocketReactor>> Reactors_;
+		std::vector<std::unique_ptr<Poco::Thread>> ReactorThreads_;
+		std::atomic_uint64_t NextReactor_ = 0;
 		Poco::Thread CleanerThread_;
 		std::recursive_mutex LocalMutex_;
 		bool GeoCodeEnabled_ = false;
@@ -119,12 +145,30 @@ namespace OpenWifi {
 		std::vector<ClientList::iterator> ToBeRemoved_;
 		std::uint64_t TID_ = 0;
 
+		//	Authenticated clients by socket, by user, and the sockets that dropped each notification.
+		std::shared_mutex IndexMutex_;
+		std::unordered_map<int, ClientPtr> Recipients_;
+		std::unordered_map<std::string, std::unordered_set<int>> Users_;
+		std::unordered_map<std::uint64_t, std::unordered_set<int>> Dropped_;
+
+		std::uint64_t MaxQueuedNotifications_ = 1000;
+		std::atomic_uint64_t NotificationsSent_ = 0;
+		std::atomic_uint64_t NotificationsDropped_ = 0;
+		std::uint64_t LastDroppedReported_ = 0;
+
 		UI_WebSocketClientServer() noexcept;
 		void EndConnection(ClientList::iterator Client);
 
+		void IndexClient(int ClientSocket, const ClientPtr &Client);
+		void RemoveFromIndex(int ClientSocket, const UI_WebSocketClientInfo &Client);
+		bool Enqueue(UI_WebSocketClientInfo &Client,
+					 const std::shared_ptr<const std::string> &Payload);
+		void RemoveWritableHandler(UI_WebSocketClientInfo &Client);
+
 		void OnSocketReadable(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf);
 		void OnSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void OnSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
+		void OnSocketWritable(const Poco::AutoPtr<Poco::Net::WritableNotification> &pNf);
 
 		ClientList::iterator FindWSClient(std::lock_guard<std::recursive_mutex> &G,
 										  int ClientSocket);
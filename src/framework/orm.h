@@ -9,11 +9,14 @@
 #pragma once
 
 #include <array>
+#include <cctype>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "Poco/Data/RecordSet.h"
@@ -231,6 +234,11 @@ namespace ORM {
 
 				CreateFields_ += FieldName + " " + FieldTypeToChar(Type_, i.Type, i.Size) +
 								 (i.Index ? " unique primary key" : "");
+				if (i.Index && KeyField_.empty()) {
+					KeyField_ = FieldName;
+					KeyPlace_ = Place;
+					KeyNumeric_ = i.Type == FT_INT || i.Type == FT_BIGINT || i.Type == FT_REAL;
+				}
 				SelectFields_ += FieldName;
 				UpdateFields_ += FieldName + "=?";
 				SelectList_ += "?";
@@ -572,6 +580,46 @@ namespace ORM {
 			return false;
 		}
 
+		/*
+		 * 	Keyset paging on the primary key: returns up to HowMany records whose key sorts after
+		 * After (all of them from the start when After is empty) and leaves the key of the last
+		 * record in After. Cost does not grow with the position in the table.
+		 */
+		bool GetRecordsAfter(std::string &After, uint64_t HowMany, RecordVec &Records,
+							 const std::string &Where = "") {
+			if (KeyField_.empty())
+				return false;
+			try {
+				Poco::Data::Session Session = Pool_.get();
+				Poco::Data::Statement Select(Session);
+				RecordList RL;
+				std::string Seek = After.empty() ? "" : KeyField_ + ">" + KeyLiteral(After);
+				std::string Condition = Where.empty() ? Seek
+												: (Seek.empty() ? Where
+																: "(" + Where + ") and " + Seek);
+				std::string St = "select " + SelectFields_ + " from " + TableName_ +
+								 (Condition.empty() ? "" : " where " + Condition) + " order by " +
+								 KeyField_ + " asc" + ComputeRange(0, HowMany);
+
+				Select << St, Poco::Data::Keywords::into(RL);
+				Select.execute();
+
+				if (Select.rowsExtracted() > 0) {
+					for (auto &i : RL) {
+						RecordType R;
+						Convert(i, R);
+						Records.template emplace_back(R);
+					}
+					After = KeyOf(RL.back(), std::make_index_sequence<RecordTuple::length>{});
+					return true;
+				}
+				return false;
+			} catch (const Poco::Exception &E) {
+				Logger_.log(E);
+			}
+			return false;
+		}
+
 		template <typename T>
 		bool UpdateRecord(field_name_t FieldName, const T &Value, const RecordType &R) {
 			try {
@@ -714,10 +762,12 @@ namespace ORM {
 
 				uint64_t Offset = 0;
 				uint64_t Batch = 50;
+				std::string After;
 				bool Done = false;
 				while (!Done) {
 					std::vector<RecordType> Records;
-					if (GetRecords(Offset, Batch, Records, WhereClause)) {
+					if (KeyField_.empty() ? GetRecords(Offset, Batch, Records, WhereClause)
+										  : GetRecordsAfter(After, Batch, Records, WhereClause)) {
 						for (const auto &i : Records) {
 							if (!F(i))
 								return true;
@@ -1007,6 +1057,8 @@ namespace ORM {
 
 		Poco::Logger &Logger() { return Logger_; }
 
+		[[nodiscard]] inline const std::string &KeyField() const { return KeyField_; }
+
 		inline bool DeleteRecordsFromCache(const char *FieldName, const std::string &Value) {
 			if (Cache_)
 				Cache_->Delete(FieldName, Value);
@@ -1033,5 +1085,45 @@ namespace ORM {
 		std::string UpdateFields_;
 		std::vector<std::string> IndexCreation_;
 		std::map<std::string, int> FieldNames_;
+		std::string KeyField_;
+		std::size_t KeyPlace_ = 0;
+		bool KeyNumeric_ = false;
+
+		template <std::size_t... I>
+		std::string KeyOf(const RecordTuple &T, std::index_sequence<I...>) const {
+			std::string R;
+			(
+				[&] {
+					if (I != KeyPlace_)
+						return;
+					using E = std::decay_t<decltype(T.template get<I>())>;
+					if constexpr (std::is_same_v<E, std::string>)
+						R = T.template get<I>();
+					else if constexpr (std::is_arithmetic_v<E>)
+						R = std::to_string(T.template get<I>());
+				}(),
+				...);
+			return R;
+		}
+
+		//	The key comes back from clients inside a cursor: it is never pasted into SQL as is.
+		[[nodiscard]] std::string KeyLiteral(const std::string &Key) const {
+			if (KeyNumeric_) {
+				std::string R;
+				for (const auto c : Key)
+					if (std::isdigit(static_cast<unsigned char>(c)) || c == '.' ||
+						(R.empty() && c == '-'))
+						R += c;
+				return (R.empty() || R == "-" || R == ".") ? "0" : R;
+			}
+			std::string R{"'"};
+			for (const auto c : Key) {
+				if (c == '\'' || (c == '\\' && Type_ == OpenWifi::DBType::mysql))
+					R += c;
+				R += c;
+			}
+			R += '\'';
+			return R;
+		}
 	};
 } // namespace ORM
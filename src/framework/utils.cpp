@@ -13,6 +13,7 @@
 #include <ctime>
 #include <string>
 #include <algorithm>
+#include <array>
 
 #include <resolv.h>
 
@@ -556,38 +557,140 @@ namespace OpenWifi::Utils {
 		return false;
 	}
 
+	//	Decode values: 0-63 for data, B64_SKIP for whitespace, B64_END for padding, B64_BAD otherwise.
+	static constexpr std::uint8_t B64_SKIP = 0x80, B64_END = 0xfe, B64_BAD = 0xff;
+	static constexpr auto Base64DecodeTable = [] {
+		std::array<std::uint8_t, 256> T{};
+		for (auto &t : T)
+			t = B64_BAD;
+		const char *Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		for (std::uint8_t i = 0; i < 64; i++)
+			T[(std::uint8_t)Alphabet[i]] = i;
+		T['-'] = 62;
+		T['_'] = 63;
+		T[' '] = T['\t'] = T['\r'] = T['\n'] = B64_SKIP;
+		T['='] = B64_END;
+		return T;
+	}();
+
+	//	Full quads are decoded straight into the output. Whitespace or padding falls back to one
+	//	character at a time.
+	static bool Base64Decode(const char *In, std::size_t Size, std::vector<std::uint8_t> &Out) {
+		Out.resize(Size / 4 * 3 + 3);
+		auto *Dst = Out.data();
+		const auto *Src = reinterpret_cast<const std::uint8_t *>(In);
+		std::size_t i = 0;
+		std::uint32_t Acc = 0;
+		int Sextets = 0;
+		while (i < Size) {
+			if (Sextets == 0) {
+				while (i + 4 <= Size) {
+					std::uint32_t a = Base64DecodeTable[Src[i]], b = Base64DecodeTable[Src[i + 1]],
+								  c = Base64DecodeTable[Src[i + 2]], d = Base64DecodeTable[Src[i + 3]];
+					if ((a | b | c | d) & 0xc0)
+						break;
+					std::uint32_t V = (a << 18) | (b << 12) | (c << 6) | d;
+					Dst[0] = (std::uint8_t)(V >> 16);
+					Dst[1] = (std::uint8_t)(V >> 8);
+					Dst[2] = (std::uint8_t)V;
+					Dst += 3;
+					i += 4;
+				}
+				if (i >= Size)
+					break;
+			}
+			auto v = Base64DecodeTable[Src[i++]];
+			if (v == B64_SKIP)
+				continue;
+			if (v == B64_END)
+				break;
+			if (v == B64_BAD)
+				return false;
+			Acc = (Acc << 6) | v;
+			if (++Sextets == 4) {
+				Dst[0] = (std::uint8_t)(Acc >> 16);
+				Dst[1] = (std::uint8_t)(Acc >> 8);
+				Dst[2] = (std::uint8_t)Acc;
+				Dst += 3;
+				Acc = 0;
+				Sextets = 0;
+			}
+		}
+		if (Sextets == 1)
+			return false;
+		if (Sextets == 2) {
+			*Dst++ = (std::uint8_t)(Acc >> 4);
+		} else if (Sextets == 3) {
+			*Dst++ = (std::uint8_t)(Acc >> 10);
+			*Dst++ = (std::uint8_t)(Acc >> 2);
+		}
+		Out.resize(Dst - Out.data());
+		return true;
+	}
+
+	//	One inflate state per thread, reset between payloads instead of allocated for each one.
+	struct ThreadInflater {
+		z_stream Stream{};
+		bool Ready = false;
+		ThreadInflater() { Ready = inflateInit(&Stream) == Z_OK; }
+		~ThreadInflater() {
+			if (Ready)
+				inflateEnd(&Stream);
+		}
+	};
+
 	bool ExtractBase64CompressedData(const std::string &CompressedData,
 									 std::string &UnCompressedData, uint64_t compress_sz) {
-		std::istringstream ifs(CompressedData);
-		Poco::Base64Decoder b64in(ifs);
-		std::ostringstream ofs;
-		Poco::StreamCopier::copyStream(b64in, ofs);
-
-		int factor = 20;
-		unsigned long MaxSize = compress_sz ? (unsigned long)(compress_sz + 5000)
-											: (unsigned long)(ofs.str().size() * factor);
+		static thread_local std::vector<std::uint8_t> Compressed;
+		static thread_local ThreadInflater Inflater;
+
+		if (!Inflater.Ready || !Base64Decode(CompressedData.data(), CompressedData.size(), Compressed) ||
+			Compressed.empty())
+			return false;
+
+		//	Same ceiling as before: 300 times the compressed size, or the announced size.
+		std::size_t Limit = std::max<std::size_t>(Compressed.size() * 300, compress_sz + 5000);
+		//	A little room past the announced size lets inflate read the trailer in the same pass.
+		std::size_t Size = compress_sz ? compress_sz + 64 : Compressed.size() * 20;
+		if (Size > Limit)
+			Size = Limit;
+
+		auto &Stream = Inflater.Stream;
+		inflateReset(&Stream);
+		Stream.next_in = Compressed.data();
+		Stream.avail_in = (uInt)Compressed.size();
+
+		UnCompressedData.resize(Size);
+		std::size_t Produced = 0;
+		bool Success = false;
 		while (true) {
-			std::vector<uint8_t> UncompressedBuffer(MaxSize);
-			unsigned long FinalSize = MaxSize;
-			auto status = uncompress((uint8_t *)&UncompressedBuffer[0], &FinalSize,
-									 (uint8_t *)ofs.str().c_str(), ofs.str().size());
-			if (status == Z_OK) {
-				UncompressedBuffer[FinalSize] = 0;
-				UnCompressedData = (char *)&UncompressedBuffer[0];
-				return true;
+			Stream.next_out = reinterpret_cast<Bytef *>(&UnCompressedData[Produced]);
+			Stream.avail_out = (uInt)(UnCompressedData.size() - Produced);
+			auto status = inflate(&Stream, Z_NO_FLUSH);
+			Produced = UnCompressedData.size() - Stream.avail_out;
+			if (status == Z_STREAM_END) {
+				Success = true;
+				break;
 			}
-			if (status == Z_BUF_ERROR) {
-				if (factor < 300) {
-					factor += 10;
-					MaxSize = ofs.str().size() * factor;
-					continue;
-				} else {
-					return false;
-				}
+			if (status != Z_OK && status != Z_BUF_ERROR)
+				break;
+			if (Stream.avail_out != 0) {
+				//	No progress possible: the input is truncated.
+				if (Stream.avail_in == 0)
+					break;
+				continue;
 			}
-			return false;
+			if (UnCompressedData.size() >= Limit)
+				break;
+			UnCompressedData.resize(std::min(Limit, UnCompressedData.size() * 2));
 		}
-		return false;
+		UnCompressedData.resize(Success ? Produced : 0);
+
+		if (Compressed.capacity() > 4 * 1024 * 1024) {
+			Compressed.clear();
+			Compressed.shrink_to_fit();
+		}
+		return Success;
 	}
 
 	bool IsAlphaNumeric(const std::string &s) {
@@ -13,6 +13,7 @@
 #include "Poco/Net/SecureStreamSocketImpl.h"
 #include "nlohmann/json.hpp"
 
+#include "Poco/Environment.h"
 #include "Poco/NObserver.h"
 #include "Poco/Net/SocketNotification.h"
 #include "Poco/Net/NetException.h"
@@ -121,6 +122,19 @@ namespace OpenWifi {
 			ReactorThread_.start(Reactor_);
 			Utils::SetThreadName(ReactorThread_, "rt:devreactor");
 
+			auto NumberOfReactors = MicroServiceConfigGetInt("rtty.reactors",
+															 Poco::Environment::processorCount());
+			if (NumberOfReactors < 1)
+				NumberOfReactors = 1;
+			for (std::uint64_t i = 0; i < NumberOfReactors; ++i) {
+				auto Reactor = std::make_unique<Poco::Net::SocketReactor>();
+				auto Thread = std::make_unique<Poco::Thread>();
+				Thread->start(*Reactor);
+				Utils::SetThreadName(*Thread, fmt::format("rt:reactor:{}", i).c_str());
+				SessionReactors_.emplace_back(std::move(Reactor));
+				SessionReactorThreads_.emplace_back(std::move(Thread));
+			}
+
 			auto WebServerHttpParams = new Poco::Net::HTTPServerParams;
 			WebServerHttpParams->setMaxThreads(50);
 			WebServerHttpParams->setMaxQueued(200);
@@ -188,13 +202,23 @@ namespace OpenWifi {
 			WebServer_->stop();
 			Reactor_.stop();
 			ReactorThread_.join();
+			for (auto &Reactor : SessionReactors_)
+				Reactor->stop();
+			for (auto &Thread : SessionReactorThreads_)
+				Thread->join();
+			SessionReactorThreads_.clear();
+			SessionReactors_.clear();
 		}
 		poco_information(Logger(),"Stopped...");
 	}
 
+	Poco::Net::SocketReactor &RTTYS_server::NextSessionReactor() {
+		return *SessionReactors_[NextSessionReactor_++ % SessionReactors_.size()];
+	}
+
+	//	The TLS handshake is done without holding the server lock, only the registration needs it.
 	void RTTYS_server::onDeviceAccept(const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 		try {
-			std::lock_guard	Lock(ServerMutex_);
 			Poco::Net::SocketAddress Client;
 			Poco::Net::StreamSocket NewSocket(pNf->socket().impl()->acceptConnection(Client));
 			if (NewSocket.secure()) {
@@ -235,16 +259,18 @@ namespace OpenWifi {
 		}
 	}
 
-	void RTTYS_server::RemoveClientEventHandlers(Poco::Net::WebSocket &Socket) {
+	void RTTYS_server::RemoveClientEventHandlers(const std::shared_ptr<RTTYS_EndPoint> &EndPoint) {
+		auto &Socket = *EndPoint->WSSocket_;
 		int fd = Socket.impl()->sockfd();
-		if(Reactor_.has(Socket)) {
-			Reactor_.removeEventHandler(
+		auto Reactor = EndPoint->ClientReactor_;
+		if(Reactor!=nullptr && Reactor->has(Socket)) {
+			Reactor->removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 							*this, &RTTYS_server::onClientSocketReadable));
-			Reactor_.removeEventHandler(
+			Reactor->removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 							*this, &RTTYS_server::onClientSocketShutdown));
-			Reactor_.removeEventHandler(Socket,
+			Reactor->removeEventHandler(Socket,
 										Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 											*this, &RTTYS_server::onClientSocketError));
 		}
@@ -260,54 +286,71 @@ namespace OpenWifi {
 		Poco::Timespan TS2(300, 100);
 		Socket.setReceiveTimeout(TS2);
 
-		Reactor_.addEventHandler(Socket,
+		std::unique_lock	Lock(ServerMutex_);
+		auto &Reactor = NextSessionReactor();
+		int fd = Socket.impl()->sockfd();
+		Sockets_[fd] = std::make_shared<SecureSocketPair>(Socket, std::move(P), valid, cid, cn,
+														  Reactor, Buffers_);
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketReadable));
-		Reactor_.addEventHandler(Socket,
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketShutdown));
-		Reactor_.addEventHandler(Socket,
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 									 *this, &RTTYS_server::onConnectedDeviceSocketError));
-		int fd = Socket.impl()->sockfd();
-		Sockets_[fd] = std::make_unique<SecureSocketPair>(Socket, std::move(P), valid, cid, cn);
 	}
 
 	void RTTYS_server::RemoveSocket(const Poco::Net::Socket &Socket) {
 		auto hint = Sockets_.find(Socket.impl()->sockfd());
 		if(hint!=end(Sockets_)) {
-			Reactor_.removeEventHandler(
+			auto &Reactor = hint->second->reactor;
+			Reactor.removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 							*this, &RTTYS_server::onConnectedDeviceSocketReadable));
-			Reactor_.removeEventHandler(
+			Reactor.removeEventHandler(
 				Socket, Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 							*this, &RTTYS_server::onConnectedDeviceSocketShutdown));
-			Reactor_.removeEventHandler(Socket,
+			Reactor.removeEventHandler(Socket,
 										Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 											*this, &RTTYS_server::onConnectedDeviceSocketError));
 			Sockets_.erase(hint);
 		}
 	}
 
+	//	The UI client is served by the same reactor as its device when the device is already there.
 	void RTTYS_server::AddClientEventHandlers(Poco::Net::WebSocket &Socket,
 											  std::shared_ptr<RTTYS_EndPoint> EndPoint) {
 		Clients_[Socket.impl()->sockfd()] = EndPoint;
-		Reactor_.addEventHandler(Socket,
+		auto DeviceHint = EndPoint->DeviceIsAttached_ ? Sockets_.find(EndPoint->Device_fd) : Sockets_.end();
+		auto &Reactor = DeviceHint != Sockets_.end() ? DeviceHint->second->reactor : NextSessionReactor();
+		EndPoint->ClientReactor_ = &Reactor;
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ReadableNotification>(
 									 *this, &RTTYS_server::onClientSocketReadable));
-		Reactor_.addEventHandler(Socket,
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ShutdownNotification>(
 									 *this, &RTTYS_server::onClientSocketShutdown));
-		Reactor_.addEventHandler(Socket,
+		Reactor.addEventHandler(Socket,
 								 Poco::NObserver<RTTYS_server, Poco::Net::ErrorNotification>(
 									 *this, &RTTYS_server::onClientSocketError));
 	}
 
 	int RTTYS_server::SendBytes(const std::shared_ptr<RTTYS_EndPoint> & Conn, const Poco::Net::Socket &Socket, const unsigned char *buffer, std::size_t len) {
+		std::lock_guard	G(Conn->Mutex_);
 		Conn->tx += len;
 		return Socket.impl()->sendBytes(buffer,len);
 	}
 
+	std::shared_ptr<RTTYS_EndPoint> RTTYS_server::FindConnected(int fd) {
+		std::shared_lock	Lock(ServerMutex_);
+		auto EndPoint = Connected_.find(fd);
+		if (EndPoint == end(Connected_))
+			return nullptr;
+		return EndPoint->second;
+	}
+
 	std::shared_ptr<RTTYS_EndPoint> RTTYS_server::FindRegisteredEndPoint(const std::string &Id,
 														   const std::string &Token) {
 		auto EndPoint = EndPoints_.find(Id);
@@ -337,6 +380,9 @@ namespace OpenWifi {
 			//	find this device in our connectio end points...
 			poco_information(Logger(),fmt::format("{}: Looking for session", id_));
 
+			//	Give the device a moment before answering; never while holding the server lock.
+			Poco::Thread::trySleep(50);
+			std::unique_lock	Lock(ServerMutex_);
 			auto ConnectionHint = EndPoints_.find(id_);
 			if (ConnectionHint == end(EndPoints_) || ConnectionHint->second->Token_ != token_) {
 				poco_warning(Logger(), fmt::format("{}: Unknown session from device.", id_));
@@ -366,7 +412,6 @@ namespace OpenWifi {
 								 fmt::format("Device mTLS {} does not require mTLS from {}.",
 											 SocketHint->second->cn, SocketHint->second->cid));
 			}
-			Poco::Thread::trySleep(50);
 
 			ConnectionEp->Device_fd = fd;
 			Connected_[fd] = ConnectionEp;
@@ -387,10 +432,16 @@ namespace OpenWifi {
 								id_, desc_));
 				return false;
 			}
-			ConnectionEp->DeviceConnected_ = std::chrono::high_resolution_clock::now();
-			ConnectionEp->DeviceIsAttached_ = true;
-			ConnectionEp->DeviceSocket_ = Socket;
-			if(ConnectionEp->WSSocket_!= nullptr && ConnectionEp->WSSocket_->impl()!= nullptr) {
+			bool SendLogin;
+			{
+				std::lock_guard	G(ConnectionEp->Mutex_);
+				ConnectionEp->DeviceConnected_ = std::chrono::high_resolution_clock::now();
+				ConnectionEp->DeviceIsAttached_ = true;
+				ConnectionEp->DeviceSocket_ = Socket;
+				SendLogin = ConnectionEp->WSSocket_!= nullptr && ConnectionEp->WSSocket_->impl()!= nullptr;
+			}
+			Lock.unlock();
+			if(SendLogin) {
 				poco_information(Logger(),fmt::format("REG{}: Device registered, Client Registered - sending login", ConnectionEp->SerialNumber_));
 				Login(Socket, ConnectionEp);
 			} else {
@@ -419,136 +470,143 @@ namespace OpenWifi {
 	}
 
 	void RTTYS_server::EmptyBuffer(int fd, const std::uint8_t *buffer, std::size_t len) {
-		auto EndPoint = Connected_.find(fd);
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
-			SendToClient(*EndPoint->second->WSSocket_, buffer,
+		auto EndPoint = FindConnected(fd);
+		if (EndPoint == nullptr)
+			return;
+		std::lock_guard	G(EndPoint->Mutex_);
+		if (EndPoint->WSSocket_!= nullptr && EndPoint->WSSocket_->impl() != nullptr) {
+			SendToClient(*EndPoint->WSSocket_, buffer,
 						 len);
-			EndPoint->second->rx += len;
-			// std::cout << "Total: " << EndPoint->second->rx << "   bytes now: " << len << std::endl;
+			EndPoint->rx += len;
 		}
 	}
 
 	void RTTYS_server::onConnectedDeviceSocketReadable(
 		const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 
-		std::lock_guard	Lock(ServerMutex_);
 		int fd = pNf->socket().impl()->sockfd();
 
-		try {
-
+		//	Each device socket is only served by its own reactor, so its buffer needs no lock.
+		std::shared_ptr<SecureSocketPair>	Pair;
+		{
+			std::shared_lock	Lock(ServerMutex_);
 			auto hint = Sockets_.find(fd);
 			if(hint==end(Sockets_)) {
 				poco_error(Logger(),fmt::format("{}: unknown socket",fd));
 				return;
 			}
+			Pair = hint->second;
+		}
 
-			Poco::FIFOBuffer &buffer = *hint->second->buffer;
-
-			int received_bytes=0;
-			std::uint8_t 	agg_buffer[RTTY_RECEIVE_BUFFER];
-			std::size_t 	agg_buf_pos=0;
-
-			try {
-				Poco::Timespan	TS(5,0);
-				received_bytes = hint->second->socket.receiveBytes(buffer);
-				if(received_bytes==0) {
-					poco_warning(Logger(), "Device Closing connection - 0 bytes received.");
-					EndConnection( pNf->socket(), __func__, __LINE__ );
-					return;
+		bool good = true;
+		try {
+			Poco::FIFOBuffer &buffer = *Pair->buffer;
+			thread_local std::vector<std::uint8_t> agg_buffer;
+			agg_buffer.clear();
+
+			//	TLS may hold decrypted bytes the socket will not signal, so keep reading while it has some,
+			//	but only for a few rounds so one busy session does not hold up the others on this reactor.
+			//	Terminal data is sent to the browser after every round.
+			constexpr int MaxReceiveRounds = 8;
+			int Rounds = 0;
+			do {
+				int received_bytes=0;
+				try {
+					RTTYS_BufferPool::MakeRoom(buffer);
+					received_bytes = Pair->socket.receiveBytes(buffer);
+					if(received_bytes==0) {
+						poco_warning(Logger(), "Device Closing connection - 0 bytes received.");
+						good = false;
+						break;
+					}
+				} catch (const Poco::TimeoutException &E) {
+					poco_warning(Logger(), "Receive timeout");
+					good = false;
+					break;
+				} catch (const Poco::Net::NetException &E) {
+					Logger().log(E);
+					good = false;
+					break;
 				}
-			} catch (const Poco::TimeoutException &E) {
-				poco_warning(Logger(), "Receive timeout");
-				EndConnection( pNf->socket(), __func__, __LINE__ );
-				return;
-			} catch (const Poco::Net::NetException &E) {
-				Logger().log(E);
-				EndConnection( pNf->socket(), __func__, __LINE__ );
-				return;
-			}
-
-			bool good = true;
 
-			while (!buffer.isEmpty() && good) {
+				while (!buffer.isEmpty() && good) {
 
-				if(buffer.used() < RTTY_HDR_SIZE) {
-					if(agg_buf_pos>0) {
-						EmptyBuffer(fd, agg_buffer, agg_buf_pos);
+					if(buffer.used() < RTTY_HDR_SIZE) {
+						// poco_debug(Logger(),fmt::format("Not enough data in the pipe for header",buffer.used()));
+						break;
 					}
-					// poco_debug(Logger(),fmt::format("Not enough data in the pipe for header",buffer.used()));
-					return;
-				}
 
-				std::uint8_t header[RTTY_HDR_SIZE];
-				buffer.peek((char*)header,RTTY_HDR_SIZE);
+					std::uint8_t header[RTTY_HDR_SIZE];
+					buffer.peek((char*)header,RTTY_HDR_SIZE);
 
-				std::uint8_t LastCommand = header[0];
-				std::uint16_t msg_len = (header[1] << 8) + header[2];
+					std::uint8_t LastCommand = header[0];
+					std::uint16_t msg_len = (header[1] << 8) + header[2];
 
-				if(buffer.used()<(RTTY_HDR_SIZE+msg_len)) {
-					if(agg_buf_pos>0) {
-						EmptyBuffer(fd, agg_buffer, agg_buf_pos);
+					if(buffer.used()<(RTTY_HDR_SIZE+msg_len)) {
+						// poco_debug(Logger(),fmt::format("Not enough data in the pipe for command data",buffer.used()));
+						break;
 					}
-					// poco_debug(Logger(),fmt::format("Not enough data in the pipe for command data",buffer.used()));
-					return;
-				}
 
-				buffer.drain(RTTY_HDR_SIZE);
-
-				switch (LastCommand) {
-					case RTTYS_EndPoint::msgTypeRegister: {
-						good = do_msgTypeRegister(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeLogin: {
-						good = do_msgTypeLogin(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeLogout: {
-						good = do_msgTypeLogout(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeTermData: {
-						good = do_msgTypeTermData(pNf->socket(), buffer, msg_len, agg_buffer, agg_buf_pos);
-					} break;
-					case RTTYS_EndPoint::msgTypeWinsize: {
-						good = do_msgTypeWinsize(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeCmd: {
-						good = do_msgTypeCmd(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeHeartbeat: {
-						good = do_msgTypeHeartbeat(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeFile: {
-						good = do_msgTypeFile(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeHttp: {
-						good = do_msgTypeHttp(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeAck: {
-						good = do_msgTypeAck(pNf->socket(), buffer, msg_len);
-					} break;
-					case RTTYS_EndPoint::msgTypeMax: {
-						good = do_msgTypeMax(pNf->socket(), buffer, msg_len);
-					} break;
-					default: {
-						poco_warning(Logger(),
-									 fmt::format("Unknown command {}. GW closing connection.",
-												 (int)LastCommand));
-						good = false;
+					buffer.drain(RTTY_HDR_SIZE);
+
+					switch (LastCommand) {
+						case RTTYS_EndPoint::msgTypeRegister: {
+							good = do_msgTypeRegister(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeLogin: {
+							good = do_msgTypeLogin(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeLogout: {
+							good = do_msgTypeLogout(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeTermData: {
+							good = do_msgTypeTermData(pNf->socket(), buffer, msg_len, agg_buffer);
+						} break;
+						case RTTYS_EndPoint::msgTypeWinsize: {
+							good = do_msgTypeWinsize(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeCmd: {
+							good = do_msgTypeCmd(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeHeartbeat: {
+							good = do_msgTypeHeartbeat(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeFile: {
+							good = do_msgTypeFile(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeHttp: {
+							good = do_msgTypeHttp(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeAck: {
+							good = do_msgTypeAck(pNf->socket(), buffer, msg_len);
+						} break;
+						case RTTYS_EndPoint::msgTypeMax: {
+							good = do_msgTypeMax(pNf->socket(), buffer, msg_len);
+						} break;
+						default: {
+							poco_warning(Logger(),
+										 fmt::format("Unknown command {}. GW closing connection.",
+													 (int)LastCommand));
+							good = false;
+						}
 					}
 				}
-			}
-
-			if(agg_buf_pos>0) {
-				EmptyBuffer(fd, agg_buffer, agg_buf_pos);
-			}
 
-			if (!good) {
-				EndConnection(pNf->socket(), __func__, __LINE__);
-			}
+				if(!agg_buffer.empty()) {
+					EmptyBuffer(fd, agg_buffer.data(), agg_buffer.size());
+					agg_buffer.clear();
+				}
+			} while (good && ++Rounds < MaxReceiveRounds && Pair->socket.available() > 0);
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
-			EndConnection(pNf->socket(), __func__,__LINE__);
+			good = false;
 		} catch (...) {
-			EndConnection(pNf->socket(), __func__,__LINE__);
+			good = false;
+		}
+
+		if (!good) {
+			std::unique_lock	Lock(ServerMutex_);
+			EndConnection(pNf->socket(), __func__, __LINE__);
 		}
 	}
 
@@ -566,18 +624,22 @@ namespace OpenWifi {
 	void RTTYS_server::onClientSocketReadable(
 		const Poco::AutoPtr<Poco::Net::ReadableNotification> &pNf) {
 
-		std::lock_guard	Lock(ServerMutex_);
-
-		auto Client = Clients_.end();
 		std::shared_ptr<RTTYS_EndPoint> Connection;
-		try {
-			Client = Clients_.find(pNf->socket().impl()->sockfd());
+		{
+			std::shared_lock	Lock(ServerMutex_);
+			auto Client = Clients_.find(pNf->socket().impl()->sockfd());
 			if (Client == end(Clients_)) {
 				poco_warning(Logger(), fmt::format("Cannot find client socket: {}",
 												   pNf->socket().impl()->sockfd()));
 				return;
 			}
 			Connection = Client->second;
+		}
+
+		//	The session lock is released before ending the connection: EndConnection needs the server lock.
+		bool End = false;
+		try {
+			std::lock_guard	G(Connection->Mutex_);
 			if(Connection->WSSocket_==nullptr || Connection->WSSocket_->impl()==nullptr) {
 				poco_warning(Logger(), fmt::format("WebSocket is no valid: {}",
 												   Connection->SerialNumber_));
@@ -600,8 +662,7 @@ namespace OpenWifi {
 			} break;
 			case Poco::Net::WebSocket::FRAME_OP_TEXT: {
 				if (ReceivedBytes == 0) {
-					EndConnection(Connection,__func__,__LINE__);
-					return;
+					End = true;
 				} else {
 					std::string Frame((const char *)FrameBuffer, ReceivedBytes);
 					try {
@@ -612,34 +673,29 @@ namespace OpenWifi {
 								auto cols = Doc["cols"];
 								auto rows = Doc["rows"];
 								if (!RTTYS_server().WindowSize(Connection,cols, rows)) {
-									EndConnection(Connection,__func__,__LINE__);
-									return;
+									End = true;
 								}
 							}
 						}
 					} catch (...) {
 						// just ignore parse errors
-						EndConnection(Connection,__func__,__LINE__);
-						return;
+						End = true;
 					}
 				}
 			} break;
 			case Poco::Net::WebSocket::FRAME_OP_BINARY: {
 				if (ReceivedBytes == 0) {
-					EndConnection(Connection,__func__,__LINE__);
-					return;
+					End = true;
 				} else {
 					poco_trace(Logger(),
 							   fmt::format("Sending {} key strokes to device.", ReceivedBytes));
 					if (!RTTYS_server().KeyStrokes(Connection, FrameBuffer, ReceivedBytes)) {
-						EndConnection(Connection,__func__,__LINE__);
-						return;
+						End = true;
 					}
 				}
 			} break;
 			case Poco::Net::WebSocket::FRAME_OP_CLOSE: {
-				EndConnection(Connection,__func__,__LINE__);
-				return;
+				End = true;
 			} break;
 
 			default: {
@@ -647,10 +703,12 @@ namespace OpenWifi {
 			}
 		} catch (...) {
 			poco_error(Logger(), "Frame readable shutdown.");
-			if (Client != Clients_.end() && Connection != nullptr) {
-				EndConnection(Connection,__func__,__LINE__);
-			}
-			return;
+			End = true;
+		}
+
+		if (End) {
+			std::unique_lock	Lock(ServerMutex_);
+			EndConnection(Connection,__func__,__LINE__);
 		}
 	}
 
@@ -712,7 +770,7 @@ namespace OpenWifi {
 									  Poco::Net::HTTPServerResponse &response,
 									  const std::string &Id) {
 
-		std::lock_guard	Lock(ServerMutex_);
+		std::unique_lock	Lock(ServerMutex_);
 
 		auto EndPoint = EndPoints_.find(Id);
 		if (EndPoint == end(EndPoints_)) {
@@ -728,25 +786,32 @@ namespace OpenWifi {
 
 		//	OK Create and register this WS client
 		try {
-			// EndPoint->second->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
-			EndPoint->second->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
-			EndPoint->second->ClientConnected_ = std::chrono::high_resolution_clock::now();
-			EndPoint->second->WSSocket_->setBlocking(false);
-			EndPoint->second->WSSocket_->setNoDelay(false);
-			EndPoint->second->WSSocket_->setKeepAlive(true);
-			Poco::Timespan	ST(600,0);
-			EndPoint->second->WSSocket_->setSendTimeout(ST);
-			EndPoint->second->WSSocket_->setSendBufferSize(1000000);
-			EndPoint->second->WSSocket_->setReceiveTimeout(ST);
-			EndPoint->second->WSSocket_->setReceiveBufferSize(1000000);
-			AddClientEventHandlers(*EndPoint->second->WSSocket_, EndPoint->second);
-			if (EndPoint->second->DeviceIsAttached_ && !EndPoint->second->completed_) {
-				poco_information(Logger(),fmt::format("CLN{}: Device registered, Client Registered - sending login", EndPoint->second->SerialNumber_));
-				auto hint = Sockets_.find(EndPoint->second->Device_fd);
-				if(hint!=end(Sockets_))
-					Login(hint->second->socket, EndPoint->second);
+			auto Connection = EndPoint->second;
+			{
+				std::lock_guard	G(Connection->Mutex_);
+				Connection->WSSocket_ = std::make_unique<Poco::Net::WebSocket>(request, response);
+				Connection->ClientConnected_ = std::chrono::high_resolution_clock::now();
+				Connection->WSSocket_->setBlocking(false);
+				Connection->WSSocket_->setNoDelay(false);
+				Connection->WSSocket_->setKeepAlive(true);
+				Poco::Timespan	ST(600,0);
+				Connection->WSSocket_->setSendTimeout(ST);
+				Connection->WSSocket_->setSendBufferSize(1000000);
+				Connection->WSSocket_->setReceiveTimeout(ST);
+				Connection->WSSocket_->setReceiveBufferSize(1000000);
+			}
+			AddClientEventHandlers(*Connection->WSSocket_, Connection);
+			if (Connection->DeviceIsAttached_ && !Connection->completed_) {
+				poco_information(Logger(),fmt::format("CLN{}: Device registered, Client Registered - sending login", Connection->SerialNumber_));
+				auto hint = Sockets_.find(Connection->Device_fd);
+				if(hint!=end(Sockets_)) {
+					//	Login waits for the device: do not hold up every other session meanwhile.
+					auto Pair = hint->second;
+					Lock.unlock();
+					Login(Pair->socket, Connection);
+				}
 			} else {
-				poco_information(Logger(),fmt::format("CLN{}: Device not registered, Client Registered", EndPoint->second->SerialNumber_));
+				poco_information(Logger(),fmt::format("CLN{}: Device not registered, Client Registered", Connection->SerialNumber_));
 			}
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -760,7 +825,7 @@ namespace OpenWifi {
 		Utils::SetThreadName("rt:janitor");
 		static auto LastStats = Utils::Now();
 
-		std::lock_guard	Lock(ServerMutex_);
+		std::unique_lock	Lock(ServerMutex_);
 		auto Now = std::chrono::high_resolution_clock::now();
 		for (auto EndPoint = EndPoints_.begin(); EndPoint != EndPoints_.end();) {
 			if ((Now - EndPoint->second->Created_) > 2min && !EndPoint->second->completed_) {
@@ -787,34 +852,46 @@ namespace OpenWifi {
 		}
 	}
 
+	//	The caller holds ServerMutex_ exclusively and must not hold the session lock.
 	std::map<std::string, std::shared_ptr<RTTYS_EndPoint>>::iterator RTTYS_server::EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t Line) {
-		auto hint1 = Sockets_.find(Connection->Device_fd);
-		if(hint1!=end(Sockets_))
-			RemoveSocket(hint1->second->socket);
-
-		Connected_.erase(Connection->Device_fd);
+		//	Another reactor may have ended this session already, and its descriptors may be reused.
+		auto hint2 = EndPoints_.find(Connection->Id_);
+		if(hint2==end(EndPoints_) || hint2->second!=Connection)
+			return end(EndPoints_);
+
+		if(Connection->DeviceIsAttached_) {
+			auto hint1 = Sockets_.find(Connection->Device_fd);
+			if(hint1!=end(Sockets_))
+				RemoveSocket(hint1->second->socket);
+			Connected_.erase(Connection->Device_fd);
+		}
 
 		//	find the client linked to this one...
+		std::lock_guard	G(Connection->Mutex_);
 		if(Connection->WSSocket_!= nullptr && Connection->WSSocket_->impl()!= nullptr) {
-			RemoveClientEventHandlers(*Connection->WSSocket_);
+			RemoveClientEventHandlers(Connection);
 			Connection->WSSocket_->close();
 		}
 		poco_debug(Logger(),fmt::format("Closing connection {}:{}", func, Line));
-		auto hint2 = EndPoints_.find(Connection->Id_);
 		return EndPoints_.erase(hint2);
 	}
 
 	void RTTYS_server::EndConnection(const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line) {
-		//	remove the device
+		//	remove the device, unless its descriptor already belongs to a newer connection
 		auto fd = Socket.impl()->sockfd();
+		auto Pair = Sockets_.find(fd);
+		if(Pair!=end(Sockets_) && Pair->second->socket!=Socket)
+			return;
 		RemoveSocket(Socket);
 
 		//	find the client linked to this one...
 		auto hint = Connected_.find(fd);
 		if(hint!=end(Connected_)) {
-			if(hint->second->WSSocket_!= nullptr && hint->second->WSSocket_->impl()!= nullptr) {
-				RemoveClientEventHandlers(*hint->second->WSSocket_);
-				hint->second->WSSocket_->close();
+			auto Connection = hint->second;
+			std::lock_guard	G(Connection->Mutex_);
+			if(Connection->WSSocket_!= nullptr && Connection->WSSocket_->impl()!= nullptr) {
+				RemoveClientEventHandlers(Connection);
+				Connection->WSSocket_->close();
 				auto id = hint->second->Id_;
 				Connected_.erase(hint);
 				EndPoints_.erase(id);
@@ -853,12 +930,13 @@ namespace OpenWifi {
 	}
 
 	bool RTTYS_server::ValidId(const std::string &Id) {
-		std::lock_guard	Lock(ServerMutex_);
+		std::shared_lock	Lock(ServerMutex_);
 		return EndPoints_.find(Id) != EndPoints_.end();
 	}
 
 	bool RTTYS_server::KeyStrokes(std::shared_ptr<RTTYS_EndPoint> Conn, const u_char *buf, size_t len) {
 
+		std::lock_guard	G(Conn->Mutex_);
 		if (len <= (sizeof(Conn->small_buf_) - RTTY_HDR_SIZE - 1)) {
 			Conn->small_buf_[0] = RTTYS_EndPoint::msgTypeTermData;
 			Conn->small_buf_[1] = ((len - 1 + 1) & 0xff00) >> 8;
@@ -997,14 +1075,17 @@ namespace OpenWifi {
 
 	bool RTTYS_server::do_msgTypeLogin(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, [[maybe_unused]] std::size_t msg_len) {
 		poco_debug(Logger(), "Asking for login");
-		auto EndPoint = Connected_.find(Socket.impl()->sockfd());
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
+		auto EndPoint = FindConnected(Socket.impl()->sockfd());
+		if (EndPoint == nullptr)
+			return false;
+		std::lock_guard	G(EndPoint->Mutex_);
+		if (EndPoint->WSSocket_!= nullptr && EndPoint->WSSocket_->impl() != nullptr) {
 			try {
 				nlohmann::json doc;
 				unsigned char Error = *buffer.begin();
 				buffer.drain(1);
 				if(Error==0) {
-					EndPoint->second->sid_ = *buffer.begin();
+					EndPoint->sid_ = *buffer.begin();
 					buffer.drain(1);
 				} else {
 					poco_error(Logger(),"Device login failed.");
@@ -1013,7 +1094,7 @@ namespace OpenWifi {
 				doc["type"] = "login";
 				doc["err"] = Error;
 				const auto login_msg = to_string(doc);
-				return SendToClient(*EndPoint->second->WSSocket_, login_msg);
+				return SendToClient(*EndPoint->WSSocket_, login_msg);
 			} catch (const Poco::Exception &E) {
 				Logger().log(E);
 			} catch (const std::exception &E) {
@@ -1030,14 +1111,18 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool RTTYS_server::do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos) {
-		auto EndPoint = Connected_.find(Socket.impl()->sockfd());
-		if (EndPoint!=end(Connected_) && EndPoint->second->WSSocket_!= nullptr && EndPoint->second->WSSocket_->impl() != nullptr) {
+	bool RTTYS_server::do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::vector<std::uint8_t> &buf) {
+		auto EndPoint = FindConnected(Socket.impl()->sockfd());
+		if (EndPoint == nullptr)
+			return false;
+		std::lock_guard	G(EndPoint->Mutex_);
+		if (EndPoint->WSSocket_!= nullptr && EndPoint->WSSocket_->impl() != nullptr) {
 			try {
 				buffer.drain(1);
 				msg_len--;
+				auto pos = buf.size();
+				buf.resize(pos + msg_len);
 				buffer.read((char*)&(buf[pos]),msg_len);
-				pos+=msg_len;
 				// auto good = SendToClient(*EndPoint->second->WSSocket_, (unsigned char*) buffer.begin(), (int) msg_len );
 				// buffer.drain(msg_len);
 				return true;
@@ -1068,9 +1153,9 @@ namespace OpenWifi {
 			MsgBuf[0] = RTTYS_EndPoint::msgTypeHeartbeat;
 			MsgBuf[1] = 0;
 			MsgBuf[2] = 0;
-			auto hint = Connected_.find(Socket.impl()->sockfd());
-			if(hint!=end(Connected_)) {
-				auto Sent = SendBytes(hint->second,Socket, MsgBuf, RTTY_HDR_SIZE);
+			auto EndPoint = FindConnected(Socket.impl()->sockfd());
+			if(EndPoint!=nullptr) {
+				auto Sent = SendBytes(EndPoint,Socket, MsgBuf, RTTY_HDR_SIZE);
 				return Sent == RTTY_HDR_SIZE;
 			}
 		} catch (const Poco::Exception &E) {
@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "Poco/Net/HTTPServer.h"
 #include "Poco/Net/SocketAcceptor.h"
@@ -27,11 +31,54 @@ namespace OpenWifi {
 	constexpr std::size_t RTTY_SESSION_ID_LENGTH = 32;
 	constexpr std::size_t RTTY_HDR_SIZE = 3;
 	constexpr std::size_t RTTY_RECEIVE_BUFFER = 1024 << 10;
+	constexpr std::size_t RTTY_INITIAL_BUFFER = 16 << 10;
+	constexpr std::size_t RTTY_MAX_IDLE_BUFFERS = 64;
 
 	class RTTYS_server;
 
 	class RTTYS_server *RTTYS_server();
 
+	/*
+	 * 	Receive buffers for device sockets. A buffer starts at RTTY_INITIAL_BUFFER and doubles when
+	 * a message does not fit, up to RTTY_RECEIVE_BUFFER. Released buffers are shrunk back and kept
+	 * for the next session, so idle sessions hold a few KB instead of a full megabyte.
+	 */
+	class RTTYS_BufferPool {
+	  public:
+		inline std::unique_ptr<Poco::FIFOBuffer> Acquire() {
+			{
+				std::lock_guard G(Mutex_);
+				if (!Free_.empty()) {
+					auto Buffer = std::move(Free_.back());
+					Free_.pop_back();
+					return Buffer;
+				}
+			}
+			return std::make_unique<Poco::FIFOBuffer>(RTTY_INITIAL_BUFFER);
+		}
+
+		inline void Release(std::unique_ptr<Poco::FIFOBuffer> Buffer) {
+			if (Buffer == nullptr)
+				return;
+			Buffer->drain();
+			if (Buffer->size() != RTTY_INITIAL_BUFFER)
+				Buffer->resize(RTTY_INITIAL_BUFFER, false);
+			std::lock_guard G(Mutex_);
+			if (Free_.size() < RTTY_MAX_IDLE_BUFFERS)
+				Free_.emplace_back(std::move(Buffer));
+		}
+
+		//	A full buffer holds the start of a message larger than the buffer: make it bigger.
+		static inline void MakeRoom(Poco::FIFOBuffer &Buffer) {
+			if (Buffer.available() == 0 && Buffer.size() < RTTY_RECEIVE_BUFFER)
+				Buffer.resize(std::min(Buffer.size() * 2, RTTY_RECEIVE_BUFFER), true);
+		}
+
+	  private:
+		std::mutex Mutex_;
+		std::vector<std::unique_ptr<Poco::FIFOBuffer>> Free_;
+	};
+
 	class RTTYS_EndPoint {
 	  public:
 		RTTYS_EndPoint(const std::string &Id, const std::string &Token,
@@ -109,13 +156,17 @@ namespace OpenWifi {
 		std::unique_ptr<Poco::Net::WebSocket>		WSSocket_;
 		unsigned char sid_=0;
 		unsigned char small_buf_[64 + RTTY_SESSION_ID_LENGTH]{0};
-		bool completed_ = false;
+		std::atomic_bool completed_ = false;
 		bool mTLS_=false;
 		Poco::Net::Socket							DeviceSocket_;
 		std::chrono::time_point<std::chrono::high_resolution_clock> Created_{0s},
 			DeviceDisconnected_{0s}, ClientDisconnected_{0s}, DeviceConnected_{0s},
 			ClientConnected_{0s};
 		std::uint64_t 	rx=0,tx=0;
+
+		//	Serializes everything sent or received for this session. Always taken after ServerMutex_.
+		std::recursive_mutex 						Mutex_;
+		Poco::Net::SocketReactor 					*ClientReactor_ = nullptr;
 	};
 
 	class RTTYS_server : public SubSystemServer {
@@ -132,19 +183,29 @@ namespace OpenWifi {
 			std::string 									cid;
 			std::string 									cn;
 			std::unique_ptr<Poco::FIFOBuffer>				buffer;
+			Poco::Net::SocketReactor 						&reactor;
+			RTTYS_BufferPool 								&pool;
 
 			SecureSocketPair(Poco::Net::StreamSocket &S,
 				 std::unique_ptr<Poco::Crypto::X509Certificate> Cert,
 				 bool Valid,
 				 const std::string & Cid,
-				 const std::string & CN) :
+				 const std::string & CN,
+				 Poco::Net::SocketReactor &R,
+				 RTTYS_BufferPool &P) :
 					  socket(S),
 					  cert(std::move(Cert)),
 					  valid(Valid),
 					  cid(Cid),
-					  cn(CN)
+					  cn(CN),
+					  reactor(R),
+					  pool(P)
 			{
-				buffer = std::make_unique<Poco::FIFOBuffer>(RTTY_RECEIVE_BUFFER);
+				buffer = pool.Acquire();
+			}
+
+			~SecureSocketPair() {
+				pool.Release(std::move(buffer));
 			}
 		};
 
@@ -181,7 +242,7 @@ namespace OpenWifi {
 		void onClientSocketShutdown(const Poco::AutoPtr<Poco::Net::ShutdownNotification> &pNf);
 		void onClientSocketError(const Poco::AutoPtr<Poco::Net::ErrorNotification> &pNf);
 
-		void RemoveClientEventHandlers(Poco::Net::WebSocket &Socket);
+		void RemoveClientEventHandlers(const std::shared_ptr<RTTYS_EndPoint> &EndPoint);
 		void RemoveConnectedDeviceEventHandlers(Poco::Net::StreamSocket &Socket);
 
 		void RemoveDeviceEventHandlers(const Poco::Net::Socket &Socket);
@@ -196,7 +257,8 @@ namespace OpenWifi {
 		std::map<std::string, std::shared_ptr<RTTYS_EndPoint>>::iterator EndConnection(std::shared_ptr<RTTYS_EndPoint> Connection, const char * func, std::uint64_t l);
 		void EndConnection(const Poco::Net::Socket &Socket, const char * func, std::uint32_t Line);
 
-		Poco::Net::SocketReactor &Reactor() { return Reactor_; }
+		Poco::Net::SocketReactor &NextSessionReactor();
+		std::shared_ptr<RTTYS_EndPoint> FindConnected(int fd);
 
 		void SendData(std::shared_ptr<RTTYS_EndPoint> &Connection, const u_char *Buf, size_t len);
 		void SendData(std::shared_ptr<RTTYS_EndPoint> &Connection, const std::string &s);
@@ -213,7 +275,7 @@ namespace OpenWifi {
 
 		bool do_msgTypeRegister(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeLogin(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
-		bool do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::uint8_t *buf, std::size_t &pos);
+		bool do_msgTypeTermData(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len, std::vector<std::uint8_t> &buf);
 		bool do_msgTypeLogout(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeWinsize(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
 		bool do_msgTypeCmd(const Poco::Net::Socket &Socket, Poco::FIFOBuffer &buffer, std::size_t msg_len);
@@ -235,9 +297,14 @@ namespace OpenWifi {
 		bool SendToClient(Poco::Net::WebSocket &WebSocket, const u_char *Buf, int len);
 		bool SendToClient(Poco::Net::WebSocket &WebSocket, const std::string &s);
 
-		std::mutex					ServerMutex_;
+		//	Guards the session maps only. Traffic for a session is serialized by its own mutex.
+		std::shared_mutex			ServerMutex_;
 		Poco::Net::SocketReactor 	Reactor_;
 		Poco::Thread 				ReactorThread_;
+		std::vector<std::unique_ptr<Poco::Net::SocketReactor>> 	SessionReactors_;
+		std::vector<std::unique_ptr<Poco::Thread>> 				SessionReactorThreads_;
+		std::atomic_uint64_t 		NextSessionReactor_ = 0;
+		RTTYS_BufferPool 			Buffers_;
 		std::string 				RTTY_UIAssets_;
 		bool 						Internal_ = false;
 		bool 						NoSecurity_ = false;
@@ -247,7 +314,7 @@ namespace OpenWifi {
 		std::map<std::string, std::shared_ptr<RTTYS_EndPoint>> 	EndPoints_; //	id, endpoint
 		std::map<int, std::shared_ptr<RTTYS_EndPoint>> 			Connected_; //	id, endpoint
 		std::map<int, std::shared_ptr<RTTYS_EndPoint>> 			Clients_;
-		std::map<int, std::unique_ptr<SecureSocketPair>>		Sockets_;
+		std::map<int, std::shared_ptr<SecureSocketPair>>		Sockets_;
 
 		Poco::Timer Timer_;
 		std::unique_ptr<Poco::TimerCallback<RTTYS_server>> GCCallBack_;
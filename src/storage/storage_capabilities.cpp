@@ -33,6 +33,8 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(Now), Poco::Data::Keywords::use(TCaps),
 				Poco::Data::Keywords::use(Now);
 			UpSert.execute();
+			if (CapabilitiesHashes_)
+				CapabilitiesHashes_->update(SerialNumber, std::hash<std::string>{}(TCaps));
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -44,14 +46,21 @@ namespace OpenWifi {
 	bool Storage::UpdateDeviceCapabilities(std::string &SerialNumber,
 										   const Config::Capabilities &Caps) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement UpSert(Sess);
-
-			uint64_t Now = Utils::Now();
 			if (!Caps.Compatible().empty() && !Caps.Platform().empty())
 				CapabilitiesCache()->Add(Caps);
 
+			//	Devices send the same capabilities on every connect: only write them when they change.
 			std::string TCaps{Caps.AsString()};
+			auto Hash = std::hash<std::string>{}(TCaps);
+			if (CapabilitiesHashes_) {
+				auto Known = CapabilitiesHashes_->get(SerialNumber);
+				if (!Known.isNull() && *Known == Hash)
+					return true;
+			}
+
+			Poco::Data::Session Sess = Pool_->get();
+			Poco::Data::Statement UpSert(Sess);
+			uint64_t Now = Utils::Now();
 
 			std::string St{"insert into Capabilities (SerialNumber, Capabilities, FirstUpdate, "
 						   "LastUpdate) values(?,?,?,?) on conflict (SerialNumber) do "
@@ -61,6 +70,8 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(Now), Poco::Data::Keywords::use(TCaps),
 				Poco::Data::Keywords::use(Now);
 			UpSert.execute();
+			if (CapabilitiesHashes_)
+				CapabilitiesHashes_->update(SerialNumber, Hash);
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -105,6 +116,8 @@ namespace OpenWifi {
 
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(SerialNumber);
 			Delete.execute();
+			if (CapabilitiesHashes_)
+				CapabilitiesHashes_->remove(SerialNumber);
 
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -15,6 +15,7 @@
 #include "AP_WS_Server.h"
 #include "CommandManager.h"
 #include "Daemon.h"
+#include "Dashboard.h"
 #include "FileUploader.h"
 #include "StorageService.h"
 #include "framework/utils.h"
@@ -111,8 +112,10 @@ namespace OpenWifi {
 				"delete from CommandList where SerialNumber=? and command=? and completed=0"};
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(SerialNumber),
 				Poco::Data::Keywords::use(Command);
-			Delete.execute();
+			auto Removed = Delete.execute();
 			Delete.reset(Sess);
+			if (Removed > 0)
+				DeviceDashboard()->CommandsRemoved(Command, Removed);
 
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -156,6 +159,9 @@ namespace OpenWifi {
 
 			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
 			Insert.execute();
+			DeviceDashboard()->CommandAdded(Command.Command);
+			if (Command.Executed == 0)
+				CommandManager()->CommandQueued(Command);
 
 			return true;
 
@@ -167,7 +173,8 @@ namespace OpenWifi {
 
 	bool Storage::GetCommands(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							  uint64_t Offset, uint64_t HowMany,
-							  std::vector<GWObjects::CommandDetails> &Commands) {
+							  std::vector<GWObjects::CommandDetails> &Commands,
+							  SeekCursor *Cursor) {
 		try {
 			CommandDetailsRecordList Records;
 			Poco::Data::Session Sess = Pool_->get();
@@ -193,10 +200,29 @@ namespace OpenWifi {
 
 			Poco::Data::Statement Select(Sess);
 
-			std::string FullQuery = IntroStatement + DateSelector + " ORDER BY Submitted ASC " +
-									ComputeRange(Offset, HowMany);
+			//	UUID is unique, so (Submitted, UUID) seeks without skipping any rows.
+			std::string SeekSelector;
+			std::string SeekKey;
+			if (Cursor != nullptr && Cursor->Valid) {
+				bool HasWhere = DatesIncluded || !SerialNumber.empty();
+				SeekSelector = std::string(HasWhere ? " AND " : " WHERE ") + "(Submitted>" +
+							   std::to_string(Cursor->Recorded) + " OR (Submitted=" +
+							   std::to_string(Cursor->Recorded) + " AND UUID>?))";
+				SeekKey = Cursor->Key;
+			}
+
+			std::string FullQuery = IntroStatement + DateSelector + SeekSelector +
+									(Cursor != nullptr ? " ORDER BY Submitted ASC, UUID ASC "
+													   : " ORDER BY Submitted ASC ") +
+									(Cursor != nullptr ? ComputeRange(0, HowMany)
+													   : ComputeRange(Offset, HowMany));
 
-			Select << FullQuery, Poco::Data::Keywords::into(Records);
+			if (SeekSelector.empty()) {
+				Select << FullQuery, Poco::Data::Keywords::into(Records);
+			} else {
+				Select << ConvertParams(FullQuery), Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::use(SeekKey);
+			}
 			Select.execute();
 			for (const auto &i : Records) {
 				GWObjects::CommandDetails R;
@@ -205,6 +231,13 @@ namespace OpenWifi {
 			}
 			Select.reset(Sess);
 
+			if (Cursor != nullptr) {
+				Cursor->Valid = !Commands.empty() && Commands.size() >= HowMany;
+				if (Cursor->Valid) {
+					Cursor->Recorded = Commands.back().Submitted;
+					Cursor->Key = Commands.back().UUID;
+				}
+			}
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -238,6 +271,7 @@ namespace OpenWifi {
 			Delete << IntroStatement + DateSelector;
 			Delete.execute();
 			Delete.reset(Sess);
+			DeviceDashboard()->CommandsChanged();
 
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -432,10 +466,20 @@ namespace OpenWifi {
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Delete.reset(Sess);
+			DeviceDashboard()->CommandsChanged();
+
+			std::vector<std::string> FileNames;
+			St = "SELECT FileName FROM FileUploads WHERE UUID=?";
+			Poco::Data::Statement Select(Sess);
+			Select << ConvertParams(St), Poco::Data::Keywords::into(FileNames),
+				Poco::Data::Keywords::use(UUID);
+			Select.execute();
+
 			St = "DELETE FROM FileUploads WHERE UUID=?";
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
 			Delete.reset(Sess);
+			ReleaseStoredFiles(Sess, FileNames);
 
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -472,31 +516,30 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::GetReadyToExecuteCommands(uint64_t Offset, uint64_t HowMany,
-											std::vector<GWObjects::CommandDetails> &Commands) {
-
+	//	Only the fields the scheduler needs: commands are re-read one at a time when they run.
+	bool Storage::GetPendingCommands(std::vector<GWObjects::CommandDetails> &Commands) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			auto Now = Utils::Now();
-			std::string St{"SELECT " + DB_Command_SelectFields +
-						   " FROM CommandList "
-						   " WHERE ((RunAt<=?) And (Executed=0) And (LastTry=0 or (" +
-						   std::to_string(Now) + "-LastTry)>" +
-						   std::to_string(CommandManager()->CommandRetry()) +
-						   ")) ORDER BY Submitted ASC "};
-			CommandDetailsRecordList Records;
-
-			std::string SS = ConvertParams(St) + ComputeRange(Offset, HowMany);
-			Select << SS, Poco::Data::Keywords::into(Records), Poco::Data::Keywords::use(Now);
+			typedef Poco::Tuple<std::string, std::string, uint64_t, uint64_t, uint64_t>
+				PendingCommandRecord;
+			std::vector<PendingCommandRecord> Records;
+			std::string St{"SELECT UUID, SerialNumber, Submitted, RunAt, LastTry FROM CommandList "
+						   "WHERE Executed=0 ORDER BY Submitted ASC"};
+			Select << ConvertParams(St), Poco::Data::Keywords::into(Records);
 			Select.execute();
 
+			Commands.reserve(Commands.size() + Records.size());
 			for (const auto &record : Records) {
 				GWObjects::CommandDetails R;
-				ConvertCommandRecord(record, R);
-				if (AP_WS_Server()->Connected(Utils::SerialNumberToInt(R.SerialNumber)))
-					Commands.push_back(R);
+				R.UUID = record.get<0>();
+				R.SerialNumber = record.get<1>();
+				R.Submitted = record.get<2>();
+				R.RunAt = record.get<3>();
+				R.lastTry = record.get<4>();
+				R.Executed = 0;
+				Commands.push_back(R);
 			}
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -623,12 +666,12 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::stringstream &FileContent,
-										  const std::string &Type) {
+	//	The content is already in the file store: only its name and size are recorded here.
+	bool Storage::AttachFileDataToCommand(std::string &UUID, const std::string &FileName,
+										  std::uint64_t Size, const std::string &Type) {
 		try {
 			auto Now = Utils::Now();
 			uint64_t WaitForFile = 0;
-			uint64_t Size = FileContent.str().size();
 
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Statement(Sess);
@@ -645,43 +688,29 @@ namespace OpenWifi {
 				Poco::Data::Keywords::use(UUID);
 			Statement.execute();
 
-			if (Size < FileUploader()->MaxSize()) {
-
-				Poco::Data::BLOB TheBlob;
-
-				TheBlob.appendRaw((const unsigned char *)FileContent.str().c_str(),
-								  FileContent.str().size());
-
-				Poco::Data::Statement Insert(Sess);
-				std::string FileType{Type};
+			Poco::Data::Statement Insert(Sess);
+			std::string FileType{Type};
+			std::string Name{FileName};
 
-				std::string St2{
-					"INSERT INTO FileUploads (UUID,Type,Created,FileContent) VALUES(?,?,?,?)"};
+			std::string St2{
+				"INSERT INTO FileUploads (UUID,Type,Created,FileName,FileSize) VALUES(?,?,?,?,?)"};
 
-				Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
-					Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
-					Poco::Data::Keywords::use(TheBlob);
-				Insert.execute();
-				return true;
-			} else {
-				poco_warning(Logger(), fmt::format("File {} is too large.", UUID));
-			}
+			Insert << ConvertParams(St2), Poco::Data::Keywords::use(UUID),
+				Poco::Data::Keywords::use(FileType), Poco::Data::Keywords::use(Now),
+				Poco::Data::Keywords::use(Name), Poco::Data::Keywords::use(Size);
+			Insert.execute();
+			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
 		return false;
 	}
 
-	bool Storage::GetAttachedFileContent(std::string &UUID, const std::string &SerialNumber,
-										 std::string &FileContent, std::string &Type) {
+	//	Files uploaded before the file store have no name: their content is still in the row.
+	bool Storage::GetAttachedFile(std::string &UUID, const std::string &SerialNumber,
+								  std::string &FileName, std::string &FileContent,
+								  std::string &Type) {
 		try {
-			Poco::Data::BLOB L;
-			/*
-						"UUID			VARCHAR(64) PRIMARY KEY, "
-						"Type			VARCHAR(32), "
-						"Created 		BIGINT, "
-						"FileContent	BYTEA"
-			*/
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select1(Sess);
 
@@ -696,11 +725,22 @@ namespace OpenWifi {
 				return false;
 			}
 
-			std::string St2{"SELECT FileContent, Type FROM FileUploads WHERE UUID=?"};
+			std::string St2{"SELECT FileName, Type FROM FileUploads WHERE UUID=?"};
 			Poco::Data::Statement Select2(Sess);
-			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(L),
+			Select2 << ConvertParams(St2), Poco::Data::Keywords::into(FileName),
 				Poco::Data::Keywords::into(Type), Poco::Data::Keywords::use(UUID);
-			Select2.execute();
+			if (Select2.execute() == 0)
+				return false;
+
+			if (!FileName.empty())
+				return true;
+
+			Poco::Data::BLOB L;
+			std::string St3{"SELECT FileContent FROM FileUploads WHERE UUID=?"};
+			Poco::Data::Statement Select3(Sess);
+			Select3 << ConvertParams(St3), Poco::Data::Keywords::into(L),
+				Poco::Data::Keywords::use(UUID);
+			Select3.execute();
 			FileContent.assign(L.content().begin(), L.content().end());
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -733,12 +773,20 @@ namespace OpenWifi {
 	bool Storage::RemoveAttachedFile(std::string &UUID) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Delete(Sess);
 
+			std::vector<std::string> FileNames;
+			std::string St0{"SELECT FileName FROM FileUploads WHERE UUID=?"};
+			Poco::Data::Statement Select(Sess);
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(FileNames),
+				Poco::Data::Keywords::use(UUID);
+			Select.execute();
+
+			Poco::Data::Statement Delete(Sess);
 			std::string St{"DELETE FROM FileUploads WHERE UUID=?"};
 
 			Delete << ConvertParams(St), Poco::Data::Keywords::use(UUID);
 			Delete.execute();
+			ReleaseStoredFiles(Sess, FileNames);
 
 			return true;
 
@@ -753,9 +801,17 @@ namespace OpenWifi {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Delete(Sess);
 
+			std::vector<std::string> FileNames;
+			std::string St0{"select distinct FileName from FileUploads where Created<?"};
+			Poco::Data::Statement Select(Sess);
+			Select << ConvertParams(St0), Poco::Data::Keywords::into(FileNames),
+				Poco::Data::Keywords::use(Date);
+			Select.execute();
+
 			std::string St1{"delete from FileUploads where Created<?"};
 			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
 			Delete.execute();
+			ReleaseStoredFiles(Sess, FileNames);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -763,19 +819,39 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::RemoveCommandListRecordsOlderThan(uint64_t Date) {
+	void Storage::ReleaseStoredFile(const std::string &FileName) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Delete(Sess);
-
-			std::string St1{"delete from CommandList where Submitted<?"};
-			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
-			Delete.execute();
-			return true;
+			ReleaseStoredFiles(Sess, {FileName});
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
-		return false;
+	}
+
+	//	Identical uploads share one stored file: it goes away with the last row that names it. The
+	//	file's lock keeps an upload of the same content from being recorded between the count and
+	//	the removal.
+	void Storage::ReleaseStoredFiles(Poco::Data::Session &Sess,
+									 const std::vector<std::string> &FileNames) {
+		for (auto FileName : FileNames) {
+			if (FileName.empty())
+				continue;
+			std::lock_guard G(FileUploader()->FileMutex(FileName));
+			std::uint64_t Count = 0;
+			std::string St{"SELECT COUNT(*) FROM FileUploads WHERE FileName=?"};
+			Poco::Data::Statement Select(Sess);
+			Select << ConvertParams(St), Poco::Data::Keywords::into(Count),
+				Poco::Data::Keywords::use(FileName);
+			Select.execute();
+			if (Count == 0)
+				FileUploader()->RemoveFile(FileName);
+		}
+	}
+
+	bool Storage::RemoveCommandListRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget) {
+		auto Result = RemoveRecordsOlderThan("CommandList", "Submitted", Date, Budget);
+		DeviceDashboard()->CommandsChanged();
+		return Result;
 	}
 
 	bool Storage::AnalyzeCommands(Types::CountedMap &R) {
@@ -783,7 +859,7 @@ namespace OpenWifi {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			Select << "SELECT Command from CommandList";
+			Select << "SELECT Command, COUNT(*) FROM CommandList GROUP BY Command";
 			Select.execute();
 
 			Poco::Data::RecordSet RSet(Select);
@@ -792,7 +868,7 @@ namespace OpenWifi {
 			while (More) {
 				auto Command = RSet[0].convert<std::string>();
 				if (!Command.empty())
-					UpdateCountedMap(R, Command);
+					UpdateCountedMap(R, Command, RSet[1].convert<uint64_t>());
 				More = RSet.moveNext();
 			}
 			return true;
@@ -11,13 +11,12 @@
 #include "CentralConfig.h"
 #include "ConfigurationCache.h"
 #include "Daemon.h"
+#include "Dashboard.h"
 #include "FindCountry.h"
-#include "OUIServer.h"
 #include "Poco/Data/RecordSet.h"
 #include "Poco/Net/IPAddress.h"
 #include "SDKcalls.h"
 #include "SerialNumberCache.h"
-#include "StateUtils.h"
 #include "StorageService.h"
 
 #include "framework/KafkaManager.h"
@@ -190,11 +189,26 @@ namespace OpenWifi {
 
 	bool Storage::GetDeviceSerialNumbers(uint64_t From, uint64_t HowMany,
 										 std::vector<std::string> &SerialNumbers,
-										 const std::string &orderBy) {
+										 const std::string &orderBy, SeekCursor *Cursor) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
+			//	Seeking only follows the primary key: a custom order falls back to offsets.
+			if (Cursor != nullptr && orderBy.empty()) {
+				std::string Last{Cursor->Valid ? Cursor->Key : ""};
+				std::string st{"SELECT SerialNumber From Devices WHERE SerialNumber>? ORDER BY "
+							   "SerialNumber ASC " +
+							   ComputeRange(0, HowMany)};
+				Select << ConvertParams(st), Poco::Data::Keywords::into(SerialNumbers),
+					Poco::Data::Keywords::use(Last);
+				Select.execute();
+				Cursor->Valid = !SerialNumbers.empty() && SerialNumbers.size() >= HowMany;
+				if (Cursor->Valid)
+					Cursor->Key = SerialNumbers.back();
+				return true;
+			}
+
 			std::string st;
 			if (orderBy.empty())
 				st = "SELECT SerialNumber From Devices ORDER BY SerialNumber ASC ";
@@ -225,7 +239,7 @@ namespace OpenWifi {
 			Poco::Data::Statement Select(Sess);
 
 			GWObjects::Device D;
-			if (!GetDevice(SerialNumber, D))
+			if (!LoadDevice(SerialNumber, D))
 				return false;
 
 			uint64_t Now = time(nullptr);
@@ -243,6 +257,7 @@ namespace OpenWifi {
 				Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
 					Poco::Data::Keywords::use(SerialNumber);
 				Update.execute();
+				ForgetDevice(SerialNumber);
 				poco_information(Logger(),
 								 fmt::format("DEVICE-CONFIGURATION-UPDATED({}): New UUID is {}",
 											 SerialNumber, NewUUID));
@@ -259,7 +274,7 @@ namespace OpenWifi {
 	bool Storage::RollbackDeviceConfigurationChange(std::string & SerialNumber) {
 		try {
 			GWObjects::Device D;
-			if (!GetDevice(SerialNumber, D))
+			if (!LoadDevice(SerialNumber, D))
 				return false;
 			D.pendingConfiguration.clear();
 			D.pendingUUID = 0;
@@ -277,6 +292,7 @@ namespace OpenWifi {
 			Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
+			ForgetDevice(SerialNumber);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -287,7 +303,7 @@ namespace OpenWifi {
 	bool Storage::CompleteDeviceConfigurationChange(std::string & SerialNumber) {
 		try {
 			GWObjects::Device D;
-			if (!GetDevice(SerialNumber, D))
+			if (!LoadDevice(SerialNumber, D))
 				return false;
 
 			if(D.pendingConfiguration.empty())
@@ -310,6 +326,7 @@ namespace OpenWifi {
 			Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
+			ForgetDevice(SerialNumber);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -332,7 +349,7 @@ namespace OpenWifi {
 			Poco::Data::Statement Select(Sess);
 
 			GWObjects::Device D;
-			if (!GetDevice(SerialNumber, D))
+			if (!LoadDevice(SerialNumber, D))
 				return false;
 
 			uint64_t Now = time(nullptr);
@@ -353,6 +370,7 @@ namespace OpenWifi {
 				Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
 					Poco::Data::Keywords::use(SerialNumber);
 				Update.execute();
+				ForgetDevice(SerialNumber);
 				poco_information(Logger(),
 								 fmt::format("DEVICE-PENDING-CONFIGURATION-UPDATED({}): New UUID is {}",
 											 SerialNumber, NewUUID));
@@ -368,13 +386,22 @@ namespace OpenWifi {
 
 	bool Storage::SetDeviceLastRecordedContact(std::string &SerialNumber, std::uint64_t lastRecordedContact) {
 		try {
-			Poco::Data::Session 	Sess = Pool_->get();
-			Poco::Data::Statement 	Update(Sess);
-			std::string St{"UPDATE Devices SET lastRecordedContact=?  WHERE SerialNumber=?"};
-
-			Update << ConvertParams(St), Poco::Data::Keywords::use(lastRecordedContact),
-				Poco::Data::Keywords::use(SerialNumber);
-			Update.execute();
+			struct Contact {
+				std::uint64_t LastRecordedContact = 0;
+				std::string SerialNumber;
+			};
+			static const std::string St{
+				"UPDATE Devices SET lastRecordedContact=?  WHERE SerialNumber=?"};
+
+			auto Update = Statements().Prepare<Contact>(
+				St, [](Poco::Data::Statement &S, Contact &C) {
+					S, Poco::Data::Keywords::use(C.LastRecordedContact),
+						Poco::Data::Keywords::use(C.SerialNumber);
+				});
+			Update->LastRecordedContact = lastRecordedContact;
+			Update->SerialNumber = SerialNumber;
+			Update.Execute();
+			ForgetDevice(SerialNumber);
 			return true;
 
 		} catch (const Poco::Exception &E) {
@@ -417,8 +444,10 @@ namespace OpenWifi {
 					ConvertDeviceRecord(DeviceDetails, R);
 					Insert << ConvertParams(St2), Poco::Data::Keywords::use(R);
 					Insert.execute();
+					ForgetDevice(DeviceDetails.SerialNumber);
 					SetCurrentConfigurationID(DeviceDetails.SerialNumber, DeviceDetails.UUID);
 					SerialNumberCache()->AddSerialNumber(DeviceDetails.SerialNumber);
+					DeviceDashboard()->DeviceAdded(DeviceDetails.SerialNumber, DeviceDetails.Compatible);
 					return true;
 				} else {
 					poco_warning(Logger(), "Cannot create device: invalid configuration.");
@@ -480,6 +509,7 @@ namespace OpenWifi {
 				}
 				Command.reset(Sess);
 			}
+			ForgetAllDevices();
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -569,6 +599,7 @@ namespace OpenWifi {
 			Update << ConvertParams(St), Poco::Data::Keywords::use(Password),
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
+			ForgetDevice(SerialNumber);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -578,25 +609,44 @@ namespace OpenWifi {
 
 	bool Storage::SetConnectInfo(std::string &SerialNumber, std::string &Firmware) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+			struct FirmwareLookup {
+				std::string SerialNumber;
+				std::string Firmware;
+			};
+			struct FirmwareUpdate {
+				std::string Firmware;
+				std::uint64_t Now = 0;
+				std::string SerialNumber;
+			};
 
 			//	Get the old version and if they do not match, set the last date
-			std::string St{"SELECT Firmware FROM Devices  WHERE SerialNumber=?"};
+			static const std::string St{"SELECT Firmware FROM Devices  WHERE SerialNumber=?"};
 			std::string TmpFirmware;
-			Select << ConvertParams(St), Poco::Data::Keywords::into(TmpFirmware),
-				Poco::Data::Keywords::use(SerialNumber);
-			Select.execute();
+			{
+				auto Select = Statements().Prepare<FirmwareLookup>(
+					St, [](Poco::Data::Statement &S, FirmwareLookup &L) {
+						S, Poco::Data::Keywords::into(L.Firmware),
+							Poco::Data::Keywords::use(L.SerialNumber);
+					});
+				Select->SerialNumber = SerialNumber;
+				Select->Firmware.clear();
+				Select.Execute();
+				TmpFirmware = Select->Firmware;
+			}
 
 			if (TmpFirmware != Firmware) {
-				Poco::Data::Statement Update(Sess);
-				std::string St2{
+				static const std::string St2{
 					"UPDATE Devices SET Firmware=?, LastFWUpdate=? WHERE SerialNumber=?"};
-				uint64_t Now = Utils::Now();
-
-				Update << ConvertParams(St2), Poco::Data::Keywords::use(Firmware),
-					Poco::Data::Keywords::use(Now), Poco::Data::Keywords::use(SerialNumber);
-				Update.execute();
+				auto Update = Statements().Prepare<FirmwareUpdate>(
+					St2, [](Poco::Data::Statement &S, FirmwareUpdate &U) {
+						S, Poco::Data::Keywords::use(U.Firmware), Poco::Data::Keywords::use(U.Now),
+							Poco::Data::Keywords::use(U.SerialNumber);
+					});
+				Update->Firmware = Firmware;
+				Update->Now = Utils::Now();
+				Update->SerialNumber = SerialNumber;
+				Update.Execute();
+				ForgetDevice(SerialNumber);
 				return true;
 			}
 			return true;
@@ -625,6 +675,11 @@ namespace OpenWifi {
 			}
 
 			SerialNumberCache()->DeleteSerialNumber(SerialNumber);
+			ForgetDevice(SerialNumber);
+			if (CapabilitiesHashes_)
+				CapabilitiesHashes_->remove(SerialNumber);
+			DeviceDashboard()->DeviceDeleted(SerialNumber);
+			DeviceDashboard()->CommandsChanged();
 
 			if (KafkaManager()->Enabled()) {
 				Poco::JSON::Object Message;
@@ -692,22 +747,69 @@ namespace OpenWifi {
 		return false;
 	}
 
+	void Storage::ForgetDevice(const std::string &SerialNumber) {
+		if (!DeviceCache_)
+			return;
+		auto Shard = Utils::CalculateMacAddressHash(SerialNumber);
+		std::lock_guard G(DeviceCacheMutex_[Shard]);
+		DeviceCacheGeneration_[Shard]++;
+		DeviceCache_->remove(SerialNumber);
+	}
+
+	void Storage::ForgetAllDevices() {
+		if (CapabilitiesHashes_)
+			CapabilitiesHashes_->clear();
+		if (!DeviceCache_)
+			return;
+		for (std::size_t Shard = 0; Shard < DeviceCacheMutex_.size(); Shard++) {
+			std::lock_guard G(DeviceCacheMutex_[Shard]);
+			DeviceCacheGeneration_[Shard]++;
+		}
+		DeviceCache_->clear();
+	}
+
 	bool Storage::GetDevice(std::string &SerialNumber, GWObjects::Device &DeviceDetails) {
-		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
+		if (!DeviceCache_)
+			return LoadDevice(SerialNumber, DeviceDetails);
 
-			std::string St{"SELECT " + DB_DeviceSelectFields +
-						   " FROM Devices WHERE SerialNumber=?"};
+		auto Cached = DeviceCache_->get(SerialNumber);
+		if (!Cached.isNull()) {
+			DeviceDetails = *Cached;
+			return true;
+		}
 
-			DeviceRecordTuple R;
-			Select << ConvertParams(St), Poco::Data::Keywords::into(R),
-				Poco::Data::Keywords::use(SerialNumber);
-			Select.execute();
+		auto Shard = Utils::CalculateMacAddressHash(SerialNumber);
+		std::uint64_t Generation;
+		{
+			std::lock_guard G(DeviceCacheMutex_[Shard]);
+			Generation = DeviceCacheGeneration_[Shard];
+		}
+		if (!LoadDevice(SerialNumber, DeviceDetails))
+			return false;
+		std::lock_guard G(DeviceCacheMutex_[Shard]);
+		if (Generation == DeviceCacheGeneration_[Shard])
+			DeviceCache_->update(SerialNumber, DeviceDetails);
+		return true;
+	}
 
-			if (Select.rowsExtracted() == 0)
+	bool Storage::LoadDevice(std::string &SerialNumber, GWObjects::Device &DeviceDetails) {
+		try {
+			struct DeviceLookup {
+				std::string SerialNumber;
+				DeviceRecordTuple Record;
+			};
+			static const std::string St{"SELECT " + DB_DeviceSelectFields +
+										" FROM Devices WHERE SerialNumber=?"};
+
+			auto Select = Statements().Prepare<DeviceLookup>(
+				St, [](Poco::Data::Statement &S, DeviceLookup &L) {
+					S, Poco::Data::Keywords::into(L.Record),
+						Poco::Data::Keywords::use(L.SerialNumber);
+				});
+			Select->SerialNumber = SerialNumber;
+			if (Select.Execute() == 0)
 				return false;
-			ConvertDeviceRecord(R, DeviceDetails);
+			ConvertDeviceRecord(Select->Record, DeviceDetails);
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -717,21 +819,19 @@ namespace OpenWifi {
 
 	bool Storage::DeviceExists(std::string &SerialNumber) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Select(Sess);
-
-			std::string Serial;
-
-			std::string St{"SELECT SerialNumber FROM Devices WHERE SerialNumber=?"};
-
-			Select << ConvertParams(St), Poco::Data::Keywords::into(Serial),
-				Poco::Data::Keywords::use(SerialNumber);
-			Select.execute();
-
-			if (Select.rowsExtracted() == 0)
-				return false;
-
-			return true;
+			struct SerialLookup {
+				std::string SerialNumber;
+				std::string Found;
+			};
+			static const std::string St{"SELECT SerialNumber FROM Devices WHERE SerialNumber=?"};
+
+			auto Select = Statements().Prepare<SerialLookup>(
+				St, [](Poco::Data::Statement &S, SerialLookup &L) {
+					S, Poco::Data::Keywords::into(L.Found),
+						Poco::Data::Keywords::use(L.SerialNumber);
+				});
+			Select->SerialNumber = SerialNumber;
+			return Select.Execute() > 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
 		}
@@ -753,6 +853,8 @@ namespace OpenWifi {
 			Update << ConvertParams(St2), Poco::Data::Keywords::use(R),
 				Poco::Data::Keywords::use(NewDeviceDetails.SerialNumber);
 			Update.execute();
+			ForgetDevice(NewDeviceDetails.SerialNumber);
+			DeviceDashboard()->DeviceAdded(NewDeviceDetails.SerialNumber, NewDeviceDetails.Compatible);
 			// GetDevice(NewDeviceDetails.SerialNumber,NewDeviceDetails);
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -762,19 +864,29 @@ namespace OpenWifi {
 	}
 
 	bool Storage::GetDevices(uint64_t From, uint64_t HowMany,
-							 std::vector<GWObjects::Device> &Devices, const std::string &orderBy) {
+							 std::vector<GWObjects::Device> &Devices, const std::string &orderBy,
+							 SeekCursor *Cursor) {
 		DeviceRecordList Records;
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
+			bool Seek = Cursor != nullptr && orderBy.empty();
+			std::string Last{Seek && Cursor->Valid ? Cursor->Key : ""};
+
 			// std::string st{"SELECT " + DB_DeviceSelectFields + " FROM Devices " + orderBy.empty()
 			// ? " ORDER BY SerialNumber ASC " + ComputeRange(From, HowMany)};
-			std::string st = fmt::format("SELECT {} FROM Devices {} {}", DB_DeviceSelectFields,
+			std::string st = fmt::format("SELECT {} FROM Devices {} {} {}", DB_DeviceSelectFields,
+										 Seek ? " WHERE SerialNumber>? " : "",
 										 orderBy.empty() ? " ORDER BY SerialNumber ASC " : orderBy,
-										 ComputeRange(From, HowMany));
+										 ComputeRange(Seek ? 0 : From, HowMany));
 
-			Select << ConvertParams(st), Poco::Data::Keywords::into(Records);
+			if (Seek) {
+				Select << ConvertParams(st), Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::use(Last);
+			} else {
+				Select << ConvertParams(st), Poco::Data::Keywords::into(Records);
+			}
 			Select.execute();
 
 			for (auto &i : Records) {
@@ -782,6 +894,11 @@ namespace OpenWifi {
 				ConvertDeviceRecord(i, D);
 				Devices.push_back(D);
 			}
+			if (Seek) {
+				Cursor->Valid = !Records.empty() && Records.size() >= HowMany;
+				if (Cursor->Valid)
+					Cursor->Key = Devices.back().SerialNumber;
+			}
 			return true;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -818,6 +935,7 @@ namespace OpenWifi {
 			Update << ConvertParams(St2), Poco::Data::Keywords::use(Now),
 				Poco::Data::Keywords::use(SerialNumber);
 			Update.execute();
+			ForgetDevice(SerialNumber);
 
 			return true;
 		} catch (const Poco::Exception &E) {
@@ -836,16 +954,17 @@ namespace OpenWifi {
 
 			Poco::Data::RecordSet RSet(Select);
 
-			uint64_t NumberOfDevices = 0;
+			std::vector<std::string> SerialNumbers;
+			SerialNumbers.reserve(RSet.rowCount());
 
 			bool More = RSet.moveFirst();
 			while (More) {
-				auto SerialNumber = RSet[0].convert<std::string>();
-				SerialNumberCache()->AddSerialNumber(SerialNumber);
-				NumberOfDevices++;
+				SerialNumbers.emplace_back(RSet[0].convert<std::string>());
 				More = RSet.moveNext();
 			}
-			Logger().information(fmt::format("Added {} serial numbers to cache.", NumberOfDevices));
+			SerialNumberCache()->LoadSerialNumbers(SerialNumbers);
+			Logger().information(
+				fmt::format("Loaded {} serial numbers into cache.", SerialNumbers.size()));
 			return true;
 
 		} catch (const Poco::Exception &E) {
@@ -854,163 +973,20 @@ namespace OpenWifi {
 		return false;
 	}
 
-	static std::string ComputeCertificateTag(GWObjects::CertificateValidation V) {
-		switch (V) {
-		case GWObjects::NO_CERTIFICATE:
-			return "no certificate";
-		case GWObjects::VALID_CERTIFICATE:
-			return "non TIP certificate";
-		case GWObjects::MISMATCH_SERIAL:
-			return "serial mismatch";
-		case GWObjects::VERIFIED:
-			return "verified";
-		case GWObjects::SIMULATED:
-			return "simulated";
-		}
-		return "unknown";
-	}
-
-	static const uint64_t SECONDS_MONTH = 30 * 24 * 60 * 60;
-	static const uint64_t SECONDS_WEEK = 7 * 24 * 60 * 60;
-	static const uint64_t SECONDS_DAY = 1 * 24 * 60 * 60;
-	static const uint64_t SECONDS_HOUR = 60 * 60;
-
-	static std::string ComputeUpLastContactTag(uint64_t T1) {
-		uint64_t T = T1 - Utils::Now();
-		if (T > SECONDS_MONTH)
-			return ">month";
-		if (T > SECONDS_WEEK)
-			return ">week";
-		if (T > SECONDS_DAY)
-			return ">day";
-		if (T > SECONDS_HOUR)
-			return ">hour";
-		return "now";
-	}
-
-	static std::string ComputeSanityTag(uint64_t T) {
-		if (T == 100)
-			return "100%";
-		if (T > 90)
-			return ">90%";
-		if (T > 60)
-			return ">60%";
-		return "<60%";
-	}
-
-	static std::string ComputeUpTimeTag(uint64_t T) {
-		if (T > SECONDS_MONTH)
-			return ">month";
-		if (T > SECONDS_WEEK)
-			return ">week";
-		if (T > SECONDS_DAY)
-			return ">day";
-		if (T > SECONDS_HOUR)
-			return ">hour";
-		return "now";
-	}
-
-	static std::string ComputeLoadTag(uint64_t T) {
-		auto V = 100.0 * ((float)T / 65536.0);
-		if (V < 5.0)
-			return "< 5%";
-		if (V < 25.0)
-			return "< 25%";
-		if (V < 50.0)
-			return "< 50%";
-		if (V < 75.0)
-			return "< 75%";
-		return ">75%";
-	}
-
-	static std::string ComputeUsedMemoryTag(uint64_t Free, uint64_t Total) {
-		if (Total == 0)
-			return "< 5%";
-		auto V = 100.0 * ((float)(Total - Free) / (float(Total)));
-		if (V < 5.0)
-			return "< 5%";
-		if (V < 25.0)
-			return "< 25%";
-		if (V < 50.0)
-			return "< 50%";
-		if (V < 75.0)
-			return "< 75%";
-		return ">75%";
-	}
-
-	bool Storage::AnalyzeDevices(GWObjects::Dashboard &Dashboard) {
+	bool Storage::GetDeviceInventory(std::vector<std::pair<std::string, std::string>> &Devices) {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 			Poco::Data::Statement Select(Sess);
 
-			Select << "SELECT SerialNumber, Compatible, Firmware FROM Devices";
+			Select << "SELECT SerialNumber, Compatible FROM Devices";
 			Select.execute();
 
 			Poco::Data::RecordSet RSet(Select);
+			Devices.reserve(RSet.rowCount());
 
 			bool More = RSet.moveFirst();
 			while (More) {
-				Dashboard.numberOfDevices++;
-				auto SerialNumber = RSet[0].convert<std::string>();
-				auto DeviceType = RSet[1].convert<std::string>();
-				auto Revision = RSet[2].convert<std::string>();
-				UpdateCountedMap(Dashboard.vendors, OUIServer()->GetManufacturer(SerialNumber));
-				UpdateCountedMap(Dashboard.deviceType, DeviceType);
-
-				GWObjects::ConnectionState ConnState;
-				if (AP_WS_Server()->GetState(SerialNumber, ConnState)) {
-					UpdateCountedMap(Dashboard.status,
-									 ConnState.Connected ? "connected" : "not connected");
-					UpdateCountedMap(Dashboard.certificates,
-									 ComputeCertificateTag(ConnState.VerifiedCertificate));
-					UpdateCountedMap(Dashboard.lastContact,
-									 ComputeUpLastContactTag(ConnState.LastContact));
-					GWObjects::HealthCheck HC;
-					if (AP_WS_Server()->GetHealthcheck(SerialNumber, HC))
-						UpdateCountedMap(Dashboard.healths, ComputeSanityTag(HC.Sanity));
-					else
-						UpdateCountedMap(Dashboard.healths, ComputeSanityTag(100));
-					std::string LastStats;
-					if (AP_WS_Server()->GetStatistics(SerialNumber, LastStats) &&
-						!LastStats.empty()) {
-						Poco::JSON::Parser P;
-
-						auto RawObject = P.parse(LastStats).extract<Poco::JSON::Object::Ptr>();
-
-						if (RawObject->has("unit")) {
-							auto Unit = RawObject->getObject("unit");
-							if (Unit->has("uptime")) {
-								UpdateCountedMap(Dashboard.upTimes,
-												 ComputeUpTimeTag(Unit->get("uptime")));
-							}
-							if (Unit->has("memory")) {
-								auto Memory = Unit->getObject("memory");
-								uint64_t Free = Memory->get("free");
-								uint64_t Total = Memory->get("total");
-								UpdateCountedMap(Dashboard.memoryUsed,
-												 ComputeUsedMemoryTag(Free, Total));
-							}
-							if (Unit->has("load")) {
-								auto Load = Unit->getArray("load");
-								UpdateCountedMap(Dashboard.load1,
-												 ComputeLoadTag(Load->getElement<uint64_t>(0)));
-								UpdateCountedMap(Dashboard.load5,
-												 ComputeLoadTag(Load->getElement<uint64_t>(1)));
-								UpdateCountedMap(Dashboard.load15,
-												 ComputeLoadTag(Load->getElement<uint64_t>(2)));
-							}
-						}
-
-						uint64_t Associations_2G, Associations_5G, Associations_6G;
-						StateUtils::ComputeAssociations(RawObject, Associations_2G, Associations_5G,
-														Associations_6G);
-						UpdateCountedMap(Dashboard.associations, "2G", Associations_2G);
-						UpdateCountedMap(Dashboard.associations, "5G", Associations_5G);
-						UpdateCountedMap(Dashboard.associations, "6G", Associations_6G);
-					}
-				} else {
-					UpdateCountedMap(Dashboard.status, "not connected");
-				}
+				Devices.emplace_back(RSet[0].convert<std::string>(), RSet[1].convert<std::string>());
 				More = RSet.moveNext();
 			}
 			return true;
@@ -37,16 +37,15 @@ namespace OpenWifi {
 
 	bool Storage::AddHealthCheckData(const GWObjects::HealthCheck &Check) {
 		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Insert(Sess);
-
-			std::string St{"INSERT INTO HealthChecks ( " + DB_HealthCheckSelectFields +
-						   " ) VALUES( " + DB_HealthCheckInsertValues + " )"};
-
-			HealthCheckRecordTuple R;
-			ConvertHealthCheckRecord(Check, R);
-			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
-			Insert.execute();
+			static const std::string St{"INSERT INTO HealthChecks ( " + DB_HealthCheckSelectFields +
+										" ) VALUES( " + DB_HealthCheckInsertValues + " )"};
+
+			auto Insert = Statements().Prepare<HealthCheckRecordTuple>(
+				St, [](Poco::Data::Statement &S, HealthCheckRecordTuple &R) {
+					S, Poco::Data::Keywords::use(R);
+				});
+			ConvertHealthCheckRecord(Check, *Insert);
+			Insert.Execute();
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -55,16 +54,52 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::AddHealthCheckData(const std::vector<GWObjects::HealthCheck> &Checks,
+									std::uint64_t &Written) {
+		static const std::string Prefix{"INSERT INTO HealthChecks ( " +
+										DB_HealthCheckSelectFields + " ) VALUES "};
+		static const std::string FullBatch{
+			Prefix + MultiRowValues(DB_HealthCheckInsertValues, MultiRowInsertSize)};
+		Written = 0;
+		for (std::size_t Start = 0; Start < Checks.size(); Start += MultiRowInsertSize) {
+			auto Rows = std::min(MultiRowInsertSize, Checks.size() - Start);
+			try {
+				std::string Partial;
+				if (Rows != MultiRowInsertSize)
+					Partial = Prefix + MultiRowValues(DB_HealthCheckInsertValues, Rows);
+				auto Insert = Statements().Prepare<HealthCheckRecordList>(
+					Partial.empty() ? FullBatch : Partial,
+					[Rows](Poco::Data::Statement &S, HealthCheckRecordList &Records) {
+						Records.resize(Rows);
+						for (auto &R : Records)
+							S, Poco::Data::Keywords::use(R);
+					},
+					Rows == MultiRowInsertSize);
+				for (std::size_t i = 0; i < Rows; ++i)
+					ConvertHealthCheckRecord(Checks[Start + i], (*Insert)[i]);
+				Insert.Execute();
+				Written += Rows;
+			} catch (const Poco::Exception &E) {
+				poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+												   E.displayText()));
+			}
+		}
+		return Written == Checks.size();
+	}
+
 	bool Storage::GetHealthCheckData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 									 uint64_t Offset, uint64_t HowMany,
-									 std::vector<GWObjects::HealthCheck> &Checks) {
+									 std::vector<GWObjects::HealthCheck> &Checks,
+									 SeekCursor *Cursor) {
 		try {
 			HealthCheckRecordList Records;
 			Poco::Data::Session Sess = Pool_->get();
 
 			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
 
-			std::string Prefix{"SELECT " + DB_HealthCheckSelectFields + " FROM HealthChecks "};
+			std::string Prefix{"SELECT " + DB_HealthCheckSelectFields +
+							   (Cursor != nullptr ? ", " + RowIdColumn() : "") +
+							   " FROM HealthChecks "};
 			std::string Statement = SerialNumber.empty()
 										? Prefix + std::string(DatesIncluded ? "WHERE " : "")
 										: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
@@ -80,11 +115,20 @@ namespace OpenWifi {
 				DateSelector = " Recorded<=" + std::to_string(ToDate);
 			}
 
+			std::string FullQuery =
+				Statement + DateSelector +
+				SeekAfter(Cursor, DatesIncluded || !SerialNumber.empty(), false) +
+				SeekOrder(false) + ComputeRange(Cursor != nullptr ? 0 : Offset, HowMany);
+
 			Poco::Data::Statement Select(Sess);
 
-			Select << Statement + DateSelector + " ORDER BY Recorded ASC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
+			std::vector<std::uint64_t> Ids;
+			if (Cursor == nullptr) {
+				Select << FullQuery, Poco::Data::Keywords::into(Records);
+			} else {
+				Select << FullQuery, Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::into(Ids);
+			}
 			Select.execute();
 
 			for (const auto &i : Records) {
@@ -93,6 +137,8 @@ namespace OpenWifi {
 				Checks.push_back(R);
 			}
 			Select.reset(Sess);
+			if (Cursor != nullptr)
+				AdvanceCursor(*Cursor, Checks, Ids, HowMany);
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -167,20 +213,8 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::RemoveHealthChecksRecordsOlderThan(uint64_t Date) {
-		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Delete(Sess);
-
-			std::string St1{"delete from HealthChecks where recorded<?"};
-			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
-			Delete.execute();
-			return true;
-		} catch (const Poco::Exception &E) {
-			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
-											   E.displayText()));
-		}
-		return false;
+	bool Storage::RemoveHealthChecksRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget) {
+		return RemoveRecordsOlderThan("HealthChecks", "Recorded", Date, Budget);
 	}
 
 } // namespace OpenWifi
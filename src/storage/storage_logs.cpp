@@ -41,18 +41,15 @@ namespace OpenWifi {
 
 	bool Storage::AddLog(const GWObjects::DeviceLog &Log) {
 		try {
-
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Insert(Sess);
-
-			std::string St{"INSERT INTO DeviceLogs (" + DB_LogsSelectFields + ") values( " +
-						   DB_LogsInsertValues + " )"};
-
-			DeviceLogsRecordTuple R;
-			ConvertLogsRecord(Log, R);
-
-			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
-			Insert.execute();
+			static const std::string St{"INSERT INTO DeviceLogs (" + DB_LogsSelectFields +
+										") values( " + DB_LogsInsertValues + " )"};
+
+			auto Insert = Statements().Prepare<DeviceLogsRecordTuple>(
+				St, [](Poco::Data::Statement &S, DeviceLogsRecordTuple &R) {
+					S, Poco::Data::Keywords::use(R);
+				});
+			ConvertLogsRecord(Log, *Insert);
+			Insert.Execute();
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -61,9 +58,42 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::AddLog(const std::vector<GWObjects::DeviceLog> &Logs, std::uint64_t &Written) {
+		static const std::string Prefix{"INSERT INTO DeviceLogs (" +
+										DB_LogsSelectFields + ") values "};
+		static const std::string FullBatch{
+			Prefix + MultiRowValues(DB_LogsInsertValues, MultiRowInsertSize)};
+		Written = 0;
+		for (std::size_t Start = 0; Start < Logs.size(); Start += MultiRowInsertSize) {
+			auto Rows = std::min(MultiRowInsertSize, Logs.size() - Start);
+			try {
+				std::string Partial;
+				if (Rows != MultiRowInsertSize)
+					Partial = Prefix + MultiRowValues(DB_LogsInsertValues, Rows);
+				auto Insert = Statements().Prepare<DeviceLogsRecordList>(
+					Partial.empty() ? FullBatch : Partial,
+					[Rows](Poco::Data::Statement &S, DeviceLogsRecordList &Records) {
+						Records.resize(Rows);
+						for (auto &R : Records)
+							S, Poco::Data::Keywords::use(R);
+					},
+					Rows == MultiRowInsertSize);
+				for (std::size_t i = 0; i < Rows; ++i)
+					ConvertLogsRecord(Logs[Start + i], (*Insert)[i]);
+				Insert.Execute();
+				Written += Rows;
+			} catch (const Poco::Exception &E) {
+				poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+												   E.displayText()));
+			}
+		}
+		return Written == Logs.size();
+	}
+
 	bool Storage::GetLogData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 							 uint64_t Offset, uint64_t HowMany,
-							 std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type) {
+							 std::vector<GWObjects::DeviceLog> &Stats, uint64_t Type,
+							 SeekCursor *Cursor) {
 		try {
 			DeviceLogsRecordList Records;
 			Poco::Data::Session Sess = Pool_->get();
@@ -71,7 +101,9 @@ namespace OpenWifi {
 			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
 			bool HasWhere = DatesIncluded || !SerialNumber.empty();
 
-			std::string Prefix{"SELECT " + DB_LogsSelectFields + " FROM DeviceLogs  "};
+			std::string Prefix{"SELECT " + DB_LogsSelectFields +
+							   (Cursor != nullptr ? ", " + RowIdColumn() : "") +
+							   " FROM DeviceLogs  "};
 			std::string Statement = SerialNumber.empty()
 										? Prefix + std::string(DatesIncluded ? "WHERE " : "")
 										: Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
@@ -89,11 +121,20 @@ namespace OpenWifi {
 
 			std::string TypeSelector;
 			TypeSelector = (HasWhere ? " AND LogType=" : " WHERE LogType=") + std::to_string(Type);
+
+			//	Logs are listed newest first: the next page seeks backwards.
+			std::string FullQuery = Statement + DateSelector + TypeSelector +
+									SeekAfter(Cursor, true, true) + SeekOrder(true) +
+									ComputeRange(Cursor != nullptr ? 0 : Offset, HowMany);
 			Poco::Data::Statement Select(Sess);
 
-			Select << Statement + DateSelector + TypeSelector + " ORDER BY Recorded DESC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
+			std::vector<std::uint64_t> Ids;
+			if (Cursor == nullptr) {
+				Select << FullQuery, Poco::Data::Keywords::into(Records);
+			} else {
+				Select << FullQuery, Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::into(Ids);
+			}
 			Select.execute();
 
 			for (const auto &i : Records) {
@@ -102,6 +143,8 @@ namespace OpenWifi {
 				Stats.push_back(R);
 			}
 			Select.reset(Sess);
+			if (Cursor != nullptr)
+				AdvanceCursor(*Cursor, Stats, Ids, HowMany);
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -180,20 +223,8 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::RemoveDeviceLogsRecordsOlderThan(uint64_t Date) {
-		try {
-			Poco::Data::Session Sess = Pool_->get();
-			Poco::Data::Statement Delete(Sess);
-
-			std::string St1{"delete from DeviceLogs where recorded<?"};
-			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
-			Delete.execute();
-			return true;
-		} catch (const Poco::Exception &E) {
-			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
-											   E.displayText()));
-		}
-		return false;
+	bool Storage::RemoveDeviceLogsRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget) {
+		return RemoveRecordsOlderThan("DeviceLogs", "Recorded", Date, Budget);
 	}
 
 } // namespace OpenWifi
@@ -0,0 +1,187 @@
+//
+//	License type: BSD 3-Clause License
+//	License copy: https://github.com/Telecominfraproject/wlan-cloud-ucentralgw/blob/master/LICENSE
+//
+
+#include "Poco/DateTimeFormatter.h"
+#include "Poco/DateTimeParser.h"
+#include "Poco/String.h"
+
+#include "StorageService.h"
+#include "framework/utils.h"
+
+#include "fmt/format.h"
+
+namespace OpenWifi {
+
+	static const std::uint64_t SECONDS_PER_DAY = 24 * 60 * 60;
+	static const std::vector<std::string> PartitionedTables{"Statistics", "HealthChecks",
+															"DeviceLogs"};
+
+	//	PostgreSQL folds unquoted names to lower case: catalog lookups must use that form.
+	static std::string PartitionPrefix(const std::string &Table) {
+		return Poco::toLower(Table) + "_p";
+	}
+
+	static std::string PartitionName(const std::string &Table, std::uint64_t DayStart) {
+		return PartitionPrefix(Table) +
+			   Poco::DateTimeFormatter::format(Poco::Timestamp::fromEpochTime(DayStart), "%Y%m%d");
+	}
+
+	std::string Storage::PartitionClause() const {
+		return Partitioned_ ? " PARTITION BY RANGE (Recorded)" : "";
+	}
+
+	//	MySQL has no CREATE INDEX IF NOT EXISTS: a duplicate index is simply reported and ignored.
+	void Storage::Create_TimeIndex(const std::string &Index, const std::string &Table,
+								   const std::string &Column) {
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+			if (dbType_ == mysql) {
+				Sess << fmt::format("CREATE INDEX {} ON {} ({} ASC)", Index, Table, Column),
+					Poco::Data::Keywords::now;
+			} else {
+				Sess << fmt::format("CREATE INDEX IF NOT EXISTS {} ON {} ({} ASC)", Index, Table,
+									Column),
+					Poco::Data::Keywords::now;
+			}
+		} catch (const Poco::Data::DataException &) {
+		} catch (const Poco::Exception &E) {
+			if (dbType_ != mysql)
+				Logger().log(E);
+		}
+	}
+
+	bool Storage::TablePartitioned(Poco::Data::Session &Sess, const std::string &Table) {
+		std::uint64_t Count = 0;
+		std::string Name{Poco::toLower(Table)};
+		std::string St{"SELECT COUNT(*) FROM pg_partitioned_table pt JOIN pg_class c ON "
+					   "c.oid=pt.partrelid WHERE c.relname=?"};
+		Poco::Data::Statement Select(Sess);
+		Select << ConvertParams(St), Poco::Data::Keywords::into(Count),
+			Poco::Data::Keywords::use(Name);
+		Select.execute();
+		return Count > 0;
+	}
+
+	std::vector<std::string> Storage::TablePartitions(Poco::Data::Session &Sess,
+													  const std::string &Table) {
+		std::vector<std::string> Partitions;
+		std::string Name{Poco::toLower(Table)};
+		std::string St{"SELECT c.relname FROM pg_inherits i JOIN pg_class c ON c.oid=i.inhrelid "
+					   "JOIN pg_class p ON p.oid=i.inhparent WHERE p.relname=?"};
+		Poco::Data::Statement Select(Sess);
+		Select << ConvertParams(St), Poco::Data::Keywords::into(Partitions),
+			Poco::Data::Keywords::use(Name);
+		Select.execute();
+		return Partitions;
+	}
+
+	//	Partitions for today and the next few days, plus a default one so an insert never fails.
+	void Storage::CreateTimePartitions() {
+		if (!Partitioned_)
+			return;
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+			auto Today = (Utils::Now() / SECONDS_PER_DAY) * SECONDS_PER_DAY;
+			for (const auto &Table : PartitionedTables) {
+				if (!TablePartitioned(Sess, Table)) {
+					poco_warning(Logger(),
+								 fmt::format("{} was created without partitions: rows will be "
+											 "removed in batches.",
+											 Table));
+					continue;
+				}
+				Sess << fmt::format("CREATE TABLE IF NOT EXISTS {}_default PARTITION OF {} DEFAULT",
+									Poco::toLower(Table), Table),
+					Poco::Data::Keywords::now;
+				for (std::uint64_t Day = 0; Day <= PartitionsAhead_; ++Day) {
+					auto From = Today + Day * SECONDS_PER_DAY;
+					try {
+						Sess << fmt::format("CREATE TABLE IF NOT EXISTS {} PARTITION OF {} FOR "
+											"VALUES FROM ({}) TO ({})",
+											PartitionName(Table, From), Table, From,
+											From + SECONDS_PER_DAY),
+							Poco::Data::Keywords::now;
+					} catch (const Poco::Exception &E) {
+						Logger().log(E);
+					}
+				}
+			}
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+	}
+
+	std::uint64_t Storage::DropPartitionsOlderThan(Poco::Data::Session &Sess,
+												   const std::string &Table, uint64_t Date) {
+		std::uint64_t Dropped = 0;
+		auto Prefix = PartitionPrefix(Table);
+		for (const auto &Partition : TablePartitions(Sess, Table)) {
+			if (Partition.size() != Prefix.size() + 8 || Partition.compare(0, Prefix.size(), Prefix) != 0)
+				continue;
+			int TZ;
+			Poco::DateTime Day;
+			if (!Poco::DateTimeParser::tryParse("%Y%m%d", Partition.substr(Prefix.size()), Day, TZ))
+				continue;
+			std::uint64_t DayStart = Day.timestamp().epochTime();
+			if (DayStart + SECONDS_PER_DAY > Date)
+				continue;
+			Sess << "DROP TABLE IF EXISTS " + Partition, Poco::Data::Keywords::now;
+			++Dropped;
+		}
+		return Dropped;
+	}
+
+	/*
+	 * 	Each batch is a short DELETE of at most BatchSize rows found through the time index, so live
+	 * inserts are never blocked for long and the caller can pace the run between batches.
+	 */
+	bool Storage::RemoveRecordsOlderThan(const std::string &Table, const std::string &Column,
+										 uint64_t Date, const RetentionBudget &Budget) {
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+			std::vector<std::string> Targets{Table};
+			if (Partitioned_ && TablePartitioned(Sess, Table)) {
+				auto Dropped = DropPartitionsOlderThan(Sess, Table, Date);
+				if (Dropped > 0)
+					poco_information(Logger(),
+									 fmt::format("{}: dropped {} partitions.", Table, Dropped));
+				Targets = TablePartitions(Sess, Table);
+			}
+
+			auto BatchSize = std::max<std::uint64_t>(Budget.BatchSize, 1);
+			for (const auto &Target : Targets) {
+				std::string St;
+				if (dbType_ == pgsql) {
+					St = fmt::format("DELETE FROM {0} WHERE ctid = ANY(ARRAY(SELECT ctid FROM {0} "
+									 "WHERE {1}<? LIMIT {2}))",
+									 Target, Column, BatchSize);
+				} else if (dbType_ == mysql) {
+					St = fmt::format("DELETE FROM {0} WHERE {1}<? ORDER BY {1} LIMIT {2}", Target,
+									 Column, BatchSize);
+				} else {
+					St = fmt::format("DELETE FROM {0} WHERE rowid IN (SELECT rowid FROM {0} WHERE "
+									 "{1}<? LIMIT {2})",
+									 Target, Column, BatchSize);
+				}
+
+				while (true) {
+					Poco::Data::Statement Delete(Sess);
+					Delete << ConvertParams(St), Poco::Data::Keywords::use(Date);
+					std::uint64_t Deleted = Delete.execute();
+					if (Budget.Progress && !Budget.Progress(Deleted))
+						return true;
+					if (Deleted < BatchSize)
+						break;
+				}
+			}
+			return true;
+		} catch (const Poco::Exception &E) {
+			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+											   E.displayText()));
+		}
+		return false;
+	}
+
+} // namespace OpenWifi
@@ -35,17 +35,16 @@ namespace OpenWifi {
 
 	bool Storage::AddStatisticsData(const GWObjects::Statistics &Stats) {
 		try {
-			Poco::Data::Session Sess(Pool_->get());
-			Poco::Data::Statement Insert(Sess);
-
 			poco_trace(Logger(), fmt::format("{}: Adding stats. Size={}", Stats.SerialNumber,
 											 std::to_string(Stats.Data.size())));
-			std::string St{"INSERT INTO Statistics ( " + DB_StatsSelectFields + " ) VALUES ( " +
-						   DB_StatsInsertValues + " )"};
-			StatsRecordTuple R;
-			ConvertStatsRecord(Stats, R);
-			Insert << ConvertParams(St), Poco::Data::Keywords::use(R);
-			Insert.execute();
+			static const std::string St{"INSERT INTO Statistics ( " + DB_StatsSelectFields +
+										" ) VALUES ( " + DB_StatsInsertValues + " )"};
+			auto Insert = Statements().Prepare<StatsRecordTuple>(
+				St, [](Poco::Data::Statement &S, StatsRecordTuple &R) {
+					S, Poco::Data::Keywords::use(R);
+				});
+			ConvertStatsRecord(Stats, *Insert);
+			Insert.Execute();
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -54,6 +53,39 @@ namespace OpenWifi {
 		return false;
 	}
 
+	bool Storage::AddStatisticsData(const std::vector<GWObjects::Statistics> &Stats,
+								   std::uint64_t &Written) {
+		static const std::string Prefix{"INSERT INTO Statistics ( " +
+										DB_StatsSelectFields + " ) VALUES "};
+		static const std::string FullBatch{
+			Prefix + MultiRowValues(DB_StatsInsertValues, MultiRowInsertSize)};
+		Written = 0;
+		for (std::size_t Start = 0; Start < Stats.size(); Start += MultiRowInsertSize) {
+			auto Rows = std::min(MultiRowInsertSize, Stats.size() - Start);
+			try {
+				std::string Partial;
+				if (Rows != MultiRowInsertSize)
+					Partial = Prefix + MultiRowValues(DB_StatsInsertValues, Rows);
+				auto Insert = Statements().Prepare<StatsRecordList>(
+					Partial.empty() ? FullBatch : Partial,
+					[Rows](Poco::Data::Statement &S, StatsRecordList &Records) {
+						Records.resize(Rows);
+						for (auto &R : Records)
+							S, Poco::Data::Keywords::use(R);
+					},
+					Rows == MultiRowInsertSize);
+				for (std::size_t i = 0; i < Rows; ++i)
+					ConvertStatsRecord(Stats[Start + i], (*Insert)[i]);
+				Insert.Execute();
+				Written += Rows;
+			} catch (const Poco::Exception &E) {
+				poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
+												   E.displayText()));
+			}
+		}
+		return Written == Stats.size();
+	}
+
 	bool Storage::GetNumberOfStatisticsDataRecords(std::string &SerialNumber, uint64_t FromDate,
 												   uint64_t ToDate, std::uint64_t &Count) {
 		try {
@@ -92,7 +124,8 @@ namespace OpenWifi {
 
 	bool Storage::GetStatisticsData(std::string &SerialNumber, uint64_t FromDate, uint64_t ToDate,
 									uint64_t Offset, uint64_t HowMany,
-									std::vector<GWObjects::Statistics> &Stats) {
+									std::vector<GWObjects::Statistics> &Stats,
+									SeekCursor *Cursor) {
 		try {
 			Poco::Data::Session Sess(Pool_->get());
 			Poco::Data::Statement Select(Sess);
@@ -101,7 +134,9 @@ namespace OpenWifi {
 
 			bool DatesIncluded = (FromDate != 0 || ToDate != 0);
 
-			std::string Prefix{"SELECT " + DB_StatsSelectFields + " FROM Statistics "};
+			std::string Prefix{"SELECT " + DB_StatsSelectFields +
+							   (Cursor != nullptr ? ", " + RowIdColumn() : "") +
+							   " FROM Statistics "};
 			std::string StatementStr = SerialNumber.empty()
 										   ? Prefix + std::string(DatesIncluded ? "WHERE " : "")
 										   : Prefix + "WHERE SerialNumber='" + SerialNumber + "'" +
@@ -117,9 +152,18 @@ namespace OpenWifi {
 				DateSelector = " Recorded<=" + std::to_string(ToDate);
 			}
 
-			Select << StatementStr + DateSelector + " ORDER BY Recorded ASC " +
-						  ComputeRange(Offset, HowMany),
-				Poco::Data::Keywords::into(Records);
+			std::string FullQuery =
+				StatementStr + DateSelector +
+				SeekAfter(Cursor, DatesIncluded || !SerialNumber.empty(), false) +
+				SeekOrder(false) + ComputeRange(Cursor != nullptr ? 0 : Offset, HowMany);
+
+			std::vector<std::uint64_t> Ids;
+			if (Cursor == nullptr) {
+				Select << FullQuery, Poco::Data::Keywords::into(Records);
+			} else {
+				Select << FullQuery, Poco::Data::Keywords::into(Records),
+					Poco::Data::Keywords::into(Ids);
+			}
 			Select.execute();
 
 			for (const auto &i : Records) {
@@ -128,6 +172,8 @@ namespace OpenWifi {
 				Stats.emplace_back(R);
 			}
 			Select.reset(Sess);
+			if (Cursor != nullptr)
+				AdvanceCursor(*Cursor, Stats, Ids, HowMany);
 			return true;
 		} catch (const Poco::Exception &E) {
 			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
@@ -198,20 +244,8 @@ namespace OpenWifi {
 		return false;
 	}
 
-	bool Storage::RemoveStatisticsRecordsOlderThan(uint64_t Date) {
-		try {
-			Poco::Data::Session Sess(Pool_->get());
-			Poco::Data::Statement Delete(Sess);
-
-			std::string St1{"delete from Statistics where recorded<?"};
-			Delete << ConvertParams(St1), Poco::Data::Keywords::use(Date);
-			Delete.execute();
-			return true;
-		} catch (const Poco::Exception &E) {
-			poco_warning(Logger(), fmt::format("{}: Failed with: {}", std::string(__func__),
-											   E.displayText()));
-		}
-		return false;
+	bool Storage::RemoveStatisticsRecordsOlderThan(uint64_t Date, const RetentionBudget &Budget) {
+		return RemoveRecordsOlderThan("Statistics", "Recorded", Date, Budget);
 	}
 
 } // namespace OpenWifi
\ No newline at end of file
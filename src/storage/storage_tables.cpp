@@ -26,16 +26,42 @@ namespace OpenWifi {
 		return 0;
 	}
 
+	//	Time series need a unique key to page on (see SeekAfter). SQLite has rowid; PostgreSQL
+	//	gets a sequence column, which partitioned tables also accept since it carries no constraint.
+	std::string Storage::TimeSeriesIdColumn() const {
+		return dbType_ == pgsql ? "Id BIGSERIAL, " : "";
+	}
+
+	//	Tables created before the Id column existed get it here. Existing rows are numbered while
+	//	the table is rewritten, which can take a while on a large table the first time.
+	void Storage::Upgrade_TimeSeriesId(const std::string &Table, const std::string &Index) {
+		std::string Script;
+		if (dbType_ == pgsql)
+			Script = fmt::format("alter table {} add column if not exists Id bigserial", Table);
+		else if (dbType_ == mysql)
+			Script = fmt::format(
+				"alter table {} add column Id bigint auto_increment, add index {} (Id)", Table, Index);
+		else
+			return;
+		try {
+			Poco::Data::Session Sess = Pool_->get();
+			Sess << Script, Poco::Data::Keywords::now;
+		} catch (const Poco::Data::DataException &) {
+		} catch (const Poco::Exception &E) {
+			Logger().log(E);
+		}
+	}
+
 	int Storage::Create_Statistics() {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
 
 			if (dbType_ == pgsql || dbType_ == sqlite) {
-				Sess << "CREATE TABLE IF NOT EXISTS Statistics ("
-						"SerialNumber VARCHAR(30), "
-						"UUID INTEGER, "
-						"Data TEXT, "
-						"Recorded BIGINT)",
+				Sess << "CREATE TABLE IF NOT EXISTS Statistics (" + TimeSeriesIdColumn() +
+							"SerialNumber VARCHAR(30), "
+							"UUID INTEGER, "
+							"Data TEXT, "
+							"Recorded BIGINT)" + PartitionClause(),
 					Poco::Data::Keywords::now;
 				Sess << "CREATE INDEX IF NOT EXISTS StatsSerial ON Statistics (SerialNumber ASC, "
 						"Recorded ASC)",
@@ -44,14 +70,18 @@ namespace OpenWifi {
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == mysql) {
 				Sess << "CREATE TABLE IF NOT EXISTS Statistics ("
+						"Id BIGINT AUTO_INCREMENT, "
 						"SerialNumber VARCHAR(30), "
 						"UUID INTEGER, "
 						"Data TEXT, "
 						"Recorded BIGINT, "
-						"INDEX StatSerial0 (SerialNumber)), ",
-						"INDEX StatSerial (SerialNumber ASC, Recorded ASC))",
+						"INDEX StatSerial0 (SerialNumber), "
+						"INDEX StatSerial (SerialNumber ASC, Recorded ASC), "
+						"INDEX StatsId (Id))",
 					Poco::Data::Keywords::now;
 			}
+			Upgrade_TimeSeriesId("Statistics", "StatsId");
+			Create_TimeIndex("StatsRecorded", "Statistics", "Recorded");
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -198,26 +228,30 @@ namespace OpenWifi {
 
 			if (dbType_ == mysql) {
 				Sess << "CREATE TABLE IF NOT EXISTS HealthChecks ("
+						"Id BIGINT AUTO_INCREMENT, "
 						"SerialNumber VARCHAR(30), "
 						"UUID          BIGINT, "
 						"Data TEXT, "
 						"Sanity BIGINT , "
 						"Recorded BIGINT, "
-						"INDEX HealthSerial (SerialNumber ASC, Recorded ASC)"
+						"INDEX HealthSerial (SerialNumber ASC, Recorded ASC), "
+						"INDEX HealthId (Id)"
 						")",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == sqlite || dbType_ == pgsql) {
-				Sess << "CREATE TABLE IF NOT EXISTS HealthChecks ("
-						"SerialNumber VARCHAR(30), "
-						"UUID          BIGINT, "
-						"Data TEXT, "
-						"Sanity BIGINT , "
-						"Recorded BIGINT) ",
+				Sess << "CREATE TABLE IF NOT EXISTS HealthChecks (" + TimeSeriesIdColumn() +
+							"SerialNumber VARCHAR(30), "
+							"UUID          BIGINT, "
+							"Data TEXT, "
+							"Sanity BIGINT , "
+							"Recorded BIGINT) " + PartitionClause(),
 					Poco::Data::Keywords::now;
 				Sess << "CREATE INDEX IF NOT EXISTS HealthSerial ON HealthChecks (SerialNumber "
 						"ASC, Recorded ASC)",
 					Poco::Data::Keywords::now;
 			}
+			Upgrade_TimeSeriesId("HealthChecks", "HealthId");
+			Create_TimeIndex("HealthRecorded", "HealthChecks", "Recorded");
 			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
@@ -231,6 +265,7 @@ namespace OpenWifi {
 
 			if (dbType_ == mysql) {
 				Sess << "CREATE TABLE IF NOT EXISTS DeviceLogs ("
+						"Id             BIGINT AUTO_INCREMENT, "
 						"SerialNumber   VARCHAR(30), "
 						"Log            TEXT, "
 						"Data           TEXT, "
@@ -238,24 +273,27 @@ namespace OpenWifi {
 						"Recorded       BIGINT, "
 						"LogType        BIGINT, "
 						"UUID	        BIGINT, "
-						"INDEX LogSerial (SerialNumber ASC, Recorded ASC)"
+						"INDEX LogSerial (SerialNumber ASC, Recorded ASC), "
+						"INDEX LogId (Id)"
 						")",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == pgsql || dbType_ == sqlite) {
-				Sess << "CREATE TABLE IF NOT EXISTS DeviceLogs ("
-						"SerialNumber   VARCHAR(30), "
-						"Log            TEXT, "
-						"Data           TEXT, "
-						"Severity       BIGINT, "
-						"Recorded       BIGINT, "
-						"LogType        BIGINT, "
-						"UUID	        BIGINT  "
-						")",
+				Sess << "CREATE TABLE IF NOT EXISTS DeviceLogs (" + TimeSeriesIdColumn() +
+							"SerialNumber   VARCHAR(30), "
+							"Log            TEXT, "
+							"Data           TEXT, "
+							"Severity       BIGINT, "
+							"Recorded       BIGINT, "
+							"LogType        BIGINT, "
+							"UUID	        BIGINT  "
+							")" + PartitionClause(),
 					Poco::Data::Keywords::now;
 				Sess << "CREATE INDEX IF NOT EXISTS LogSerial ON DeviceLogs (SerialNumber ASC, "
 						"Recorded ASC)",
 					Poco::Data::Keywords::now;
 			}
+			Upgrade_TimeSeriesId("DeviceLogs", "LogId");
+			Create_TimeIndex("LogRecorded", "DeviceLogs", "Recorded");
 
 			return 0;
 		} catch (const Poco::Exception &E) {
@@ -381,6 +419,7 @@ namespace OpenWifi {
 				Logger().log(E);
 			}
 		}
+		Create_TimeIndex("CommandListSubmitted", "CommandList", "Submitted");
 
 		return 0;
 	}
@@ -405,6 +444,7 @@ namespace OpenWifi {
 		return -1;
 	}
 
+	//	FileContent is only kept for files uploaded before they moved to the file store.
 	int Storage::Create_FileUploads() {
 		try {
 			Poco::Data::Session Sess = Pool_->get();
@@ -414,7 +454,9 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BLOB"
+						"FileContent	BLOB, "
+						"FileName		VARCHAR(128), "
+						"FileSize		BIGINT"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == mysql) {
@@ -422,7 +464,10 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	LONGBLOB"
+						"FileContent	LONGBLOB, "
+						"FileName		VARCHAR(128), "
+						"FileSize		BIGINT, "
+						"INDEX FileUploadsName (FileName)"
 						") ",
 					Poco::Data::Keywords::now;
 			} else if (dbType_ == pgsql) {
@@ -430,16 +475,36 @@ namespace OpenWifi {
 						"UUID			VARCHAR(64) PRIMARY KEY, "
 						"Type			VARCHAR(32), "
 						"Created 		BIGINT, "
-						"FileContent	BYTEA"
+						"FileContent	BYTEA, "
+						"FileName		VARCHAR(128), "
+						"FileSize		BIGINT"
 						") ",
 					Poco::Data::Keywords::now;
 			}
-
-			return 0;
 		} catch (const Poco::Exception &E) {
 			Logger().log(E);
+			return -1;
 		}
-		return -1;
+
+		std::vector<std::string> Script{
+			"alter table FileUploads add column FileName VARCHAR(128)",
+			"alter table FileUploads add column FileSize BIGINT"};
+		//	MySQL has no IF NOT EXISTS for indexes: a second run fails with a DataException, ignored below.
+		Script.emplace_back(dbType_ == mysql
+								? "CREATE INDEX FileUploadsName ON FileUploads (FileName)"
+								: "CREATE INDEX IF NOT EXISTS FileUploadsName ON FileUploads (FileName)");
+
+		for (const auto &i : Script) {
+			try {
+				Poco::Data::Session Sess = Pool_->get();
+				Sess << i, Poco::Data::Keywords::now;
+			} catch (const Poco::Data::DataException &) {
+			} catch (const Poco::Exception &E) {
+				Logger().log(E);
+			}
+		}
+
+		return 0;
 	}
 
 } // namespace OpenWifi
\ No newline at end of file
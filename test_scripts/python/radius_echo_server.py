@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# A local RADIUS server stand-in for load testing the gateway's RADIUS proxy.
+#
+# Answers every Access-Request with an Access-Accept and every Accounting-Request with an
+# Accounting-Response, copying the Proxy-State attributes the proxy needs to route the reply.
+# With --challenge, the first request of a session gets an Access-Challenge carrying a State, and
+# only a request returning a State this instance issued is accepted. Running two instances in the
+# same pool then shows whether the rounds of a session stay on one server: a request arriving with
+# a State issued by the other instance is rejected and counted as "unknown-state".
+#
+#   python3 radius_echo_server.py --secret testing123 --auth-port 1812 --acct-port 1813
+#   python3 radius_echo_server.py --secret testing123 --auth-port 11812 --acct-port 11813 --challenge
+#
+# --drop makes the server ignore a share of the requests, to watch the proxy mark it down.
+
+import argparse
+import hashlib
+import hmac
+import os
+import random
+import selectors
+import socket
+import struct
+import time
+
+ACCESS_REQUEST = 1
+ACCESS_ACCEPT = 2
+ACCESS_REJECT = 3
+ACCOUNTING_REQUEST = 4
+ACCOUNTING_RESPONSE = 5
+ACCESS_CHALLENGE = 11
+
+STATE = 24
+PROXY_STATE = 33
+MESSAGE_AUTHENTICATOR = 80
+
+
+def parse_attributes(data):
+    attributes = []
+    pos = 20
+    while pos + 2 <= len(data):
+        attr_type, attr_len = data[pos], data[pos + 1]
+        if attr_len < 2 or pos + attr_len > len(data):
+            return None
+        attributes.append((attr_type, data[pos + 2:pos + attr_len]))
+        pos += attr_len
+    return attributes
+
+
+def encode_attributes(attributes):
+    return b''.join(struct.pack('!BB', t, len(v) + 2) + v for t, v in attributes)
+
+
+def build_reply(code, request, attributes, secret, sign):
+    identifier = request[1]
+    request_authenticator = request[4:20]
+    if sign:
+        attributes = attributes + [(MESSAGE_AUTHENTICATOR, bytes(16))]
+    body = encode_attributes(attributes)
+    length = 20 + len(body)
+    if sign:
+        unsigned = struct.pack('!BBH', code, identifier, length) + request_authenticator + body
+        mac = hmac.new(secret, unsigned, hashlib.md5).digest()
+        body = body[:-16] + mac
+    authenticator = hashlib.md5(struct.pack('!BBH', code, identifier, length) +
+                                request_authenticator + body + secret).digest()
+    return struct.pack('!BBH', code, identifier, length) + authenticator + body
+
+
+class EchoServer:
+    def __init__(self, args):
+        self.secret = args.secret.encode()
+        self.challenge = args.challenge
+        self.drop = args.drop
+        self.states = set()
+        self.counters = dict.fromkeys(
+            ['requests', 'accept', 'challenge', 'reject', 'unknown-state', 'accounting',
+             'dropped', 'malformed'], 0)
+
+    def answer(self, data):
+        if len(data) < 20 or struct.unpack('!H', data[2:4])[0] != len(data):
+            self.counters['malformed'] += 1
+            return None
+        attributes = parse_attributes(data)
+        if attributes is None:
+            self.counters['malformed'] += 1
+            return None
+        self.counters['requests'] += 1
+        if self.drop and random.random() < self.drop:
+            self.counters['dropped'] += 1
+            return None
+
+        proxy_states = [(t, v) for t, v in attributes if t == PROXY_STATE]
+        sign = any(t == MESSAGE_AUTHENTICATOR for t, _ in attributes)
+        code = data[0]
+        if code == ACCOUNTING_REQUEST:
+            self.counters['accounting'] += 1
+            return build_reply(ACCOUNTING_RESPONSE, data, proxy_states, self.secret, False)
+        if code != ACCESS_REQUEST:
+            self.counters['malformed'] += 1
+            return None
+
+        if not self.challenge:
+            self.counters['accept'] += 1
+            return build_reply(ACCESS_ACCEPT, data, proxy_states, self.secret, sign)
+
+        state = next((v for t, v in attributes if t == STATE), None)
+        if state is None:
+            state = os.urandom(16)
+            self.states.add(state)
+            self.counters['challenge'] += 1
+            return build_reply(ACCESS_CHALLENGE, data, [(STATE, state)] + proxy_states,
+                               self.secret, sign)
+        if state in self.states:
+            self.states.discard(state)
+            self.counters['accept'] += 1
+            return build_reply(ACCESS_ACCEPT, data, proxy_states, self.secret, sign)
+        self.counters['unknown-state'] += 1
+        self.counters['reject'] += 1
+        return build_reply(ACCESS_REJECT, data, proxy_states, self.secret, sign)
+
+    def report(self, elapsed):
+        rate = self.counters['requests'] / elapsed if elapsed > 0 else 0
+        print('{:8.0f} req/s  '.format(rate) +
+              '  '.join('{}={}'.format(k, v) for k, v in self.counters.items()), flush=True)
+        self.counters = dict.fromkeys(self.counters, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Local RADIUS stand-in for proxy load tests.')
+    parser.add_argument('--address', default='0.0.0.0')
+    parser.add_argument('--auth-port', type=int, default=1812)
+    parser.add_argument('--acct-port', type=int, default=1813)
+    parser.add_argument('--secret', required=True)
+    parser.add_argument('--challenge', action='store_true',
+                        help='answer the first request of a session with an Access-Challenge')
+    parser.add_argument('--drop', type=float, default=0.0,
+                        help='share of requests to ignore, between 0 and 1')
+    parser.add_argument('--interval', type=float, default=1.0, help='seconds between reports')
+    args = parser.parse_args()
+
+    server = EchoServer(args)
+    selector = selectors.DefaultSelector()
+    for port in (args.auth_port, args.acct_port):
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 << 20)
+        sock.bind((args.address, port))
+        sock.setblocking(False)
+        selector.register(sock, selectors.EVENT_READ)
+        print('Listening on {}:{}'.format(args.address, port), flush=True)
+
+    last_report = time.monotonic()
+    while True:
+        for key, _ in selector.select(timeout=args.interval):
+            sock = key.fileobj
+            while True:
+                try:
+                    data, source = sock.recvfrom(4096)
+                except BlockingIOError:
+                    break
+                reply = server.answer(data)
+                if reply is not None:
+                    sock.sendto(reply, source)
+        now = time.monotonic()
+        if now - last_report >= args.interval:
+            server.report(now - last_report)
+            last_report = now
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass